@@ -1674,7 +1674,36 @@ void Feature::saveAs
   }
 }
 
+TopoDS_Shape Feature::exportTriangulation(double abstol) const
+{
+    if (refvalues_.count("isSTLGeometry"))
+    {
+        return shape();
+    }
+
+    // the copy (topology only) receives its own triangulation
+    BRepBuilderAPI_Copy aCopy( shape(), Standard_False );
+    TopoDS_Shape os=aCopy.Shape();
+
+#if !((OCC_VERSION_MAJOR<7)&&(OCC_VERSION_MINOR<9))
+    BRepTools::Clean( os );
+    BRepMesh_IncrementalMesh binc(
+        os, abstol,
+        Standard_False, 0.5,
+        Standard_True /* faces in parallel */ );
+#endif
+
+    return os;
+}
+
+
 void Feature::exportSTL(const boost::filesystem::path& filename, double abstol, bool binary) const
+{
+    exportSTL(exportTriangulation(abstol), filename, abstol, binary);
+}
+
+
+void Feature::exportSTL(const TopoDS_Shape& triangulatedShape, const boost::filesystem::path& filename, double abstol, bool binary)
 {
     StlAPI_Writer stlwriter;
     stlwriter.ASCIIMode() = !binary; //false;
@@ -1684,25 +1713,7 @@ void Feature::exportSTL(const boost::filesystem::path& filename, double abstol,
     stlwriter.SetDeflection(abstol);
 #endif
 
-    BRepBuilderAPI_Copy aCopy( shape(), Standard_False );
-    TopoDS_Shape os=aCopy.Shape();
-
-    if (refvalues_.count("isSTLGeometry"))
-    {
-        os=shape();
-    }
-    else
-    {
-
-#if !((OCC_VERSION_MAJOR<7)&&(OCC_VERSION_MINOR<9))
-        BRepTools::Clean( os );
-        //  ShapeFix_ShapeTolerance sf;
-        //  sf.SetTolerance(os, abstol);
-        BRepMesh_IncrementalMesh binc(os, abstol);
-#endif
-    }
-
-    stlwriter.Write(os, filename.string().c_str());
+    stlwriter.Write(triangulatedShape, filename.string().c_str());
 }
 
 
@@ -2579,10 +2590,11 @@ Handle_Poly_Triangulation Feature::triangulation(double tol) const
 
 
 
-vtkSmartPointer<vtkPolyData> Feature::triangulationToVTK(double tol) const
+namespace
 {
-    auto mesh = triangulation(tol);
 
+vtkSmartPointer<vtkPolyData> polyTriangulationToVTK(Handle_Poly_Triangulation mesh)
+{
     auto pts = vtkSmartPointer<vtkPoints>::New();
     pts->SetNumberOfPoints(mesh->NbNodes());
 
@@ -2619,6 +2631,50 @@ vtkSmartPointer<vtkPolyData> Feature::triangulationToVTK(double tol) const
     return vmesh;
 }
 
+}
+
+
+
+vtkSmartPointer<vtkPolyData> Feature::triangulationToVTK(double tol) const
+{
+    return polyTriangulationToVTK(triangulation(tol));
+}
+
+
+
+
+vtkSmartPointer<vtkPolyData> Feature::triangulatedShapeToVTK(const TopoDS_Shape& triangulatedShape)
+{
+    Poly_ListOfTriangulation triangulations;
+
+    for (TopExp_Explorer ex(triangulatedShape, TopAbs_FACE); ex.More(); ex.Next())
+    {
+        auto f=TopoDS::Face(ex.Current());
+
+        TopLoc_Location loc;
+        auto mesh = BRep_Tool::Triangulation(f,loc);
+        if (mesh.IsNull())
+        {
+            throw insight::Exception("face has no triangulation!");
+        }
+        mesh=mesh->Copy();
+
+        for (int i=1; i<=mesh->NbNodes(); ++i)
+        {
+            mesh->ChangeNodes().ChangeValue(i)=
+                mesh->Nodes().Value(i).Transformed(loc);
+        }
+
+        triangulations.Append(mesh);
+    }
+
+    insight::assertion(
+        triangulations.Extent()>=1,
+        "there are no triangulations!" );
+
+    return polyTriangulationToVTK(Poly::Catenate(triangulations));
+}
+
 
 
 void Feature::setBOMDescription(
@@ -485,7 +485,21 @@ public:
       = std::vector<boost::fusion::vector2<std::string, FeatureSetPtr> >()
   ) const;
   
+  /**
+   * @brief exportTriangulation
+   * triangulate a topological copy of the shape for export.
+   * The faces are meshed in parallel. Since a copy is meshed, this may be called
+   * concurrently for features, which share sub-shapes.
+   * STL geometries are returned as they are.
+   */
+  TopoDS_Shape exportTriangulation(double abstol=5e-5) const;
+
   void exportSTL(const boost::filesystem::path& filename, double abstol=5e-5, bool binary=true) const;
+  /**
+   * @brief exportSTL
+   * write an existing triangulation, e.g. from exportTriangulation(abstol)
+   */
+  static void exportSTL(const TopoDS_Shape& triangulatedShape, const boost::filesystem::path& filename, double abstol, bool binary=true);
   static void exportEMesh(const boost::filesystem::path& filename, const FeatureSet& fs, double abstol=1e-3, double maxlen=1e10);
   
   operator const TopoDS_Shape& () const;
@@ -573,6 +587,12 @@ public:
   Handle_Poly_Triangulation triangulation(double tol=1e-3) const;
   vtkSmartPointer<vtkPolyData> triangulationToVTK(double tol=1e-3) const;
 
+  /**
+   * @brief triangulatedShapeToVTK
+   * convert the existing triangulation of a shape, e.g. from exportTriangulation()
+   */
+  static vtkSmartPointer<vtkPolyData> triangulatedShapeToVTK(const TopoDS_Shape& triangulatedShape);
+
   void setBOMDescription(
       const BOMDescriptionData &desc );
 
@@ -618,6 +618,18 @@ void ArcCenterPoint::addParserRule(
 
 
 
+std::set<std::comparable_weak_ptr<ConstrainedSketchEntity> >
+ArcCenterPoint::solverDependencies() const
+{
+    // the location is computed from the arc
+    std::set<std::comparable_weak_ptr<ConstrainedSketchEntity> > ret;
+    if (auto a = arc_.lock())
+        ret.insert(std::static_pointer_cast<ConstrainedSketchEntity>(a));
+    return ret;
+}
+
+
+
 void ArcCenterPoint::operator=(const ArcCenterPoint& other)
 {
     angle_=other.angle_;
@@ -150,7 +150,7 @@ public:
         ConstrainedSketchGrammar& ruleset,
         const ConstrainedSketchParametersDelegate& pd );
 
-
+    std::set<std::comparable_weak_ptr<ConstrainedSketchEntity> > solverDependencies() const override;
 
     void operator=(const ConstrainedSketchEntity& other) override;
     void operator=(const ArcCenterPoint& other);
@@ -24,6 +24,9 @@
 #include "parser.h"
 #include "parameterlisthash.h"
 
+#include "base/linearalgebra.h"
+#include "base/tools.h"
+
 #include "GeomAbs_CurveType.hxx"
 
 #include <algorithm>
@@ -46,112 +49,202 @@ namespace cad {
 namespace {
 
 // ---------------------------------------------------------------------------
-// Solve LP relaxation of the cutting-stock master problem.
+// Revised simplex for the cutting-stock master problem.
 //
-//   min  sum_j x_j
+//   min  sum_j c_j * x_j
 //   s.t. sum_j A[i][j] * x_j  >= b[i]   for all i
 //        x_j >= 0
 //
-// Method: big-M full-tableau simplex with surplus + artificial variables.
+// Variables: x_j   (pattern usage, structural columns, added over time)
+//            s_i   (surplus, column -e_i, cost 0)
+//            r_i   (artificial, column +e_i, cost BIG_M, never re-enter)
 //
-//   Variables: x_0..x_{n-1}  (pattern usage)
-//              s_0..s_{m-1}  (surplus,    col n+i)
-//              r_0..r_{m-1}  (artificial, col n+m+i)
-//   Objective row (index m): reduced costs.
+// The basis inverse is kept as a dense LU factorisation of the basis matrix
+// B0 plus a product-form eta file for the pivots since the last
+// refactorisation.
 //
-// Returns true on success; fills x (primal) and y (dual = shadow prices of
-// the >= constraints, extracted as reduced costs of the surplus variables).
+// The object is kept alive during column generation: new columns enter as
+// non-basic variables, so the optimal basis of the previous master problem
+// stays primal feasible and the next solve starts from there (warm start).
 // ---------------------------------------------------------------------------
-// c[j] = objective coefficient for pattern j (e.g. bar length of the stock type used)
-bool solveLPRelaxation(
-    const std::vector<std::vector<double>>& A,   // m x n
-    const std::vector<double>&              b,
-    const std::vector<double>&              c,   // n objective coefficients
-    std::vector<double>&                    x,
-    std::vector<double>&                    y)
+class MasterLP
 {
-    const int m      = static_cast<int>(b.size());
-    const int n      = static_cast<int>(A[0].size());
-    const int nvars  = n + 2 * m;   // patterns + surplus + artificials
-    const int RHS    = nvars;        // index of the RHS column
-    const double BIG_M = 1.0e9;
-
-    // Tableau: (m+1) rows x (nvars+1) cols
-    std::vector<std::vector<double>> T(m + 1, std::vector<double>(nvars + 1, 0.0));
-
-    // Fill constraint rows: A*x - s + r = b
-    for (int i = 0; i < m; ++i) {
-        for (int j = 0; j < n; ++j) T[i][j]       =  A[i][j];
-        T[i][n + i]     = -1.0;   // surplus s_i
-        T[i][n + m + i] =  1.0;   // artificial r_i
-        T[i][RHS]        =  b[i];
+    static constexpr double BIG_M          = 1.0e9;
+    static constexpr int    REFACTOR_EVERY = 64;
+
+    const int           m_;
+    arma::vec           b_;
+
+    std::vector<arma::vec> cols_;    // structural columns
+    std::vector<double>    costs_;
+
+    // basis variable encoding: j>=0 structural, -1-i surplus i, -1-m-i artificial i
+    std::vector<int>    basis_;
+    arma::vec           xB_;
+
+    arma::mat           L_, U_, P_;
+    struct Eta { int r; arma::vec e; };
+    std::vector<Eta>    etas_;
+
+    arma::vec column(int v) const
+    {
+        if (v >= 0) return cols_[v];
+        arma::vec e = arma::zeros(m_);
+        if (v >= -m_) e(-1 - v) = -1.0;       // surplus
+        else          e(-1 - m_ - v) = 1.0;   // artificial
+        return e;
     }
 
-    // Objective row: c[j] for x_j, 0 for s_i, BIG_M for r_i
-    for (int j = 0; j < n; ++j)  T[m][j]         = c[j];
-    for (int i = 0; i < m; ++i)  T[m][n + m + i] = BIG_M;
+    double cost(int v) const
+    {
+        if (v >= 0)   return costs_[v];
+        if (v >= -m_) return 0.0;
+        return BIG_M;
+    }
 
-    // Eliminate basic artificials from objective row (they start basic with value b[i])
-    for (int i = 0; i < m; ++i) {
-        const double coeff = T[m][n + m + i];   // = BIG_M
-        for (int j = 0; j <= nvars; ++j)
-            T[m][j] -= coeff * T[i][j];
+    void refactor()
+    {
+        arma::mat B(m_, m_);
+        for (int i = 0; i < m_; ++i) B.col(i) = column(basis_[i]);
+        arma::lu(L_, U_, P_, B);
+        etas_.clear();
+        xB_ = ftran(b_);
     }
 
-    // Initial basis: artificial for each constraint row
-    std::vector<int> basis(m);
-    for (int i = 0; i < m; ++i) basis[i] = n + m + i;
-
-    // ----- Primal simplex (minimisation) -----
-    for (int iter = 0; iter < 200000; ++iter) {
-        // Find entering variable: most negative reduced cost
-        int    enter   = -1;
-        double min_rc  = -1.0e-8;
-        for (int j = 0; j < nvars; ++j) {
-            if (T[m][j] < min_rc) { min_rc = T[m][j]; enter = j; }
+    // solve B * x = a
+    arma::vec ftran(const arma::vec& a) const
+    {
+        arma::vec x = arma::solve(arma::trimatl(L_), P_ * a);
+        x = arma::solve(arma::trimatu(U_), x);
+        for (const auto& eta : etas_) {
+            const double xr = x(eta.r);
+            x += xr * eta.e;
+            x(eta.r) = xr * eta.e(eta.r);
         }
-        if (enter < 0) break;   // optimal
+        return x;
+    }
 
-        // Minimum-ratio test (leaving variable)
-        int    leave    = -1;
-        double min_ratio = 1.0e30;
-        for (int i = 0; i < m; ++i) {
-            if (T[i][enter] > 1.0e-10) {
-                double ratio = T[i][RHS] / T[i][enter];
-                if (ratio < min_ratio - 1.0e-12) { min_ratio = ratio; leave = i; }
-            }
-        }
-        if (leave < 0) return false;   // unbounded
-
-        // Pivot
-        basis[leave] = enter;
-        const double piv = T[leave][enter];
-        for (int j = 0; j <= nvars; ++j) T[leave][j] /= piv;
-        for (int i = 0; i <= m; ++i) {
-            if (i == leave) continue;
-            const double f = T[i][enter];
-            if (std::abs(f) < 1.0e-15) continue;
-            for (int j = 0; j <= nvars; ++j) T[i][j] -= f * T[leave][j];
-        }
+    // solve y^T * B = v^T
+    arma::vec btran(arma::vec v) const
+    {
+        for (auto it = etas_.rbegin(); it != etas_.rend(); ++it)
+            v(it->r) = arma::dot(v, it->e);
+        arma::vec y = arma::solve(arma::trimatl(U_.t()), v);
+        y = arma::solve(arma::trimatu(L_.t()), y);
+        return P_.t() * y;
     }
 
-    // Feasibility check: no artificial still basic with positive value
-    for (int i = 0; i < m; ++i) {
-        if (basis[i] >= n + m && T[i][RHS] > 1.0e-6) return false;
+public:
+    explicit MasterLP(const std::vector<double>& b)
+        : m_(static_cast<int>(b.size())),
+          b_(b)
+    {
+        basis_.resize(m_);
+        for (int i = 0; i < m_; ++i) basis_[i] = -1 - m_ - i;
+        refactor();
     }
 
-    // Primal solution
-    x.assign(n, 0.0);
-    for (int i = 0; i < m; ++i)
-        if (basis[i] < n) x[basis[i]] = T[i][RHS];
+    void addColumn(const std::vector<int>& a, double c)
+    {
+        cols_.push_back(arma::conv_to<arma::vec>::from(a));
+        costs_.push_back(c);
+    }
 
-    // Dual variables: y_i = reduced cost of surplus s_i = T[m][n+i]
-    // (By duality: c_{s_i}=0, column of s_i is -e_i, so T[m][n+i] = y_i >= 0)
-    y.resize(m);
-    for (int i = 0; i < m; ++i) y[i] = T[m][n + i];
+    int nColumns() const { return static_cast<int>(cols_.size()); }
 
-    return true;
-}
+    // Primal simplex from the current basis.
+    // Returns false, if the problem is infeasible or unbounded.
+    bool solve()
+    {
+        refactor();
+
+        const int n = nColumns();
+        int degenerate = 0;
+
+        for (int iter = 0; iter < 200000; ++iter) {
+            arma::vec cB(m_);
+            for (int i = 0; i < m_; ++i) cB(i) = cost(basis_[i]);
+            const arma::vec y = btran(cB);
+
+            // pricing: Dantzig rule, Bland's rule after a run of degenerate pivots
+            const bool bland = degenerate > 50;
+            int    enter  = 0;
+            bool   found  = false;
+            double min_rc = -1.0e-8;
+
+            auto consider = [&](int v, double rc) {
+                if (rc < min_rc) {
+                    enter = v;
+                    found = true;
+                    if (!bland) min_rc = rc;
+                }
+            };
+
+            std::vector<bool> isBasic(n, false);
+            std::vector<bool> surplusBasic(m_, false);
+            for (int v : basis_) {
+                if (v >= 0) isBasic[v] = true;
+                else if (v >= -m_) surplusBasic[-1 - v] = true;
+            }
+
+            for (int j = 0; j < n && !(bland && found); ++j)
+                if (!isBasic[j]) consider(j, costs_[j] - arma::dot(y, cols_[j]));
+            for (int i = 0; i < m_ && !(bland && found); ++i)
+                if (!surplusBasic[i]) consider(-1 - i, y(i));
+
+            if (!found) break;   // optimal
+
+            const arma::vec d = ftran(column(enter));
+
+            // minimum-ratio test (leaving variable)
+            int    leave     = -1;
+            double min_ratio = 1.0e30;
+            for (int i = 0; i < m_; ++i) {
+                if (d(i) > 1.0e-10) {
+                    const double ratio = xB_(i) / d(i);
+                    if (ratio < min_ratio - 1.0e-12) { min_ratio = ratio; leave = i; }
+                }
+            }
+            if (leave < 0) return false;   // unbounded
+
+            degenerate = (min_ratio < 1.0e-12) ? degenerate + 1 : 0;
+
+            // update basic solution and basis inverse
+            xB_ -= min_ratio * d;
+            xB_(leave) = min_ratio;
+            basis_[leave] = enter;
+
+            Eta eta{leave, -d / d(leave)};
+            eta.e(leave) = 1.0 / d(leave);
+            etas_.push_back(std::move(eta));
+
+            if (static_cast<int>(etas_.size()) >= REFACTOR_EVERY) refactor();
+        }
+
+        // feasibility check: no artificial still basic with positive value
+        for (int i = 0; i < m_; ++i)
+            if (basis_[i] < -m_ && xB_(i) > 1.0e-6) return false;
+
+        return true;
+    }
+
+    std::vector<double> primal() const
+    {
+        std::vector<double> x(nColumns(), 0.0);
+        for (int i = 0; i < m_; ++i)
+            if (basis_[i] >= 0) x[basis_[i]] = std::max(0.0, xB_(i));
+        return x;
+    }
+
+    // shadow prices of the >= constraints
+    std::vector<double> dual() const
+    {
+        arma::vec cB(m_);
+        for (int i = 0; i < m_; ++i) cB(i) = cost(basis_[i]);
+        const arma::vec y = btran(cB);
+        return arma::conv_to<std::vector<double>>::from(y);
+    }
+};
 
 // ---------------------------------------------------------------------------
 // Unbounded knapsack (pricing sub-problem for one stock type).
@@ -206,6 +299,80 @@ std::pair<double, std::vector<int>> solveKnapsackDP(
     return {dp[N_BINS], pattern};
 }
 
+// ---------------------------------------------------------------------------
+// Integer repair of a fractional master solution.
+//
+// Uses floor(x) of every pattern and covers the remaining demand with new
+// bars. Each new bar is filled first-fit-decreasing for every stock type,
+// and the stock type with the best utilisation is taken.
+// Returns false, if some demand could not be covered.
+// ---------------------------------------------------------------------------
+bool roundWithRepair(
+    const std::vector<double>& lengths,
+    const std::vector<int>&    demands,
+    const std::vector<double>& stock_lengths,
+    double                     cut_w,
+    const std::vector<double>& x_lp,
+    std::vector<std::pair<int, std::vector<int>>>& patterns,
+    std::vector<int>&                              usage)
+{
+    const int m = static_cast<int>(lengths.size());
+    const int K = static_cast<int>(stock_lengths.size());
+
+    std::vector<int> residual(demands);
+    usage.assign(patterns.size(), 0);
+    for (size_t j = 0; j < x_lp.size(); ++j) {
+        usage[j] = static_cast<int>(std::floor(x_lp[j] + 1.0e-9));
+        for (int i = 0; i < m; ++i)
+            residual[i] -= usage[j] * patterns[j].second[i];
+    }
+
+    std::vector<int> order(m);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return lengths[a] > lengths[b]; });
+
+    for (;;) {
+        bool any_left = false;
+        for (int i = 0; i < m; ++i) any_left = any_left || residual[i] > 0;
+        if (!any_left) return true;
+
+        int              best_k    = -1;
+        double           best_util = 0.0;
+        std::vector<int> best_pat;
+        for (int k = 0; k < K; ++k) {
+            std::vector<int> pat(m, 0);
+            double used = -cut_w, filled = 0.0;
+            for (int i : order) {
+                while (pat[i] < residual[i]
+                       && used + lengths[i] + cut_w <= stock_lengths[k] + 1.0e-9) {
+                    ++pat[i];
+                    used   += lengths[i] + cut_w;
+                    filled += lengths[i];
+                }
+            }
+            const double util = filled / stock_lengths[k];
+            if (filled > 0.0 && util > best_util) {
+                best_util = util;
+                best_k    = k;
+                best_pat  = pat;
+            }
+        }
+        if (best_k < 0) return false;   // remaining pieces fit into no stock
+
+        for (int i = 0; i < m; ++i) residual[i] -= best_pat[i];
+
+        auto existing = std::find(
+            patterns.begin(), patterns.end(), std::make_pair(best_k, best_pat));
+        if (existing != patterns.end()) {
+            usage[existing - patterns.begin()]++;
+        } else {
+            patterns.push_back({best_k, best_pat});
+            usage.push_back(1);
+        }
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Gilmore-Gomory column generation across ALL stock lengths simultaneously.
 //
@@ -213,13 +380,19 @@ std::pair<double, std::vector<int>> solveKnapsackDP(
 // This naturally prefers shorter bars over longer ones when both can cover
 // the same demand, thereby reducing overall scrap.
 //
-// Pricing for stock type k:
+// Pricing for stock type k (all stock types in parallel):
 //   max  sum_i y_i * a_i   s.t.  sum_i (d_i+c)*a_i <= L_k+c,  a_i >= 0 int
 //   Add column if  max  > L_k   (reduced cost = L_k - sum y_i*a_i < 0)
 //
+// The master LP is warm-started from the previous optimal basis after new
+// columns were added. The fractional optimum is then turned into an integer
+// solution, either by rounding all usages up or by rounding down and
+// repairing the remaining demand, whichever consumes less bar length.
+// The repaired solution is only taken, if it covers all demand.
+//
 // Outputs:
 //   patterns – (stock_type_idx, counts[]) for each generated pattern
-//   usage    – rounded-up integer usage of each pattern
+//   usage    – integer usage of each pattern
 // ---------------------------------------------------------------------------
 void runColumnGenerationMultiType(
     const std::vector<double>& lengths,         // m distinct piece lengths
@@ -232,7 +405,8 @@ void runColumnGenerationMultiType(
     const int m = static_cast<int>(lengths.size());
     const int K = static_cast<int>(stock_lengths.size());
     patterns.clear();
-    std::vector<double> costs;   // objective coefficient per pattern = L_k
+
+    MasterLP master(std::vector<double>(demands.begin(), demands.end()));
 
     // ---- Initial patterns: for each stock type k and piece type i ----
     for (int k = 0; k < K; ++k) {
@@ -243,27 +417,21 @@ void runColumnGenerationMultiType(
             const double item = lengths[i] + cut_w;
             p[i] = (item > 1.0e-12) ? std::max(1, static_cast<int>(cap / item)) : 1;
             patterns.push_back({k, p});
-            costs.push_back(stock_lengths[k]);
+            master.addColumn(p, stock_lengths[k]);
         }
     }
 
-    const std::vector<double> dbl_demand(demands.begin(), demands.end());
-
     // ---- Column-generation loop ----
+    bool lp_ok = false;
     for (int iter = 0; iter < 300; ++iter) {
-        const int np = static_cast<int>(patterns.size());
+        lp_ok = master.solve();
+        if (!lp_ok) break;
 
-        std::vector<std::vector<double>> A(m, std::vector<double>(np));
-        for (int i = 0; i < m; ++i)
-            for (int j = 0; j < np; ++j)
-                A[i][j] = static_cast<double>(patterns[j].second[i]);
-
-        std::vector<double> x_lp, y;
-        if (!solveLPRelaxation(A, dbl_demand, costs, x_lp, y)) break;
+        const std::vector<double> y = master.dual();
 
         // For each stock type, price out a new column
-        bool any_added = false;
-        for (int k = 0; k < K; ++k) {
+        std::vector<std::pair<double, std::vector<int>>> priced(K);
+        insight::parallelFor(K, [&](size_t k) {
             // Pieces that don't fit in this stock type get zero value
             std::vector<double> vals(m), wts(m);
             for (int i = 0; i < m; ++i) {
@@ -272,7 +440,12 @@ void runColumnGenerationMultiType(
             }
             const double cap = stock_lengths[k] + cut_w;
 
-            auto [best_val, new_pat] = solveKnapsackDP(vals, wts, cap, m);
+            priced[k] = solveKnapsackDP(vals, wts, cap, m);
+        });
+
+        bool any_added = false;
+        for (int k = 0; k < K; ++k) {
+            const auto& [best_val, new_pat] = priced[k];
 
             // Reduced cost = L_k - best_val; add column when negative
             if (best_val <= stock_lengths[k] + 1.0e-6) continue;
@@ -289,28 +462,44 @@ void runColumnGenerationMultiType(
             if (dup) continue;
 
             patterns.push_back({k, new_pat});
-            costs.push_back(stock_lengths[k]);
+            master.addColumn(new_pat, stock_lengths[k]);
             any_added = true;
         }
         if (!any_added) break;
     }
 
-    // ---- Final LP → round up to integers ----
-    {
-        const int np = static_cast<int>(patterns.size());
-        std::vector<std::vector<double>> A(m, std::vector<double>(np));
-        for (int i = 0; i < m; ++i)
-            for (int j = 0; j < np; ++j)
-                A[i][j] = static_cast<double>(patterns[j].second[i]);
-
-        std::vector<double> x_lp, y;
-        usage.assign(np, 0);
-        if (solveLPRelaxation(A, dbl_demand, costs, x_lp, y)) {
-            for (int j = 0; j < np; ++j)
-                usage[j] = static_cast<int>(std::ceil(x_lp[j] - 1.0e-9));
-        } else {
-            usage.assign(np, 1);
-        }
+    // ---- Final LP → integer solution ----
+    if (lp_ok) lp_ok = master.solve();
+    if (!lp_ok) {
+        usage.assign(patterns.size(), 1);
+        return;
+    }
+
+    const std::vector<double> x_lp = master.primal();
+
+    auto consumed = [&](const std::vector<std::pair<int, std::vector<int>>>& pats,
+                        const std::vector<int>& use) {
+        double total = 0.0;
+        for (size_t j = 0; j < pats.size(); ++j)
+            total += use[j] * stock_lengths[pats[j].first];
+        return total;
+    };
+
+    std::vector<int> usage_ceil(patterns.size());
+    for (size_t j = 0; j < patterns.size(); ++j)
+        usage_ceil[j] = static_cast<int>(std::ceil(x_lp[j] - 1.0e-9));
+
+    auto patterns_rep = patterns;
+    std::vector<int> usage_rep;
+    bool repaired = roundWithRepair(lengths, demands, stock_lengths, cut_w, x_lp,
+                                    patterns_rep, usage_rep);
+
+    if (repaired
+        && consumed(patterns_rep, usage_rep) < consumed(patterns, usage_ceil) - 1.0e-9) {
+        patterns = std::move(patterns_rep);
+        usage    = std::move(usage_rep);
+    } else {
+        usage    = std::move(usage_ceil);
     }
 }
 
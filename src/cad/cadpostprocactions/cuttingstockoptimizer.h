@@ -34,6 +34,12 @@ namespace cad {
  * lengths, minimising scrap.  The required number of bars for each available
  * length is computed by the algorithm.
  *
+ * The master LP is solved by a revised simplex method, which is
+ * warm-started from the previous basis in each column-generation iteration.
+ * The pricing knapsack problems of the stock types are solved in parallel.
+ * The fractional solution is made integral by rounding up, or by rounding
+ * down and repairing the remaining demand, whichever needs less material.
+ *
  * ISCAD syntax:
  * @code
  *   CuttingStock( <cutWidth>, <length1>, <length2>, ... )
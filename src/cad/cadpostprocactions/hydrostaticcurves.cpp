@@ -0,0 +1,416 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "hydrostaticcurves.h"
+
+#include "cadfeature.h"
+#include "parser.h"
+#include "parameterlisthash.h"
+
+#include "base/tools.h"
+
+#include "BRepBuilderAPI_Copy.hxx"
+
+#include <iomanip>
+
+namespace qi  = boost::spirit::qi;
+namespace phx = boost::phoenix;
+
+namespace insight {
+namespace cad {
+
+// ============================================================================
+//  Internal helpers: triangle soup and waterplane clipping
+// ============================================================================
+namespace {
+
+struct Tri
+{
+    arma::mat::fixed<3,3> x; // one vertex per column, ordered with outward normal
+};
+
+// ---------------------------------------------------------------------------
+// Triangulate the closed hull volume once. Triangles of reversed faces are
+// flipped, so that all triangles are oriented with the outward normal.
+// ---------------------------------------------------------------------------
+std::vector<Tri> triangulateHull(const TopoDS_Shape& hull, double deflection)
+{
+    TopoDS_Shape s = BRepBuilderAPI_Copy(hull).Shape();
+
+#if (OCC_VERSION_MAJOR>=7 && OCC_VERSION_MINOR>=4)
+    IMeshTools_Parameters p;
+    p.Angle=0.2;
+    p.Deflection=deflection;
+    p.Relative=false;
+    p.InParallel=true;
+    BRepMesh_IncrementalMesh m(s, p);
+#else
+    BRepMesh_IncrementalMesh m(s, deflection, false, 0.2, true);
+#endif
+
+    std::vector<Tri> tris;
+    for (TopExp_Explorer ex(s, TopAbs_FACE); ex.More(); ex.Next())
+    {
+        const TopoDS_Face& f = TopoDS::Face(ex.Current());
+        TopLoc_Location loc;
+        auto mesh = BRep_Tool::Triangulation(f, loc);
+        insight::assertion(
+            !mesh.IsNull(),
+            "hull face has no triangulation!" );
+
+        bool rev = (f.Orientation()==TopAbs_REVERSED);
+        gp_Trsf tr = loc.Transformation();
+
+        for (int i=1; i<=mesh->NbTriangles(); ++i)
+        {
+            auto t=mesh->
+#if OCC_VERSION_MAJOR<7
+                     Triangles().Value(i)
+#else
+                     Triangle(i)
+#endif
+                ;
+            int n[3];
+            t.Get(n[0], n[1], n[2]);
+            if (rev) std::swap(n[1], n[2]);
+
+            Tri tri;
+            for (int k=0; k<3; ++k)
+            {
+                gp_Pnt pk = mesh->
+#if OCC_VERSION_MAJOR<7
+                         Nodes().Value(n[k])
+#else
+                         Node(n[k])
+#endif
+                    .Transformed(tr);
+                tri.x(0,k)=pk.X();
+                tri.x(1,k)=pk.Y();
+                tri.x(2,k)=pk.Z();
+            }
+            tris.push_back(tri);
+        }
+    }
+
+    insight::assertion(
+        tris.size()>0,
+        "hull volume has no triangles!" );
+
+    return tris;
+}
+
+
+// ---------------------------------------------------------------------------
+// Integrate the part of the closed triangulated surface below the plane
+// (p0, n).
+//
+// Volume and first moment: divergence theorem with tetrahedra from p0. The
+// closing cap lies in the plane and contributes nothing.
+//
+// Waterplane: the cap boundary is assembled from the clipped triangle edges
+// which lie in the plane. They are oriented counter-clockwise around n and
+// integrated with the polygon area/moment formulas in in-plane coordinates
+// (u, w), with u x w = n.
+// ---------------------------------------------------------------------------
+void integrateSubmerged(
+    const std::vector<Tri>& tris,
+    const arma::mat& p0,
+    const arma::mat& u, const arma::mat& w, const arma::mat& n,
+    HydrostaticCurves::Condition& c )
+{
+    double V=0.;
+    arma::mat S=arma::zeros(3);
+
+    double A=0., Su=0., Sw=0., Iuu=0., Iww=0.;
+
+    auto addTet = [&](const arma::mat& a, const arma::mat& b, const arma::mat& cc)
+    {
+        double dv = arma::dot(a-p0, arma::cross(b-p0, cc-p0))/6.;
+        V += dv;
+        S += dv*0.25*(p0+a+b+cc);
+    };
+
+    auto addCapEdge = [&](const arma::mat& a, const arma::mat& b)
+    {
+        double x0=arma::dot(a-p0, u), y0=arma::dot(a-p0, w);
+        double x1=arma::dot(b-p0, u), y1=arma::dot(b-p0, w);
+        double cr = x0*y1 - x1*y0;
+        A   += cr/2.;
+        Su  += (x0+x1)*cr/6.;
+        Sw  += (y0+y1)*cr/6.;
+        Iuu += (x0*x0+x0*x1+x1*x1)*cr/12.;
+        Iww += (y0*y0+y0*y1+y1*y1)*cr/12.;
+    };
+
+    for (const auto& t: tris)
+    {
+        double d[3];
+        for (int k=0; k<3; ++k)
+            d[k]=arma::dot(t.x.col(k)-p0, n);
+
+        if (d[0]>=0. && d[1]>=0. && d[2]>=0.)
+            continue; // dry
+
+        if (d[0]<0. && d[1]<0. && d[2]<0.)
+        {
+            addTet(t.x.col(0), t.x.col(1), t.x.col(2));
+            continue;
+        }
+
+        // Sutherland-Hodgman, keep d<0
+        std::vector<arma::mat> poly;
+        arma::mat xEnter, xExit;
+        for (int k=0; k<3; ++k)
+        {
+            int l=(k+1)%3;
+            arma::mat xk=t.x.col(k), xl=t.x.col(l);
+            bool ink=d[k]<0., inl=d[l]<0.;
+            if (ink) poly.push_back(xk);
+            if (ink!=inl)
+            {
+                arma::mat xi = xk + (d[k]/(d[k]-d[l]))*(xl-xk);
+                poly.push_back(xi);
+                if (ink) xExit=xi; else xEnter=xi;
+            }
+        }
+
+        for (size_t k=1; k+1<poly.size(); ++k)
+            addTet(poly[0], poly[k], poly[k+1]);
+
+        addCapEdge(xEnter, xExit);
+    }
+
+    c.V=V;
+    c.B= V>0. ? arma::mat(S/V) : arma::mat(p0);
+
+    c.Awp=A;
+    double uc=0., wc=0.;
+    if (A>0.)
+    {
+        uc=Su/A;
+        wc=Sw/A;
+    }
+    c.F = p0 + uc*u + wc*w;
+    c.IT = Iww - A*wc*wc;
+    c.IL = Iuu - A*uc*uc;
+}
+
+} // anonymous namespace
+
+
+
+// ============================================================================
+//  HydrostaticCurves
+// ============================================================================
+
+defineType(HydrostaticCurves);
+addToStaticFunctionTable2(
+    PostprocAction, InsertRule, insertrule,
+    HydrostaticCurves, &HydrostaticCurves::insertrule );
+
+size_t HydrostaticCurves::calcHash() const
+{
+    ParameterListHash h;
+    h+=*hullvolume_;
+    h+=*shipmodel_;
+    h+=*pref_;
+    h+=*elong_;
+    h+=*evert_;
+    for (const auto& s: drafts_) h+=*s;
+    for (const auto& s: heels_) h+=*s;
+    for (const auto& s: trims_) h+=*s;
+    return h.getHash();
+}
+
+
+HydrostaticCurves::HydrostaticCurves(
+    FeaturePtr hullvolume,
+    FeaturePtr shipmodel,
+    VectorPtr pref,
+    VectorPtr elong,
+    VectorPtr evert,
+    const ScalarList& drafts,
+    const ScalarList& heels,
+    const ScalarList& trims )
+: hullvolume_(hullvolume), shipmodel_(shipmodel),
+  pref_(pref), elong_(elong), evert_(evert),
+  drafts_(drafts), heels_(heels), trims_(trims)
+{}
+
+
+void HydrostaticCurves::build()
+{
+    conditions_.clear();
+
+    arma::mat pref=pref_->value();
+    arma::mat ez=normalise(evert_->value());
+    arma::mat ex=normalise(orthogonalPart(elong_->value(), ez));
+    arma::mat ey=arma::cross(ez, ex);
+
+    arma::mat bbs=hullvolume_->modelBndBoxSize();
+    auto tris = triangulateHull(
+        hullvolume_->shape(), 1e-3*arma::as_scalar(arma::max(bbs)) );
+
+    double m=shipmodel_->mass();
+    arma::mat G=shipmodel_->modelCoG();
+
+    for (const auto& T: drafts_)
+        for (const auto& phi: heels_)
+            for (const auto& theta: trims_)
+            {
+                Condition c;
+                c.T=T->value();
+                c.heel=phi->value();
+                c.trim=theta->value();
+                conditions_.push_back(c);
+            }
+
+    insight::parallelFor(
+        conditions_.size(),
+        [&](size_t i)
+        {
+            auto& c=conditions_[i];
+
+            arma::mat R = rotMatrix(c.trim, ey) * rotMatrix(c.heel, ex);
+            arma::mat u=R*ex, w=R*ey, n=R*ez;
+            arma::mat p0 = pref + c.T*ez;
+
+            integrateSubmerged(tris, p0, u, w, n, c);
+
+            c.KB = arma::dot(c.B-pref, n);
+            c.KG = arma::dot(G-pref, n);
+            c.BMT = c.V>0. ? c.IT/c.V : 0.;
+            c.BML = c.V>0. ? c.IL/c.V : 0.;
+            c.GMT = c.KB + c.BMT - c.KG;
+            c.GML = c.KB + c.BML - c.KG;
+            c.LCB = arma::dot(c.B-pref, u);
+            c.LCF = arma::dot(c.F-pref, u);
+        } );
+
+    std::cout<<"ship mass m="<<m<<std::endl;
+    write(std::cout);
+}
+
+
+const std::vector<HydrostaticCurves::Condition>& HydrostaticCurves::conditions() const
+{
+    checkForBuildDuringAccess();
+    return conditions_;
+}
+
+
+std::shared_ptr<TabularResult> HydrostaticCurves::table() const
+{
+    checkForBuildDuringAccess();
+
+    TabularResult::Table rows;
+    for (const auto& c: conditions_)
+    {
+        rows.push_back({
+            c.T, c.heel*180./M_PI, c.trim*180./M_PI,
+            c.V, c.KB, c.BMT, c.BML, c.GMT, c.GML,
+            c.Awp, c.LCB, c.LCF
+        });
+    }
+
+    return std::make_shared<TabularResult>(
+        TabularResult::Headings{
+            "T", "$\\varphi$", "$\\vartheta$",
+            "V", "KB", "$BM_T$", "$BM_L$", "$GM_T$", "$GM_L$",
+            "$A_{WP}$", "LCB", "LCF" },
+        rows,
+        "Hydrostatic curves",
+        "Hydrostatic properties over draft T, heel $\\varphi$ and trim $\\vartheta$ (angles in degrees)",
+        "" );
+}
+
+
+void HydrostaticCurves::write(std::ostream& os) const
+{
+    os << std::setw(12) << "T"
+       << std::setw(12) << "heel[deg]"
+       << std::setw(12) << "trim[deg]"
+       << std::setw(14) << "V"
+       << std::setw(12) << "KB"
+       << std::setw(12) << "BM_T"
+       << std::setw(12) << "BM_L"
+       << std::setw(12) << "GM_T"
+       << std::setw(12) << "GM_L"
+       << std::setw(14) << "A_WP"
+       << std::setw(12) << "LCB"
+       << std::setw(12) << "LCF"
+       << std::endl;
+
+    for (const auto& c: conditions_)
+    {
+        os << std::setw(12) << c.T
+           << std::setw(12) << c.heel*180./M_PI
+           << std::setw(12) << c.trim*180./M_PI
+           << std::setw(14) << c.V
+           << std::setw(12) << c.KB
+           << std::setw(12) << c.BMT
+           << std::setw(12) << c.BML
+           << std::setw(12) << c.GMT
+           << std::setw(12) << c.GML
+           << std::setw(14) << c.Awp
+           << std::setw(12) << c.LCB
+           << std::setw(12) << c.LCF
+           << std::endl;
+    }
+}
+
+
+void HydrostaticCurves::insertrule(parser::ISCADParser& ruleset)
+{
+    // Synthesised attributes (in sequence, ignoring literals):
+    //   _1..3 = VectorPtr          (pref, elong, evert)
+    //   _4..6 = vector<ScalarPtr>  (drafts, heels, trims)
+    //   _7, _8 = FeaturePtr        (hull volume, ship model)
+
+    ruleset.postProcFunctionRules.add(
+        "HydrostaticCurves",
+        std::make_shared<parser::ISCADParser::PostProcFunctionRule>(
+            (
+                qi::lit('(')
+                > ruleset.r_vectorExpression > qi::lit(',')
+                > ruleset.r_vectorExpression > qi::lit(',')
+                > ruleset.r_vectorExpression > qi::lit(',')
+                > qi::lit('(') > (ruleset.r_scalarExpression % qi::lit(',')) > qi::lit(')') > qi::lit(',')
+                > qi::lit('(') > (ruleset.r_scalarExpression % qi::lit(',')) > qi::lit(')') > qi::lit(',')
+                > qi::lit('(') > (ruleset.r_scalarExpression % qi::lit(',')) > qi::lit(')')
+                > qi::lit(')')
+                > qi::lit("<<")
+                > qi::lit('(') > ruleset.r_solidmodel_expression > qi::lit(',')
+                > ruleset.r_solidmodel_expression > qi::lit(')')
+                > qi::lit(';')
+            )
+            [
+                qi::_val = phx::bind(
+                    &HydrostaticCurves::create<
+                        FeaturePtr, FeaturePtr,
+                        VectorPtr, VectorPtr, VectorPtr,
+                        const ScalarList&, const ScalarList&, const ScalarList&>,
+                    qi::_7, qi::_8, qi::_1, qi::_2, qi::_3, qi::_4, qi::_5, qi::_6)
+            ]
+        )
+    );
+}
+
+} // namespace cad
+} // namespace insight
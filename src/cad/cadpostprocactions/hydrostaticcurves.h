@@ -0,0 +1,138 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INSIGHT_CAD_HYDROSTATICCURVES_H
+#define INSIGHT_CAD_HYDROSTATICCURVES_H
+
+#include "cadtypes.h"
+#include "cadpostprocaction.h"
+
+#include "base/resultelements/tabularresult.h"
+
+namespace insight {
+namespace cad {
+
+/**
+ * @brief HydrostaticCurves
+ *
+ * Evaluates the hydrostatic properties of a hull for every combination
+ * of a list of drafts, heel angles and trim angles (hydrostatic tables).
+ *
+ * The hull is triangulated once. Each floating condition is then evaluated
+ * by clipping the triangulation at the waterplane, which is much cheaper
+ * than a boolean cut per condition. The conditions are evaluated in parallel.
+ *
+ * The draft is measured from the reference point along the vertical
+ * direction. The waterplane is heeled around the longitudinal direction and
+ * trimmed around the lateral direction, both through the point at the
+ * respective draft. Angles are given in radians.
+ *
+ * ISCAD syntax:
+ * @code
+ *   HydrostaticCurves( <pref>, <elong>, <evert>,
+ *                      (<T1>, <T2>, ...),
+ *                      (<heel1>, <heel2>, ...),
+ *                      (<trim1>, <trim2>, ...) )
+ *       << ( hullvolume, shipmodel );
+ * @endcode
+ *
+ * The results are available as a TabularResult (one row per condition)
+ * and are written to std::cout.
+ */
+class HydrostaticCurves
+    : public PostprocAction
+{
+public:
+    typedef std::vector<ScalarPtr> ScalarList;
+
+    /**
+     * @brief The Condition struct
+     * hydrostatic properties of a single floating condition
+     */
+    struct Condition
+    {
+        double T, heel, trim;
+
+        /** submerged volume */
+        double V;
+        /** centre of buoyancy */
+        arma::mat B;
+
+        /** waterplane area */
+        double Awp;
+        /** centre of floatation */
+        arma::mat F;
+        /** transverse and longitudinal second moments of the waterplane area */
+        double IT, IL;
+
+        /** heights above reference point, normal to the waterplane */
+        double KB, KG;
+        double BMT, BML, GMT, GML;
+
+        /** longitudinal positions relative to reference point */
+        double LCB, LCF;
+    };
+
+private:
+    FeaturePtr hullvolume_;
+    FeaturePtr shipmodel_;
+
+    VectorPtr pref_;
+    VectorPtr elong_;
+    VectorPtr evert_;
+
+    ScalarList drafts_, heels_, trims_;
+
+    std::vector<Condition> conditions_;
+
+    size_t calcHash() const override;
+    void build() override;
+
+    HydrostaticCurves(
+        FeaturePtr hullvolume,
+        FeaturePtr shipmodel,
+        VectorPtr pref,
+        VectorPtr elong,
+        VectorPtr evert,
+        const ScalarList& drafts,
+        const ScalarList& heels,
+        const ScalarList& trims );
+
+public:
+    declareType("HydrostaticCurves");
+    CREATE_FUNCTION(HydrostaticCurves);
+
+    static void insertrule(parser::ISCADParser& ruleset);
+
+    const std::vector<Condition>& conditions() const;
+
+    /**
+     * @brief table
+     * @return
+     * one row per evaluated floating condition
+     */
+    std::shared_ptr<TabularResult> table() const;
+
+    void write(std::ostream& ) const override;
+};
+
+} // namespace cad
+} // namespace insight
+
+#endif // INSIGHT_CAD_HYDROSTATICCURVES_H
@@ -83,7 +83,6 @@ void Hydrostatics::build()
   if (!csf)
     throw insight::Exception("No cut surface present!");
 
-  // write surface for debug
   TopoDS_Shape issh=static_cast<const TopoDS_Shape&>(*csf);
   
 //  std::cout<<issh<<std::endl;
@@ -94,8 +93,6 @@ void Hydrostatics::build()
   if (ex.More()) std::cout<<"yet another"<<std::endl; }
 //     throw insight::Exception("cut surface consists of more than a single face!");
   
-  BRepTools::Write(f, "test.brep");
-  
   GProp_GProps props;
   BRepGProp::SurfaceProperties(f, props);
   GProp_PrincipalProps pcp = props.PrincipalProperties();
@@ -751,159 +751,492 @@ void ConstrainedSketch::changeSolverSettings(const ConstrainedSketch::SolverSett
 
 
 
-void ConstrainedSketch::resolveConstraints(
-    std::function<void(void)> perIterationCallback,
-    ProgressDisplayer& progress
-    )
+namespace
+{
+
+
+/**
+ * The constraint system of a sketch.
+ * Knows, which constraint errors depend on which DoFs
+ * and which entities have to be invalidated, when a DoF is changed.
+ */
+class SketchConstraintSystem
 {
-    struct LocalIndexMapping {
-        insight::cad::ConstrainedSketchEntity* entity;
+public:
+    struct DoF
+    {
+        ConstrainedSketchEntity* entity;
         int iLocal;
-        GeometryMap::const_iterator entityIt;
+        ConstrainedSketch::GeometryMap::const_iterator entityIt;
     };
-    std::vector<LocalIndexMapping> dofs, constrs;
 
-    for (auto ge=geometry_.begin(); ge!=geometry_.end(); ge++)
+    struct Constraint
     {
-        auto &e=ge->second;
+        ConstrainedSketchEntity* entity;
+        int iLocal;
+        ConstrainedSketch::GeometryMap::const_iterator entityIt;
+        std::vector<int> dofs; // DoFs, on which the error depends
+    };
+
+    std::vector<DoF> dofs;
+    std::vector<Constraint> constrs;
+    std::vector<std::vector<int> > constraintsOfDoF;
+
+private:
+    ConstrainedSketch::GeometryMap::const_iterator geometryBegin_;
+    std::map<std::pair<ConstrainedSketchEntity*, int>, int> dofIndex_;
+
+    // entities, whose cached geometry depends on the DoFs of the key entity
+    std::map<ConstrainedSketchEntity*, std::vector<ASTBase*> > affected_;
+
+    static std::set<ConstrainedSketchEntity*> upstreamEntities(ConstrainedSketchEntity* e)
+    {
+        std::set<ConstrainedSketchEntity*> result{e};
+        std::vector<ConstrainedSketchEntity*> front{e};
+        while (!front.empty())
+        {
+            auto c=front.back();
+            front.pop_back();
+            for (const auto& d: c->solverDependencies())
+            {
+                if (auto de=d.lock())
+                {
+                    if (result.insert(de.get()).second)
+                        front.push_back(de.get());
+                }
+            }
+        }
+        return result;
+    }
 
-        for (int i=0; i<e->nDoF(); ++i)
+public:
+    SketchConstraintSystem(const ConstrainedSketch::GeometryMap& geometry)
+      : geometryBegin_(geometry.cbegin())
+    {
+        for (auto ge=geometry.begin(); ge!=geometry.end(); ++ge)
         {
-            dofs.push_back({e.get(), i, ge});
+            auto e=ge->second.get();
+            for (int i=0; i<e->nDoF(); ++i)
+            {
+                dofIndex_[{e, i}]=dofs.size();
+                dofs.push_back({e, i, ge});
+            }
         }
-        for (int i=0; i<e->nConstraints(); ++i)
+        constraintsOfDoF.resize(dofs.size());
+
+        for (auto ge=geometry.begin(); ge!=geometry.end(); ++ge)
         {
-            constrs.push_back({e.get(), i, ge});
+            auto e=ge->second.get();
+            auto upstream=upstreamEntities(e);
+
+            std::vector<int> edofs;
+            for (auto* u: upstream)
+            {
+                for (int i=0; i<u->nDoF(); ++i)
+                {
+                    auto j=dofIndex_.find({u, i});
+                    if (j!=dofIndex_.end())
+                        edofs.push_back(j->second);
+                }
+                if (u->nDoF()>0)
+                {
+                    if (auto ae=dynamic_cast<ASTBase*>(e))
+                        affected_[u].push_back(ae);
+                }
+            }
+            std::sort(edofs.begin(), edofs.end());
+
+            for (int i=0; i<e->nConstraints(); ++i)
+            {
+                for (auto j: edofs)
+                    constraintsOfDoF[j].push_back(constrs.size());
+                constrs.push_back({e, i, ge, edofs});
+            }
         }
     }
 
+    int dofIndex(ConstrainedSketchEntity* e, int iLocal) const
+    {
+        auto i=dofIndex_.find({e, iLocal});
+        if (i==dofIndex_.end())
+            return -1;
+        return i->second;
+    }
 
-    arma::mat x0 = arma::zeros(dofs.size());
-    for (int i=0; i<dofs.size(); ++i)
+    double value(int iDoF) const
     {
-        auto& dm=dofs[i];
-        x0(i)=dm.entity->getDoFValue(dm.iLocal);
+        auto& d=dofs[iDoF];
+        return d.entity->getDoFValue(d.iLocal);
     }
 
-    auto setX = [&](const arma::mat& x)
+    /**
+     * set the values of the given DoFs and invalidate
+     * only the entities, which depend on them
+     */
+    void setValues(const std::vector<int>& iDoFs, const arma::mat& x)
     {
-        for (int i=0; i<dofs.size(); ++i)
+        std::set<ConstrainedSketchEntity*> changed;
+        for (size_t k=0; k<iDoFs.size(); ++k)
         {
-            auto& dm=dofs[i];
-            dm.entity->setDoFValue(dm.iLocal, x(i));
+            auto& d=dofs[iDoFs[k]];
+            d.entity->setDoFValue(d.iLocal, x(k));
+            changed.insert(d.entity);
         }
-        for (auto& se: geometry_)
+        for (auto* c: changed)
         {
-            if ( auto e = std::dynamic_pointer_cast<ASTBase>(se.second) )
+            auto a=affected_.find(c);
+            if (a!=affected_.end())
             {
-                e->invalidate();
+                for (auto* e: a->second)
+                    e->invalidate();
             }
         }
+    }
+
+    double error(int iConstr) const
+    {
+        auto& c=constrs[iConstr];
+        return c.entity->getConstraintError(c.iLocal);
+    }
+
+    std::string entityLabel(ConstrainedSketch::GeometryMap::const_iterator i) const
+    {
+        return toString(std::distance(geometryBegin_, i));
+    }
+};
+
+
+
+
+/**
+ * Solve the subsystem of the given constraints for the given DoFs
+ * by a Levenberg-Marquardt iteration. All other DoFs are kept fixed.
+ * The Jacobian is assembled from the analytic gradients, where available,
+ * and by finite differences of only the affected constraints otherwise.
+ *
+ * @return
+ * true, if the sum of the absolute constraint errors is below the tolerance
+ * (or at round-off level, if the tolerance is even smaller)
+ */
+bool solveSubsystem(
+    SketchConstraintSystem& sys,
+    const std::vector<int>& blockConstrs,
+    const std::vector<int>& blockDoFs,
+    const ConstrainedSketch::SolverSettings& settings,
+    std::function<void(void)> perIterationCallback,
+    int& nIter )
+{
+    const int m=blockConstrs.size(), n=blockDoFs.size();
+
+    std::map<int,int> rowOfConstr, colOfDoF;
+    for (int i=0; i<m; ++i) rowOfConstr[blockConstrs[i]]=i;
+    for (int j=0; j<n; ++j) colOfDoF[blockDoFs[j]]=j;
+
+    auto residual = [&]()
+    {
+        arma::mat f=arma::zeros(m);
+        for (int i=0; i<m; ++i)
+            f(i)=sys.error(blockConstrs[i]);
+        return f;
     };
 
+    auto jacobian = [&](const arma::mat& x, const arma::mat& f)
+    {
+        arma::mat J=arma::zeros(m, n);
+
+        std::vector<bool> analytic(m, false);
+        for (int i=0; i<m; ++i)
+        {
+            auto& c=sys.constrs[blockConstrs[i]];
+            ConstrainedSketchEntity::ConstraintGradient g;
+            if (c.entity->getConstraintGradient(c.iLocal, g))
+            {
+                analytic[i]=true;
+                for (const auto& gi: g)
+                {
+                    auto jd=colOfDoF.find(
+                        sys.dofIndex(gi.first.first, gi.first.second) );
+                    if (jd!=colOfDoF.end())
+                        J(i, jd->second)+=gi.second;
+                }
+            }
+        }
+
+        for (int j=0; j<n; ++j)
+        {
+            std::vector<int> rows;
+            for (auto ic: sys.constraintsOfDoF[blockDoFs[j]])
+            {
+                auto r=rowOfConstr.find(ic);
+                if (r!=rowOfConstr.end() && !analytic[r->second])
+                    rows.push_back(r->second);
+            }
+            if (rows.empty()) continue;
+
+            double h=1e-7*std::max(1., fabs(x(j)));
+            sys.setValues({blockDoFs[j]}, arma::mat{x(j)+h});
+            for (auto r: rows)
+                J(r, j)=(sys.error(blockConstrs[r])-f(r))/h;
+            sys.setValues({blockDoFs[j]}, arma::mat{x(j)});
+        }
+        return J;
+    };
+
+    arma::mat x=arma::zeros(n);
+    for (int j=0; j<n; ++j)
+        x(j)=sys.value(blockDoFs[j]);
+
+    arma::mat f=residual();
+    double Q=arma::dot(f, f);
+    double lambda=1e-3;
+
+    auto converged = [&]()
+    {
+        double roundOff = 100.*arma::datum::eps*m*(1.+arma::abs(x).max());
+        return arma::accu(arma::abs(f)) < std::max(settings.tolerance_, roundOff);
+    };
+
+    for (int iter=0; iter<settings.maxIter_; ++iter, ++nIter)
+    {
+        if (converged())
+            return true;
+
+        arma::mat J=jacobian(x, f);
+        arma::mat A=J.t()*J;
+        arma::mat g=J.t()*f;
+        arma::mat D=arma::diagmat(arma::clamp(A.diag(), 1e-12, arma::datum::inf));
+
+        bool accepted=false;
+        while (!accepted && lambda<1e16)
+        {
+            arma::mat dx;
+            if (arma::solve(dx, A+lambda*D, -g, arma::solve_opts::no_approx))
+            {
+                arma::mat xn=x+settings.relax_*dx;
+                sys.setValues(blockDoFs, xn);
+                arma::mat fn=residual();
+                double Qn=arma::dot(fn, fn);
+                if (Qn<Q)
+                {
+                    bool stagnating =
+                        (Q-Qn < settings.tolerance_*Q)
+                        || (arma::norm(xn-x, 2) < settings.tolerance_*(arma::norm(x, 2)+settings.tolerance_));
+                    x=xn; f=fn; Q=Qn;
+                    lambda=std::max(0.1*lambda, 1e-12);
+                    accepted=true;
+
+                    if (perIterationCallback)
+                        perIterationCallback();
+
+                    if (stagnating)
+                    {
+                        return converged();
+                    }
+                }
+            }
+            if (!accepted)
+                lambda*=10.;
+        }
+
+        if (!accepted)
+        {
+            // no further reduction possible, x is a (local) minimum
+            sys.setValues(blockDoFs, x);
+            return converged();
+        }
+    }
+
+    return converged();
+}
+
+
+}
+
+
+
+
+void ConstrainedSketch::resolveConstraints(
+    std::function<void(void)> perIterationCallback,
+    ProgressDisplayer& progress
+    )
+{
+    CurrentExceptionContext ex("solving the constraints of sketch");
+
+    SketchConstraintSystem sys(geometry_);
+    const int nDoFs=sys.dofs.size(), nConstrs=sys.constrs.size();
 
     auto solverType = solverSettings_.solver_;
 
     if (
-        (constrs.size()!=dofs.size())
+        (nConstrs!=nDoFs)
         &&
         (solverType==rootND)
        )
     {
-        // progress.message( str(boost::format(
-        //     "Number of contraints (%d) not equal to number of DoF (%d)!"
-        //     " Cannot use root solver, swithing to minimizer!")
-        //      % constrs.size() % dofs.size()) );
-
-        // solverType=minimumND;
         throw insight::Exception(
             "Number of contraints (%d) not equal to number of DoF (%d)!"
             " Cannot use root solver!",
-            constrs.size(), dofs.size() );
+            nConstrs, nDoFs );
 
     }
 
-    arma::mat xsol;
+    int nIter=0;
+
     switch (solverType)
     {
         case minimumND:
         {
-            xsol = nonlinearMinimizeND(
-                [&](const arma::mat& x) -> double
-                {
-                    setX(x);
+            // independent clusters: connected components of the constraint graph
+            std::vector<int> compOfConstr(nConstrs, -1);
+            int nComp=0;
+            for (int c0=0; c0<nConstrs; ++c0)
+            {
+                if (compOfConstr[c0]>=0) continue;
 
-                    double Q=0;
-                    for (int i=0;i<constrs.size();++i)
+                std::vector<int> cc, cd, front{c0};
+                std::set<int> visitedDoFs;
+                compOfConstr[c0]=nComp;
+                while (!front.empty())
+                {
+                    auto c=front.back();
+                    front.pop_back();
+                    cc.push_back(c);
+                    for (auto d: sys.constrs[c].dofs)
                     {
-                        auto& constr = constrs[i];
-                        Q+=pow(constr.entity->getConstraintError(constr.iLocal), 2);
+                        if (visitedDoFs.insert(d).second)
+                        {
+                            cd.push_back(d);
+                            for (auto c2: sys.constraintsOfDoF[d])
+                            {
+                                if (compOfConstr[c2]<0)
+                                {
+                                    compOfConstr[c2]=nComp;
+                                    front.push_back(c2);
+                                }
+                            }
+                        }
                     }
-                    insight::dbg()<<"Q="<<Q<<std::endl;
-                    return Q;
-                },
-                x0, solverSettings_.tolerance_, arma::mat(),
-                solverSettings_.maxIter_, solverSettings_.relax_
-                );
+                }
+                nComp++;
+
+                if (!cd.empty())
+                {
+                    std::sort(cc.begin(), cc.end());
+                    std::sort(cd.begin(), cd.end());
+                    solveSubsystem(
+                        sys, cc, cd, solverSettings_,
+                        perIterationCallback, nIter );
+                }
+            }
+            insight::dbg()<<"solved "<<nComp<<" independent clusters in "<<nIter<<" iterations"<<std::endl;
         }
         break;
 
         case rootND:
         {
-            for (int i=0;i<constrs.size();++i)
+            // match every constraint to one DoF (augmenting paths)
+            std::vector<int> dofOfConstr(nConstrs, -1), constrOfDoF(nDoFs, -1);
+            std::vector<int> visitStamp(nDoFs, -1);
+            std::function<bool(int,int)> augment = [&](int c, int stamp)
             {
-                auto& constr=constrs[i];
-                insight::dbg()<<"constraint "<<i<<" : idx "<<constr.iLocal<<" of "<<constr.entity->type()<<endl;
-            }
+                for (auto d: sys.constrs[c].dofs)
+                {
+                    if (visitStamp[d]==stamp) continue;
+                    visitStamp[d]=stamp;
+                    if (constrOfDoF[d]<0 || augment(constrOfDoF[d], stamp))
+                    {
+                        constrOfDoF[d]=c;
+                        dofOfConstr[c]=d;
+                        return true;
+                    }
+                }
+                return false;
+            };
+            for (int c=0; c<nConstrs; ++c)
+                augment(c, c);
 
-            try
+            std::set<std::string> ucdofs;
+            for (int d=0; d<nDoFs; ++d)
             {
-             xsol = nonlinearSolveND(
-                [&](const arma::mat& x) -> arma::mat
-                {
+                if (constrOfDoF[d]<0)
+                    ucdofs.insert(sys.entityLabel(sys.dofs[d].entityIt));
+            }
+            if (!ucdofs.empty())
+            {
+                throw insight::Exception(
+                    "solve failed because of unconstrained DoFs\n"
+                    "enties with unconstrained DoFs are: %s",
+                    boost::algorithm::join(ucdofs, ", ").c_str());
+            }
 
-                    setX(x);
+            // block triangular decomposition:
+            // strongly connected components of the graph
+            // "constraint c needs the DoF matched to constraint c2" (Tarjan).
+            // They are found in an order, in which each block only needs
+            // DoFs of itself or of blocks found before.
+            std::vector<int> index(nConstrs, -1), lowlink(nConstrs, 0), stack;
+            std::vector<bool> onStack(nConstrs, false);
+            int nextIndex=0, nBlocks=0;
 
-                    if (perIterationCallback)
-                        perIterationCallback();
-
-                    arma::mat Qs=arma::zeros(constrs.size());
+            std::function<void(int)> strongConnect = [&](int c)
+            {
+                index[c]=lowlink[c]=nextIndex++;
+                stack.push_back(c);
+                onStack[c]=true;
 
-                    for (int i=0;i<constrs.size();++i)
+                for (auto d: sys.constrs[c].dofs)
+                {
+                    auto c2=constrOfDoF[d];
+                    if (index[c2]<0)
                     {
-                        auto& constr=constrs[i];
-                        Qs(i)=constr.entity->getConstraintError(constr.iLocal);
+                        strongConnect(c2);
+                        lowlink[c]=std::min(lowlink[c], lowlink[c2]);
                     }
-                    insight::dbg()<<"Q="<<Qs.t()<<std::endl;
-                    return Qs;
-                },
-                x0, solverSettings_.tolerance_,
-                solverSettings_.maxIter_, solverSettings_.relax_
-                );
-            }
-            catch (insight::JacobiDeterminatException& ex)
-            {
-                std::set<std::string> ucdofs;
-                for (int i=0; i<dofs.size(); ++i)
+                    else if (onStack[c2])
+                    {
+                        lowlink[c]=std::min(lowlink[c], index[c2]);
+                    }
+                }
+
+                if (lowlink[c]==index[c])
                 {
-                    auto& dm=dofs[i];
-                    if (ex.zeroCols().count(i))
+                    std::vector<int> bc, bd;
+                    int c2;
+                    do
                     {
-                        auto i=std::distance(geometry_.cbegin(), dm.entityIt);
-                        ucdofs.insert(toString(i));
+                        c2=stack.back();
+                        stack.pop_back();
+                        onStack[c2]=false;
+                        bc.push_back(c2);
+                        bd.push_back(dofOfConstr[c2]);
+                    }
+                    while (c2!=c);
+
+                    nBlocks++;
+                    if (!solveSubsystem(
+                            sys, bc, bd, solverSettings_,
+                            perIterationCallback, nIter ))
+                    {
+                        std::set<std::string> ents;
+                        for (auto ic: bc)
+                            ents.insert(sys.entityLabel(sys.constrs[ic].entityIt));
+                        throw insight::Exception(
+                            "the solver did not converge towards a solution after %d iterations.\n"
+                            "unsatisfied constraints are: %s",
+                            nIter, boost::algorithm::join(ents, ", ").c_str() );
                     }
                 }
+            };
 
-                throw insight::Exception(
-                    "solve failed because of unconstrained DoFs\n"
-                    "enties with unconstrained DoFs are: %s",
-                    boost::algorithm::join(ucdofs, ", ").c_str());
+            for (int c=0; c<nConstrs; ++c)
+            {
+                if (index[c]<0)
+                    strongConnect(c);
             }
+            insight::dbg()<<"solved "<<nBlocks<<" blocks in "<<nIter<<" iterations"<<std::endl;
         }
         break;
     }
-
-    setX(xsol);
 }
 
 
@@ -306,6 +306,12 @@ public:
     const SolverSettings& solverSettings() const;
     void changeSolverSettings(const SolverSettings& ss);
 
+    /**
+     * @brief resolveConstraints
+     * adjust the DoFs of all entities such that the constraints are satisfied.
+     * The constraint system is decomposed into independent clusters (minimumND)
+     * or into blocks, which can be solved one after another (rootND).
+     */
     void resolveConstraints(
         std::function<void(void)> perIterationCallback = std::function<void(void)>(),
         ProgressDisplayer& progress = consoleProgressDisplayer );
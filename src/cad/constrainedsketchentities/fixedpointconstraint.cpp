@@ -74,6 +74,21 @@ double FixedPointConstraint::getConstraintError(unsigned int iConstraint) const
     return std::nan("NAN");
 }
 
+bool FixedPointConstraint::getConstraintGradient(
+    unsigned int iConstraint,
+    ConstraintGradient& gradient ) const
+{
+    insight::assertion(
+        iConstraint<2,
+        "invalid constraint id: %d", iConstraint );
+
+    if (typeid(*p_)!=typeid(SketchPoint))
+        return false; // DoFs are not the coordinates
+
+    gradient[{p_.get(), int(iConstraint)}]+=1.;
+    return true;
+}
+
 void FixedPointConstraint::scaleSketch(double scaleFactor)
 {
     auto& x = parametersRef().get<insight::DoubleParameter>("x");
@@ -67,6 +67,25 @@ double HorizontalConstraint::getConstraintError(
 
 
 
+bool HorizontalConstraint::getConstraintGradient(
+    unsigned int iConstraint,
+    ConstraintGradient& gradient ) const
+{
+    auto p0 = std::dynamic_pointer_cast<SketchPoint>(line_->start());
+    auto p1 = std::dynamic_pointer_cast<SketchPoint>(line_->end());
+    if ( !p0 || !p1
+        || typeid(*p0)!=typeid(SketchPoint)
+        || typeid(*p1)!=typeid(SketchPoint) )
+        return false; // DoFs are not the coordinates
+
+    gradient[{p1.get(), 1}]+=1.;
+    gradient[{p0.get(), 1}]-=1.;
+    return true;
+}
+
+
+
+
 void HorizontalConstraint::scaleSketch(double scaleFactor)
 {}
 
@@ -29,6 +29,9 @@ public:
 
     int nConstraints() const override;
     double getConstraintError(unsigned int iConstraint) const override;
+    bool getConstraintGradient(
+        unsigned int iConstraint,
+        ConstraintGradient& gradient ) const override;
     void scaleSketch(double scaleFactor) override;
 
     void generateScriptCommand(
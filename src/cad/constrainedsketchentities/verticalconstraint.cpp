@@ -67,6 +67,25 @@ double VerticalConstraint::getConstraintError(unsigned int iConstraint) const
     return d2(0);
 }
 
+bool VerticalConstraint::getConstraintGradient(
+    unsigned int iConstraint,
+    ConstraintGradient& gradient ) const
+{
+    auto p0 = std::dynamic_pointer_cast<SketchPoint>(line_->start());
+    auto p1 = std::dynamic_pointer_cast<SketchPoint>(line_->end());
+    if ( !p0 || !p1
+        || typeid(*p0)!=typeid(SketchPoint)
+        || typeid(*p1)!=typeid(SketchPoint) )
+        return false; // DoFs are not the coordinates
+
+    gradient[{p1.get(), 0}]+=1.;
+    gradient[{p0.get(), 0}]-=1.;
+    return true;
+}
+
+
+
+
 void VerticalConstraint::scaleSketch(double scaleFactor)
 {}
 
@@ -135,6 +135,16 @@ double ConstrainedSketchEntity::getConstraintError(unsigned int iConstraint) con
 
 
 
+bool ConstrainedSketchEntity::getConstraintGradient(
+    unsigned int iConstraint,
+    ConstraintGradient& gradient ) const
+{
+    return false;
+}
+
+
+
+
 size_t ConstrainedSketchEntity::hash() const
 {
     size_t h=0;
@@ -257,6 +267,15 @@ bool ConstrainedSketchEntity::dependsOn(const std::weak_ptr<ConstrainedSketchEnt
 
 
 
+std::set<std::comparable_weak_ptr<ConstrainedSketchEntity> >
+ConstrainedSketchEntity::solverDependencies() const
+{
+    return dependencies();
+}
+
+
+
+
 void ConstrainedSketchEntity::operator=(const ConstrainedSketchEntity &other)
 {
     defaultParameters_->assignFrom(*other.defaultParameters_);
@@ -86,6 +86,25 @@ public:
     virtual int nConstraints() const;
     virtual double getConstraintError(unsigned int iConstraint) const;
 
+    /**
+     * derivatives of a constraint error w.r.t. the DoFs of other entities.
+     * Key is the entity and the local DoF index.
+     */
+    typedef
+        std::map<std::pair<ConstrainedSketchEntity*, int>, double>
+            ConstraintGradient;
+
+    /**
+     * @brief getConstraintGradient
+     * add the analytic derivatives of the given constraint error to gradient.
+     * @return
+     * false, if no analytic derivatives are available.
+     * The solver uses finite differences then.
+     */
+    virtual bool getConstraintGradient(
+        unsigned int iConstraint,
+        ConstraintGradient& gradient ) const;
+
     virtual void scaleSketch(double scaleFactor) =0;
 
     virtual size_t hash() const;
@@ -120,6 +139,16 @@ public:
 
     bool dependsOn(const std::weak_ptr<ConstrainedSketchEntity>& entity) const;
 
+    /**
+     * @brief solverDependencies
+     * @return
+     * the entities, on which the geometry of this entity depends.
+     * Used by the constraint solver to determine, which constraints are affected by which DoFs.
+     * Defaults to dependencies(), has to be overridden, if there are dependencies
+     * which are not part of the script representation.
+     */
+    virtual std::set<std::comparable_weak_ptr<ConstrainedSketchEntity> > solverDependencies() const;
+
     virtual void replaceDependency(
         const std::weak_ptr<ConstrainedSketchEntity>& entity,
         const std::shared_ptr<ConstrainedSketchEntity>& newEntity) =0;
@@ -47,4 +47,67 @@ void OFPrimitivePatchToVTK(const pointField &pts, const faceList &faces, vtkPoly
 
 
 
+
+namespace
+{
+
+// FNV-1a
+struct Hash64
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    template<class T>
+    void add(const T& v)
+    {
+        auto* b = reinterpret_cast<const unsigned char*>(&v);
+        for (size_t i=0; i<sizeof(T); ++i)
+        {
+            h ^= b[i];
+            h *= 1099511628211ULL;
+        }
+    }
+};
+
+}
+
+
+std::vector<uint64_t> geometrySignature(vtkDataSet* ds)
+{
+    Hash64 hp, hc;
+
+    for (vtkIdType j=0; j<ds->GetNumberOfPoints(); ++j)
+    {
+        double p[3];
+        ds->GetPoint(j, p);
+        hp.add(p);
+    }
+
+    auto ids=vtkSmartPointer<vtkIdList>::New();
+    for (vtkIdType j=0; j<ds->GetNumberOfCells(); ++j)
+    {
+        hc.add(ds->GetCellType(j));
+        ds->GetCellPoints(j, ids);
+        hc.add(ids->GetNumberOfIds());
+        for (vtkIdType k=0; k<ids->GetNumberOfIds(); ++k)
+        {
+            hc.add(ids->GetId(k));
+        }
+    }
+
+    return {
+        uint64_t(ds->GetNumberOfPoints()),
+        uint64_t(ds->GetNumberOfCells()),
+        hp.h, hc.h
+    };
+}
+
+
+double probeTolerance2(vtkDataSet* ds)
+{
+    double l = ds->GetLength();
+    return l>0. ? l*l/1000. : 0.001;
+}
+
+
+
 } // namespace Foam
@@ -3,8 +3,11 @@
 
 #include "fvCFD.H"
 
+#include <cstdint>
 #include <limits>
+#include <vector>
 #include "vtkSmartPointer.h"
+#include "vtkDataSet.h"
 #include "vtkPolyData.h"
 #include "vtkDoubleArray.h"
 #include "vtkPointData.h"
@@ -166,6 +169,19 @@ void OFPrimitivePatchToVTK(
         const faceList& faces,
         vtkPolyData* ds );
 
+/**
+ * signature of the geometry of a data set: number of points and cells,
+ * hash of the point coordinates and hash of the cell connectivity.
+ * Data sets with the same signature share interpolation weights.
+ */
+std::vector<uint64_t> geometrySignature(vtkDataSet* ds);
+
+/**
+ * squared tolerance for locating points in the cells of ds.
+ * Same default as in vtkProbeFilter: L^2/1000 with the bounding box diagonal L.
+ */
+double probeTolerance2(vtkDataSet* ds);
+
 } // namespace Foam
 
 #endif // FOAM_VTKCONVERSION_H
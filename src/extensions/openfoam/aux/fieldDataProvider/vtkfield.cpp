@@ -4,15 +4,20 @@
 #include "vtkPointData.h"
 #include "vtkPolyDataReader.h"
 #include "vtkGenericDataObjectReader.h"
-#include "vtkProbeFilter.h"
 #include "vtkXMLMultiBlockDataReader.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkIdTypeArray.h"
 #include "vtkDataObject.h"
+#include "vtkDataSet.h"
 #include "vtkUnstructuredGrid.h"
+#include "vtkCellData.h"
+#include "vtkCellLocator.h"
+#include "vtkGenericCell.h"
 
 #include "vtkconversion.h"
 
+#include <algorithm>
+
 namespace Foam {
 
 
@@ -104,7 +109,7 @@ vtkField<T>::vtkField(const vtkField<T>& o)
 
 
 template<class T>
-tmp<Field<T> > vtkField<T>::atInstant(int i, const pointField& target) const
+vtkDataObject* vtkField<T>::sourceData(int i) const
 {
     auto ii=data_.find(i);
     if (ii==data_.end())
@@ -112,7 +117,7 @@ tmp<Field<T> > vtkField<T>::atInstant(int i, const pointField& target) const
         auto fn=vtkFiles_[i];
         if (!exists(fn))
         {
-            FatalErrorIn("vtkField<T>::atInstant")
+            FatalErrorIn("vtkField<T>::sourceData")
             << "file "<<vtkFiles_[i]<<" does not exist!"
             <<abort(FatalError);
         }
@@ -132,42 +137,169 @@ tmp<Field<T> > vtkField<T>::atInstant(int i, const pointField& target) const
             data_[i] = r->GetOutput();
         }
         ii=data_.find(i);
+
+        // signature of the source geometry:
+        // instants which share the mesh also share the interpolation weights
+        std::vector<uint64_t> sig;
+        if (auto ds = vtkDataSet::SafeDownCast(ii->second))
+        {
+            sig = geometrySignature(ds);
+        }
+        geometrySignature_[i]=sig;
+    }
+    return ii->second;
+}
+
+
+
+
+template<class T>
+const typename vtkField<T>::InterpolationWeights&
+vtkField<T>::interpolationWeights(int i, const pointField& target) const
+{
+    if (target.size()!=weightsTarget_.size() || target!=weightsTarget_)
+    {
+        // patch points have moved or a different patch is evaluated
+        weights_.clear();
+        weightsTarget_=target;
+    }
+
+    auto iw=weights_.find(i);
+    if (iw!=weights_.end())
+    {
+        return *iw->second;
     }
 
+    auto *ds = vtkDataSet::SafeDownCast(sourceData(i));
+    if (!ds)
+    {
+        FatalErrorIn("vtkField<T>::interpolationWeights")
+        << "file "<<vtkFiles_[i]<<" does not contain a data set!"
+        <<abort(FatalError);
+    }
 
-    auto targ = vtkSmartPointer<vtkPolyData>::New();
-    setPoints<vtkPolyData>(target, targ);
+    // reuse weights of another instant with the same geometry
+    const auto& sig = geometrySignature_[i];
+    for (const auto& w: weights_)
+    {
+        if (geometrySignature_[w.first]==sig)
+        {
+            weights_[i]=w.second;
+            return *w.second;
+        }
+    }
+
+    auto w = std::make_shared<InterpolationWeights>();
+    w->cellIds.resize(target.size(), -1);
+    w->offsets.resize(target.size()+1, 0);
+    w->nValid=0;
 
-    auto ip=vtkSmartPointer<vtkProbeFilter>::New();
-    ip->SetInputData(targ);
-    ip->SetSourceData(ii->second);
+    auto loc = vtkSmartPointer<vtkCellLocator>::New();
+    loc->SetDataSet(ds);
+    loc->BuildLocator();
 
-    ip->Update();
+    auto cell = vtkSmartPointer<vtkGenericCell>::New();
+    std::vector<double> cw(std::max(1, ds->GetMaxCellSize()));
+    double tol2 = probeTolerance2(ds);
+    double pc[3];
+
+    forAll(target, j)
+    {
+        double x[3] = { target[j].x(), target[j].y(), target[j].z() };
 
-    auto vpm = ip->GetValidPoints();
-    int validPts=vpm->GetSize();
+        vtkIdType ci = loc->FindCell(x, tol2, cell, pc, cw.data());
+        if (ci>=0)
+        {
+            w->cellIds[j]=ci;
+            for (vtkIdType k=0; k<cell->GetNumberOfPoints(); ++k)
+            {
+                w->pointIds.push_back(cell->GetPointId(k));
+                w->weights.push_back(cw[k]);
+            }
+            w->nValid++;
+        }
+        w->offsets[j+1]=w->pointIds.size();
+    }
 
-    if (validPts==0)
+    if (w->nValid==0)
     {
-        WarningIn("vtkField<T>::atInstant")
+        WarningIn("vtkField<T>::interpolationWeights")
         << "no point could be interpolated!" << endl;
     }
     else
     {
-        Info<<"Successfully interpolated "<<validPts<<" of "<<int(targ->GetNumberOfPoints())<<" points."<<endl;
+        Info<<"Successfully located "<<w->nValid<<" of "<<target.size()<<" points."<<endl;
     }
 
-    auto out = ip->GetOutput();
-    if (!out->GetPointData()->HasArray(fieldNames_[i].c_str()))
+    weights_[i]=w;
+    return *w;
+}
+
+
+
+
+template<class T>
+tmp<Field<T> > vtkField<T>::atInstant(int i, const pointField& target) const
+{
+    const auto& w = interpolationWeights(i, target);
+    auto *ds = vtkDataSet::SafeDownCast(sourceData(i));
+
+    const char *fn = fieldNames_[i].c_str();
+    vtkDataArray *arr = ds->GetPointData()->GetArray(fn);
+    bool isPointData = (arr!=nullptr);
+    if (!arr)
+    {
+        arr = ds->GetCellData()->GetArray(fn);
+    }
+    if (!arr)
     {
         FatalErrorIn("vtkField<T>::atInstant")
         << "file "<<vtkFiles_[i]<<" does not contain field "
         << fieldNames_[i] <<"!"
         <<abort(FatalError);
     }
-    return VTKArrayToField<T>(
-        out->GetPointData()->GetArray(fieldNames_[i].c_str()),
-        componentMap_ );
+    if (arr->GetNumberOfComponents()!=pTraits<T>::nComponents)
+    {
+        FatalErrorIn("vtkField<T>::atInstant")
+        << "field "<<fieldNames_[i]<<" in file "<<vtkFiles_[i]
+        << " has an incompatible number of components"
+        <<abort(FatalError);
+    }
+
+    tmp<Field<T> > resPtr(new Field<T>(target.size(), pTraits<T>::zero));
+    Field<T>& res = UNIOF_TMP_NONCONST(resPtr);
+
+    double v[pTraits<T>::nComponents];
+    forAll(target, j)
+    {
+        if (w.cellIds[j]<0) continue;
+
+        if (isPointData)
+        {
+            for (int k=0; k<pTraits<T>::nComponents; ++k) v[k]=0.;
+            for (auto l=w.offsets[j]; l<w.offsets[j+1]; ++l)
+            {
+                for (int k=0; k<pTraits<T>::nComponents; ++k)
+                {
+                    v[k] += w.weights[l]*arr->GetComponent(w.pointIds[l], k);
+                }
+            }
+        }
+        else
+        {
+            for (int k=0; k<pTraits<T>::nComponents; ++k)
+            {
+                v[k] = arr->GetComponent(w.cellIds[j], k);
+            }
+        }
+
+        for (int k=0; k<pTraits<T>::nComponents; ++k)
+        {
+            setComponent(res[j], componentMap_[k]) = v[k];
+        }
+    }
+
+    return resPtr;
 }
 
 
@@ -4,6 +4,10 @@
 #include "fielddataprovider.h"
 
 #include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+#include <cstdint>
+#include <memory>
 
 
 
@@ -30,6 +34,33 @@ private:
     mutable std::map<int, vtkSmartPointer<vtkDataObject> > data_;
     mutable std::map<long int, Field<T> > cache_;
 
+    /**
+     * cell ids and interpolation weights of all target points
+     * in one source geometry. Evaluation of a field then reduces
+     * to a sparse gather.
+     */
+    struct InterpolationWeights
+    {
+        //- containing cell of each target point, -1 if not found
+        std::vector<vtkIdType> cellIds;
+        //- start of the weights of target point j in pointIds/weights (size n+1)
+        std::vector<std::size_t> offsets;
+        std::vector<vtkIdType> pointIds;
+        std::vector<double> weights;
+        label nValid;
+    };
+    typedef std::shared_ptr<InterpolationWeights> InterpolationWeightsPtr;
+
+    //- target points for which the weights below were computed
+    mutable pointField weightsTarget_;
+    //- geometry signature of each loaded instant
+    mutable std::map<int, std::vector<uint64_t> > geometrySignature_;
+    //- weights per instant; instants with identical geometry share one set
+    mutable std::map<int, InterpolationWeightsPtr> weights_;
+
+    vtkDataObject* sourceData(int i) const;
+    const InterpolationWeights& interpolationWeights(int i, const pointField& target) const;
+
     virtual void appendInstant(Istream& is);
     virtual void writeInstant(int i, Ostream& os) const;
 
@@ -16,11 +16,116 @@
 
 #include "uniof_functionobject.h"
 
+#include "volFields.H"
+#include "surfaceFields.H"
+#include "OStringStream.H"
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
 namespace Foam
 {
 
 
 
+
+/**
+ * in-memory snapshot of a restart output.
+ * It is written by a background thread, which must not use
+ * the OpenFOAM I/O. Hence only std and boost functions are used.
+ */
+struct RestartCheckpoint
+{
+    typedef std::vector<std::pair<std::string, std::string> > FileList;
+
+    //- file contents, relative to the time directory
+    FileList files;
+    //- final time directory in the case
+    boost::filesystem::path target;
+    //- if not empty: write to this (node-local) directory first
+    boost::filesystem::path localDirectory;
+    //- previous checkpoints to remove after writing
+    std::vector<boost::filesystem::path> purge;
+
+    //- write and return the elapsed wall clock time
+    double write() const;
+};
+
+
+
+
+double RestartCheckpoint::write() const
+{
+    namespace fs = boost::filesystem;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // write into a staging directory first, so that an incomplete output
+    // is never picked up as a restart time
+    std::string stagingName = "."+target.filename().string()+".restartWrite";
+    fs::path staging = target.parent_path() / stagingName;
+    fs::path writeDir = localDirectory.empty() ? staging : localDirectory/stagingName;
+
+    fs::remove_all(writeDir);
+    for (const auto& f: files)
+    {
+        fs::path fp = writeDir / f.first;
+        fs::create_directories(fp.parent_path());
+        std::ofstream os(fp.string(), std::ios::binary);
+        os.write(f.second.data(), f.second.size());
+        if (!os.good())
+        {
+            throw std::runtime_error("could not write "+fp.string());
+        }
+    }
+
+    if (writeDir!=staging)
+    {
+        // copy out from node-local storage
+        fs::remove_all(staging);
+        for (const auto& f: files)
+        {
+            fs::path fp = staging / f.first;
+            fs::create_directories(fp.parent_path());
+            fs::copy_file(writeDir / f.first, fp);
+        }
+        fs::remove_all(writeDir);
+    }
+
+    if (!fs::exists(target))
+    {
+        fs::rename(staging, target);
+    }
+    else
+    {
+        // time directory has been created meanwhile, e.g. by a regular write
+        for (const auto& f: files)
+        {
+            fs::path fp = target / f.first;
+            fs::create_directories(fp.parent_path());
+            fs::rename(staging / f.first, fp);
+        }
+        fs::remove_all(staging);
+    }
+
+    for (const auto& p: purge)
+    {
+        fs::remove_all(p);
+    }
+
+    return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start ).count();
+}
+
+
+
+
 class restartWrite
 : public UniFunctionObject
 {
@@ -38,11 +143,45 @@ private:
 
         label nKeep_;
 
+        //- write from a background thread.
+        //  Only vol and surface fields and uniform/time are contained,
+        //  point fields, lagrangian data and the function object state
+        //  in uniform/ are missing.
+        //  Meshes are not written: for moving or changing meshes,
+        //  the synchronous output is used.
+        bool asynchronous_;
+        //- optional node-local directory for asynchronous writing
+        fileName localDirectory_;
+
+        //- checkpoint in flight, if valid
+        std::future<double> checkpoint_;
+        word checkpointTimeName_;
+        bool checkpointPostponed_;
+        bool asyncFallbackReported_;
+
     // Private Member Functions
 
         //- Remove write flag file.
         void removeFile() const;
 
+        template<class GeoField>
+        void snapshotFields
+        (
+            const fvMesh& mesh,
+            RestartCheckpoint::FileList& files
+        ) const;
+
+        //- true, if any mesh is moving or changing
+        //  and thus cannot be restarted from an asynchronous output
+        bool meshChanging() const;
+
+        //- snapshot all fields and start writing in background
+        void startCheckpoint();
+
+        //- check (collectively) for a checkpoint in flight,
+        //  report its cost after completion
+        bool checkpointInProgress();
+
         //- Disallow default bitwise copy construct
         restartWrite(const restartWrite&);
 
@@ -66,6 +205,8 @@ public:
             const dictionary&
         );
 
+    ~restartWrite();
+
 
     // Member Functions
 
@@ -103,26 +244,220 @@ restartWrite::restartWrite
   UniFunctionObject(name, dict),
     time_(time),
     skippedSteps_(0),
-    lastWriteTime_(time_.elapsedClockTime())
+    lastWriteTime_(time_.elapsedClockTime()),
+    asynchronous_(false),
+    checkpointPostponed_(false),
+    asyncFallbackReported_(false)
 {}
 
 
 
 
+restartWrite::~restartWrite()
+{
+    if (checkpoint_.valid())
+    {
+        Info<<"Waiting for restart checkpoint "<<checkpointTimeName_<<" to complete."<<endl;
+        try
+        {
+            checkpoint_.get();
+        }
+        catch (const std::exception& e)
+        {
+            WarningIn("restartWrite::~restartWrite()")
+                << "Writing restart checkpoint "<<checkpointTimeName_
+                << " failed: " << e.what() << endl;
+        }
+    }
+}
+
+
+
+
 // * * * * * * * * * * * * * * * Member Functions  * * * * * * * * * * * * * //
 
 bool restartWrite::read(const dictionary& dict)
 {
     clockTimeInterval_ = dict.lookupOrDefault<scalar>("clockTimeInterval", 600);
     nKeep_ = dict.lookupOrDefault<label>("nKeep", 2);
+    asynchronous_ = dict.lookupOrDefault<bool>("asynchronous", false);
+    localDirectory_ = dict.lookupOrDefault<fileName>("localDirectory", fileName());
+    localDirectory_.expand();
     Info
           <<"Writing restart output every "<<clockTimeInterval_
           <<" seconds wall clock time, keeping last "
           <<nKeep_<<" outputs."<<endl;
+    if (asynchronous_)
+    {
+        Info<<"Restart output is written asynchronously";
+        if (!localDirectory_.empty())
+        {
+            Info<<" via "<<localDirectory_;
+        }
+        Info<<"."<<nl
+            <<"It contains only volume and surface fields, no point fields,"
+            <<" lagrangian data or function object state."<<endl;
+    }
     return true;
 }
 
 
+
+
+template<class GeoField>
+void restartWrite::snapshotFields
+(
+    const fvMesh& mesh,
+    RestartCheckpoint::FileList& files
+) const
+{
+    HashTable<const GeoField*> fields = mesh.lookupClass<GeoField>();
+    wordList names = fields.toc();
+    forAll(names, i)
+    {
+        const GeoField& fld = *fields[names[i]];
+        if (fld.writeOpt()!=IOobject::AUTO_WRITE) continue;
+
+        OStringStream os(time_.writeFormat());
+        fld.writeHeader(os);
+        fld.writeData(os);
+        IOobject::writeEndDivider(os);
+
+        files.push_back({ fileName(mesh.dbDir()/fld.name()), os.str() });
+    }
+}
+
+
+
+
+bool restartWrite::meshChanging() const
+{
+    bool changing = false;
+    HashTable<const fvMesh*> meshes = time_.lookupClass<fvMesh>();
+    wordList meshNames = meshes.toc();
+    forAll(meshNames, mi)
+    {
+        const fvMesh& mesh = *meshes[meshNames[mi]];
+        changing = changing || mesh.moving() || mesh.changing();
+    }
+    reduce(changing, orOp<bool>());
+    return changing;
+}
+
+
+
+
+void restartWrite::startCheckpoint()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    RestartCheckpoint cp;
+
+    HashTable<const fvMesh*> meshes = time_.lookupClass<fvMesh>();
+    wordList meshNames = meshes.toc();
+    forAll(meshNames, mi)
+    {
+        const fvMesh& mesh = *meshes[meshNames[mi]];
+        snapshotFields<volScalarField>(mesh, cp.files);
+        snapshotFields<volVectorField>(mesh, cp.files);
+        snapshotFields<volSymmTensorField>(mesh, cp.files);
+        snapshotFields<volTensorField>(mesh, cp.files);
+        snapshotFields<surfaceScalarField>(mesh, cp.files);
+    }
+
+    {
+        OStringStream os;
+        IOobject::writeBanner(os)
+            << "FoamFile\n{\n"
+            << "    version     2.0;\n"
+            << "    format      ascii;\n"
+            << "    class       dictionary;\n"
+            << "    location    \"" << time_.timeName() << "/uniform\";\n"
+            << "    object      time;\n"
+            << "}\n";
+        IOobject::writeDivider(os);
+        os.writeKeyword("value") << time_.value() << token::END_STATEMENT << nl;
+        os.writeKeyword("name") << string(time_.timeName()) << token::END_STATEMENT << nl;
+        os.writeKeyword("index") << time_.timeIndex() << token::END_STATEMENT << nl;
+        os.writeKeyword("deltaT") << time_.deltaTValue() << token::END_STATEMENT << nl;
+        os.writeKeyword("deltaT0") << time_.deltaT0Value() << token::END_STATEMENT << nl;
+        IOobject::writeEndDivider(os);
+        cp.files.push_back({ "uniform/time", os.str() });
+    }
+
+    cp.target = std::string(time_.objectRegistry::path(time_.timeName()));
+
+    if (!localDirectory_.empty())
+    {
+        fileName ld = localDirectory_/name();
+        if (Pstream::parRun())
+        {
+            ld = ld/("processor"+Foam::name(Pstream::myProcNo()));
+        }
+        cp.localDirectory = std::string(ld);
+    }
+
+    previousWriteTimes_.push(time_.timeName());
+    while (previousWriteTimes_.size() > nKeep_)
+    {
+        cp.purge.push_back(
+            std::string(time_.objectRegistry::path(previousWriteTimes_.pop())) );
+    }
+
+    checkpointTimeName_ = time_.timeName();
+    checkpoint_ = std::async(
+                std::launch::async,
+                [](RestartCheckpoint cp) { return cp.write(); },
+                std::move(cp) );
+
+    scalar dt = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start ).count();
+    reduce(dt, maxOp<scalar>());
+
+    Info<< "RESTART CHECKPOINT AT (timeIndex="
+        << time_.timeIndex()<<", timeName = "
+        << time_.timeName()
+        << "), snapshot took "<<dt<<" s"
+        << endl;
+}
+
+
+
+
+bool restartWrite::checkpointInProgress()
+{
+    if (!checkpoint_.valid())
+    {
+        return false;
+    }
+
+    bool busy =
+        checkpoint_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    reduce(busy, orOp<bool>());
+
+    if (!busy)
+    {
+        scalar dt = 0;
+        try
+        {
+            dt = checkpoint_.get();
+        }
+        catch (const std::exception& e)
+        {
+            WarningIn("restartWrite::checkpointInProgress()")
+                << "Writing restart checkpoint "<<checkpointTimeName_
+                << " failed: " << e.what() << endl;
+        }
+        reduce(dt, maxOp<scalar>());
+
+        Info<< "Restart checkpoint "<<checkpointTimeName_
+            << " written in background in "<<dt<<" s"<<endl;
+    }
+
+    return busy;
+}
+
+
 bool restartWrite::perform()
 {
     const int nskip =
@@ -141,7 +476,42 @@ bool restartWrite::perform()
     }
     reduce(now, sumOp<scalar>());
 
-    if ( now - lastWriteTime_ > clockTimeInterval_ )
+    bool busy = asynchronous_ && checkpointInProgress();
+
+    // the asynchronous output does not contain the mesh.
+    // A synchronous write, which was already started, is completed first.
+    bool asynchronous = asynchronous_ && (skippedSteps_==0);
+    if (asynchronous && (now - lastWriteTime_ > clockTimeInterval_) && meshChanging())
+    {
+        if (!asyncFallbackReported_)
+        {
+            WarningIn("restartWrite::perform()")
+                << "The mesh is moving or changing."
+                << " Restart output is written synchronously." << endl;
+            asyncFallbackReported_ = true;
+        }
+        asynchronous = false;
+    }
+
+    if ( (now - lastWriteTime_ > clockTimeInterval_) && asynchronous )
+    {
+        // at most one checkpoint in flight
+        if (busy)
+        {
+            if (!checkpointPostponed_)
+            {
+                Info<<"Previous restart checkpoint still in progress, postponing."<<endl;
+                checkpointPostponed_=true;
+            }
+        }
+        else
+        {
+            startCheckpoint();
+            checkpointPostponed_ = false;
+            lastWriteTime_ = now;
+        }
+    }
+    else if ( now - lastWriteTime_ > clockTimeInterval_ )
     {
 
         if (skippedSteps_==0)
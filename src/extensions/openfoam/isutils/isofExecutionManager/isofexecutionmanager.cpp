@@ -104,6 +104,10 @@ int main(int argc, char *argv[])
       ("sync-local-repeat", po::value<int>(), "sync from remote location to current case, restart transfer periodically after given number of seconds")
       ("reconst-new", "reconstruct time directories which are yet unreconstructed")
       ("skip-timesteps,t", "exclude time steps while syncing to local directory\nBeware: during a subsequent sync-to-remote, the skipped time steps will be deleted!")
+      ("latest-time", "transfer only the latest time step while syncing to local directory")
+      ("time", po::value<std::vector<double> >(), "transfer only the given time step while syncing to local directory (can be given multiple times)")
+      ("time-range", po::value<std::vector<double> >()->multitoken(), "transfer only time steps within the given interval (two values: from to) while syncing to local directory")
+      ("field", po::value<StringList>(), "transfer only the given field from the selected time steps while syncing to local directory (can be given multiple times)")
       ("skip-dir,s", po::value<StringList>(&skip_dirs), "exclude local directory during sync to remote")
       ("include-processor-dirs,p", "if this flag is set, processor directories will be tranferred as well")
       ("command,q", po::value<StringList>(&cmds), "add this command to remote execution queue (will be executed after the previous command has finished successfully)")
@@ -116,6 +120,7 @@ int main(int argc, char *argv[])
       ("locate-remote-configs,L", "locate and list existing remote configurations")
       ("filter-remote-server,S", po::value<StringList>(&remoteServerFilter), "filter remote configuration list by server")
       ("bwlimit", po::value<int>()->default_value(-1), "transfer bandwidth limitin kB/s; -1 means no limit")
+      ("streams", po::value<int>()->default_value(4), "number of concurrent transfer streams, if processor directories are synced")
       ("launch-analysis", po::value<std::string>(&remoteAnalysisFileName), "launch \"analyze\" on the specified file.")
 #ifndef WIN32
       ("mount-remote,M", "mount the remote directory locally using sshfs (needs to be installed)")
@@ -250,6 +255,37 @@ int main(int argc, char *argv[])
       re->server()
               ->setTransferBandWidthLimit(
                   vm["bwlimit"].as<int>() );
+      re->server()
+              ->setTransferParallelism(
+                  vm["streams"].as<int>() );
+
+      insight::RemoteLocation::TimeDirectorySelection timeSelection(
+                  vm.count("skip-timesteps") ?
+                    insight::RemoteLocation::TimeDirectorySelection::NoTimes :
+                    insight::RemoteLocation::TimeDirectorySelection::AllTimes );
+      if (vm.count("latest-time"))
+      {
+        timeSelection.mode=insight::RemoteLocation::TimeDirectorySelection::LatestTime;
+      }
+      else if (vm.count("time"))
+      {
+        timeSelection.mode=insight::RemoteLocation::TimeDirectorySelection::ListedTimes;
+        timeSelection.times=vm["time"].as<std::vector<double> >();
+      }
+      else if (vm.count("time-range"))
+      {
+        auto tr=vm["time-range"].as<std::vector<double> >();
+        insight::assertion(
+              tr.size()==2,
+              "expected two values (from and to) for time range, got %d", int(tr.size()) );
+        timeSelection.mode=insight::RemoteLocation::TimeDirectorySelection::TimeRange;
+        timeSelection.fromTime=tr[0];
+        timeSelection.toTime=tr[1];
+      }
+      if (vm.count("field"))
+      {
+        timeSelection.fields=vm["field"].as<StringList>();
+      }
 
       if(vm.count("list-remote"))
       {
@@ -330,7 +366,7 @@ int main(int argc, char *argv[])
       {
         re->syncToLocal(
                     include_processor,
-                    (vm.count("skip-timesteps")>0),
+                    timeSelection,
                     skip_dirs,
                     printProgress );
         std::cout<<endl;
@@ -371,7 +407,7 @@ int main(int argc, char *argv[])
         {
             re->syncToLocal(
                 include_processor,
-                (vm.count("skip-timesteps")>0),
+                timeSelection,
                 skip_dirs,
                 printProgress );
             std::cout<<endl;
@@ -32,7 +32,9 @@
 
 #include "boost/algorithm/string/trim.hpp"
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 
 #include "base/qt5_helper.h"
 #include "qtextensions.h"
@@ -51,6 +53,11 @@ IsofPlotTabularWindow::IsofPlotTabularWindow(const std::vector<boost::filesystem
   transform(files_.begin(), files_.end(), back_inserter(filenames),
             [](const boost::filesystem::path& fp) { return fp.string(); } );
 
+  for (const auto& f: files_)
+  {
+    tails_.emplace_back(new TabularFileTail(f));
+  }
+
   setWindowTitle( "PlotTabularData: CWD "+QString::fromStdString( boost::filesystem::current_path().string() )
                   +", displaying "+ QString::fromStdString( algorithm::join(filenames, ", ") ) );
 
@@ -60,13 +67,27 @@ IsofPlotTabularWindow::IsofPlotTabularWindow(const std::vector<boost::filesystem
   connect(ui->saveFinalBtn, &QPushButton::clicked, this,
           [this]() { onSaveFinalValues(); } );
 
+  followTimer_ = new QTimer(this);
+  followTimer_->setInterval(1000);
+  connect(followTimer_, &QTimer::timeout, this,
+          [this]()
+          {
+            if (mergeNewRows(false))
+              updatePlots();
+          } );
+
+  connect(ui->followCb, &QCheckBox::toggled,
+          this, &IsofPlotTabularWindow::onFollow);
+
+  connect(ui->graphs, &QTabWidget::currentChanged, this, &IsofPlotTabularWindow::onTabChanged);
+
   onUpdate();
 }
 
 void IsofPlotTabularWindow::resetAllAvgFractions(double f)
 {
     completedAverage_.clear();
-    for (size_t j=1; j<data_.n_cols; j++)
+    for (size_t j=1; j<nCols(); j++)
     {
         auto *p = dynamic_cast<PlotWidget*>(ui->graphs->widget(j-1));
         p->changeAvgFraction(f);
@@ -74,87 +95,132 @@ void IsofPlotTabularWindow::resetAllAvgFractions(double f)
 }
 
 
-void IsofPlotTabularWindow::readFiles()
+bool IsofPlotTabularWindow::mergeNewRows(bool rebuild)
 {
-  data_ = arma::mat();
-
-  for (const auto& file: files_)
+  std::vector<TabularFileTail::Row> newRows;
+  for (auto& t: tails_)
   {
-    std::istream* f;
-    std::shared_ptr<std::ifstream> fs;
-
-    if (file.string()=="-")
-    {
-      f=&std::cin;
-    }
-    else
+    auto nr = t->takeNewRows();
+    if (nr.size())
     {
-      fs.reset(new ifstream(file.c_str()));
-      f=fs.get();
+      if (newRows.empty())
+        newRows = std::move(nr);
+      else
+        std::move(nr.begin(), nr.end(), std::back_inserter(newRows));
     }
+  }
 
-    arma::mat fd = insight::readTextFile(*f);
+  if (rebuild)
+  {
+    data_.clear();
+  }
+  else if (newRows.empty())
+  {
+    return false;
+  }
 
-    if (data_.size()==0)
-    {
-      data_=fd;
-    }
-    else
-    {
-      if (fd.n_cols!=data_.n_cols)
-        throw insight::Exception(str(format("Incompatible data in file %s: number cols is %d but should be %d!")%file.string()%fd.n_cols%data_.n_cols));
+  // with several files, the rows are interleaved by time
+  size_t pos = mergeRows(data_, std::move(newRows), files_.size()>1);
 
-      data_.insert_rows(data_.n_rows, fd);
+  int n_cols=int(nCols())-1; // first col is time
+
+  // remove unnecessary tabs
+  for (int j=ui->graphs->count()-1; j>=std::max(0,n_cols); j--)
+  {
+    ui->graphs->removeTab(j);
+  }
+
+  // add new tabs, if required
+  for (int j=ui->graphs->count(); j<n_cols; j++)
+  {
+    PlotWidget* pw=new PlotWidget(this);
+    connect(pw, &PlotWidget::averageValueReady, pw,
+            [this,j](){ averageValueReady(j-1); } );
+    ui->graphs->addTab(pw,
+                       QString::fromStdString(str(format("Col %d")%j))
+                       );
+    connect(ui->startTime, &QLineEdit::textChanged,
+            [=](const QString& nv) { pw->onChangeXRange(nv, ui->endTime->text()); } );
+    connect(ui->endTime, &QLineEdit::textChanged,
+            [=](const QString& nv) { pw->onChangeXRange(ui->startTime->text(), nv); } );
+    pw->clearData();
+  }
+
+  // pass on only the rows from the first changed one
+  for (size_t j=1; j<nCols(); j++)
+  {
+    PlotWidget *p = dynamic_cast<PlotWidget*>(ui->graphs->widget(j-1));
+    if (rebuild)
+    {
+      p->clearData();
     }
+    p->truncateData(pos);
+    p->appendData(data_[0], data_[j], pos);
   }
 
-  if (files_.size()>1)
-    data_ = insight::sortedByCol(data_, 0);
+  return true;
 }
 
 
-void IsofPlotTabularWindow::onUpdate(bool)
+void IsofPlotTabularWindow::updatePlots()
 {
   completedAverage_.clear();
 
-  readFiles();
+  for (size_t j=1; j<nCols(); j++)
+  {
+    PlotWidget *p = dynamic_cast<PlotWidget*>(ui->graphs->widget(j-1));
+    p->onChangeXRange(ui->startTime->text(), ui->endTime->text());
+    p->onShow();
+  }
+}
+
 
-  if (data_.n_rows!=0)
+void IsofPlotTabularWindow::onUpdate(bool)
+{
+  bool rebuild = data_.empty();
+  for (auto& t: tails_)
   {
-    int n_cols=data_.n_cols-1; // first col is time
+    if (!t->isFollowing() && !t->readNew())
+      rebuild=true;
+  }
 
-    // remove unnecessary tabs
-    for (int j=ui->graphs->count()-1; j>=n_cols; j--)
+  if (rebuild && !data_.empty())
+  {
+    // some file was truncated: read everything again
+    for (auto& t: tails_)
     {
-      ui->graphs->removeTab(j);
+      t->restart();
+      t->readNew();
     }
+  }
 
-    // add new tabs, if required
-    for (int j=ui->graphs->count(); j<n_cols; j++)
-    {
-      PlotWidget* pw=new PlotWidget(this);
-      connect(pw, &PlotWidget::averageValueReady, pw,
-              [this,j](){ averageValueReady(j-1); } );
-      ui->graphs->addTab(pw,
-                         QString::fromStdString(str(format("Col %d")%j))
-                         );
-      connect(ui->startTime, &QLineEdit::textChanged,
-              [=](const QString& nv) { pw->onChangeXRange(nv, ui->endTime->text()); } );
-      connect(ui->endTime, &QLineEdit::textChanged,
-              [=](const QString& nv) { pw->onChangeXRange(ui->startTime->text(), nv); } );
+  mergeNewRows(rebuild);
+  updatePlots();
+}
 
-    }
 
-    for (size_t j=1; j<data_.n_cols; j++)
+void IsofPlotTabularWindow::onFollow(bool follow)
+{
+  ui->updateBtn->setEnabled(!follow);
+  if (follow)
+  {
+    onUpdate();
+    for (auto& t: tails_)
     {
-      PlotWidget *p = dynamic_cast<PlotWidget*>(ui->graphs->widget(j-1));
-      p->setData(data_.col(0), data_.col(j));
-      p->onChangeXRange(ui->startTime->text(), ui->endTime->text());
-      p->onShow();
+      t->startFollowing();
     }
+    followTimer_->start();
+  }
+  else
+  {
+    followTimer_->stop();
+    for (auto& t: tails_)
+    {
+      t->stopFollowing();
+    }
+    if (mergeNewRows(false))
+      updatePlots();
   }
-
-  connect(ui->graphs, &QTabWidget::currentChanged, this, &IsofPlotTabularWindow::onTabChanged);
 }
 
 
@@ -180,14 +246,14 @@ void IsofPlotTabularWindow::onSaveFinalValues(QString fn)
     if (!fn.isEmpty())
     {
         std::ofstream f(fn.toStdString());
-        for (size_t j=1; j<data_.n_cols; j++)
+        for (size_t j=1; j<nCols(); j++)
         {
             if (j>1) f<<sep;
             f<<"final raw value of column "<<j<<sep<<"final mean value of column "<<j;
         }
         f<<std::endl;
 
-        for (size_t j=1; j<data_.n_cols; j++)
+        for (size_t j=1; j<nCols(); j++)
         {
             if (j>1) f<<sep;
             PlotWidget *p = dynamic_cast<PlotWidget*>(ui->graphs->widget(j-1));
@@ -216,6 +282,6 @@ void IsofPlotTabularWindow::averageValueReady(int i)
 {
     completedAverage_.insert(i);
 
-    if (data_.n_cols-1 == completedAverage_.size())
+    if (nCols()-1 == completedAverage_.size())
         Q_EMIT allAverageValuesReady();
 }
@@ -28,9 +28,12 @@
 #include "ui_isofplottabularwindow.h"
 
 
+#include <memory>
 #include <vector>
 
-#include <QtCharts/QLineSeries>
+#include <QTimer>
+
+#include "tabularfiletail.h"
 
 class IsofPlotTabularWindow : public QMainWindow
 {
@@ -39,11 +42,27 @@ class IsofPlotTabularWindow : public QMainWindow
     Ui_MainWindow *ui;
 
     std::vector<boost::filesystem::path> files_;
-    arma::mat data_;
+    std::vector<std::unique_ptr<TabularFileTail> > tails_;
+
+    /**
+     * merged data, sorted by first column, if there is more than one file.
+     * Stored column-wise.
+     */
+    std::vector<std::vector<double> > data_;
+
+    QTimer *followTimer_;
 
-    std::vector<QtCharts::QLineSeries*> curve_;
+    inline size_t nCols() const { return data_.size(); }
 
-    void readFiles();
+    /**
+     * @brief mergeNewRows
+     * merge the rows read since the last call into the data and
+     * pass the new data to the plots
+     * @return
+     * true, if data was added
+     */
+    bool mergeNewRows(bool rebuild);
+    void updatePlots();
 
     mutable std::set<int> completedAverage_;
 
@@ -54,6 +73,7 @@ public:
 
 public Q_SLOTS:
     void onUpdate(bool checked=false);
+    void onFollow(bool follow);
     void onSaveFinalValues(QString outFile = QString());
     void onTabChanged(int);
 
@@ -18,6 +18,7 @@
  *
  */
 
+
 #include "plotwidget.h"
 #include "base/exception.h"
 #include "ui_plotwidget.h"
@@ -26,16 +27,40 @@
 #include "base/boost_include.h"
 #include "boost/format.hpp"
 
-#include "base/cppextensions.h""
+#include "base/cppextensions.h"
 #include "base/qt5_helper.h"
 
 #include <QtCharts/QValueAxis>
 
+#include <cfloat>
+#include <cmath>
+
 using namespace std;
 using namespace boost;
 
+
+namespace {
+
+/**
+ * first index i in [lo, hi) with x(i)>=x, or hi.
+ * Requires ascending x.
+ */
+size_t lowerIndex(const MinMaxPyramidSeries& s, size_t lo, size_t hi, double x)
+{
+  while (lo<hi)
+  {
+    size_t mid=(lo+hi)/2;
+    if (s.x(mid)<x) lo=mid+1; else hi=mid;
+  }
+  return lo;
+}
+
+}
+
+
 PlotWidget::PlotWidget(QWidget *parent) :
   QWidget(parent),
+  i0_(0), i1_(0),
   ui(new Ui::PlotWidget)
 {
   ui->setupUi(this);
@@ -84,29 +109,57 @@ PlotWidget::~PlotWidget()
 {
   if (mc_)
   {
-    if (mc_->isRunning()) mc_->terminate();
+    mc_->wait();
     delete mc_;
   }
   delete ui;
 }
 
-void PlotWidget::setData(const arma::mat& x, const arma::mat& y)
+void PlotWidget::clearData()
 {
-  rawdata_=arma::join_horiz(x,y);
-  visible_part_=rawdata_;
-
+  raw_.clear();
+  cumInt_.clear();
+  mean_.reset();
+  i0_=i1_=0;
   raw_crv_->clear();
-  for (arma::uword i=0; i< x.n_rows; i++)
-    raw_crv_->append(x(i), y(i));
-
   mean_crv_->clear();
+}
 
+void PlotWidget::appendData(const std::vector<double>& x, const std::vector<double>& y, size_t from)
+{
+  for (size_t i=from; i<x.size(); ++i)
+  {
+    size_t n=raw_.size();
+    if (n==0)
+    {
+      cumInt_.push_back(0.);
+    }
+    else
+    {
+      cumInt_.push_back(
+            cumInt_.back()
+            + 0.5*(y[i]+raw_.y(n-1))*(x[i]-raw_.x(n-1)) );
+    }
+    raw_.append(x[i], y[i]);
+  }
 
-  ui->final_vals->setText(QString::fromStdString(
-    str(format("Final values: raw=%g / mean = (-)")%y(y.n_rows-1))
-  ));
+  if (raw_.size())
+  {
+    ui->final_vals->setText(QString::fromStdString(
+      str(format("Final values: raw=%g / mean = (-)")%raw_.y(raw_.size()-1))
+    ));
+  }
+}
+
+void PlotWidget::truncateData(size_t n)
+{
+  if (n>=raw_.size()) return;
 
-  onToggleY0(true);
+  raw_.truncate(n);
+  cumInt_.resize(n);
+  mean_.reset();
+  i0_=std::min(i0_, n);
+  i1_=std::min(i1_, n);
 }
 
 void PlotWidget::changeAvgFraction(double f)
@@ -116,23 +169,104 @@ void PlotWidget::changeAvgFraction(double f)
 
 void PlotWidget::onShow()
 {
-  if (mean_crv_->count()==0)
+  if (mean_.n_rows==0)
   {
     onMeanAvgFractionChange();
   }
 }
 
+void PlotWidget::computeMean()
+{
+  mean_.reset();
+
+  size_t n=i1_-i0_;
+  if (n==0) return;
+
+  double frac=ui->avg_fraction->value();
+
+  // same sampling as insight::movingAverage, but each window average
+  // is taken from the running integral in O(log n)
+  const size_t n_avg_max=1000;
+
+  double x0=raw_.x(i0_);
+  double dx_raw=raw_.x(i1_-1)-x0;
+  double window=frac*dx_raw;
+  double avgdx=dx_raw/double( std::min<size_t>(n, n_avg_max) );
+
+  size_t n_avg=n;
+  if (avgdx>0.)
+  {
+    n_avg=std::min( n, std::max(size_t(2), size_t((dx_raw-window)/avgdx)) );
+  }
+
+  mean_=arma::zeros(n_avg, 2);
+  for (size_t i=0; i<n_avg; ++i)
+  {
+    double x = x0 + window + double(i)*avgdx;
+    double from = x - window, to = x;
+
+    size_t j0=lowerIndex(raw_, i0_, i1_, from);
+    size_t j1=lowerIndex(raw_, i0_, i1_, std::nextafter(to, DBL_MAX)); // behind last sample <=to
+
+    mean_(i,0)=x;
+    if (j1<=j0)
+    {
+      // nothing selected: take the closest sample
+      size_t j=std::min(j0, i1_-1);
+      if ( j>i0_ && fabs(raw_.x(j-1)-0.5*(from+to)) < fabs(raw_.x(j)-0.5*(from+to)) )
+        j--;
+      mean_(i,1)=raw_.y(j);
+    }
+    else
+    {
+      j1--;
+      double span=raw_.x(j1)-raw_.x(j0);
+      if (span>0.)
+        mean_(i,1)=(cumInt_[j1]-cumInt_[j0])/span;
+      else
+        mean_(i,1)=raw_.y(j1);
+    }
+  }
+}
+
 void PlotWidget::onMeanAvgFractionChange(double)
 {
-  if (!mc_)
+  if (mc_)
   {
-    ui->info->setText("Computing moving average of raw data...");
-    mc_=new MeanComputer( this, visible_part_, ui->avg_fraction->value() );
+    // data or fraction changed during the computation
+    restartMean_=true;
+    return;
+  }
+
+  ui->info->setText("Computing moving average of raw data...");
+
+  if (!raw_.xMonotonic() && i1_>i0_)
+  {
+    // no ordering of the samples: use the generic implementation,
+    // which is too slow for the GUI thread
+    arma::mat vis(i1_-i0_, 2);
+    for (size_t i=i0_; i<i1_; ++i)
+    {
+      vis(i-i0_, 0)=raw_.x(i);
+      vis(i-i0_, 1)=raw_.y(i);
+    }
+    restartMean_=false;
+    mc_=new MeanComputer( this, vis, ui->avg_fraction->value() );
     connect(mc_, &MeanComputer::resultReady, this, &PlotWidget::onMeanDataReady);
     mc_->start();
+    return;
   }
+
+  computeMean();
+  showMean();
+
+  // report asynchronously, like the computation in background does
+  QMetaObject::invokeMethod(
+        this, [this]() { Q_EMIT averageValueReady(); },
+        Qt::QueuedConnection );
 }
 
+
 MeanComputer::MeanComputer(QObject* p, const arma::mat& rd, double frac)
   : QThread(p),
     rawdata_(rd),
@@ -141,67 +275,100 @@ MeanComputer::MeanComputer(QObject* p, const arma::mat& rd, double frac)
 
 void MeanComputer::run()
 {
-  emit resultReady( insight::movingAverage(rawdata_, frac_) );
+  Q_EMIT resultReady( insight::movingAverage(rawdata_, frac_) );
 }
 
-double MeanComputer::fraction() const
+
+void PlotWidget::onMeanDataReady(arma::mat avg)
 {
-    return frac_;
+  mc_->wait();
+  delete mc_;
+  mc_=nullptr;
+
+  if (restartMean_)
+  {
+    onMeanAvgFractionChange();
+  }
+  else
+  {
+    mean_=avg;
+    showMean();
+    Q_EMIT averageValueReady();
+  }
 }
 
-void PlotWidget::onMeanDataReady(arma::mat avg)
+
+void PlotWidget::showMean()
 {
-  if (avg.n_rows>0)
+  mean_crv_->clear();
+  if (mean_.n_rows>0)
   {
     ui->final_vals->setText(QString::fromStdString(
       str(format("Final values: raw=%g / mean = %g")
-           %( rawdata_.col(1)(rawdata_.n_rows-1) )
-           %( avg.col(1)(avg.n_rows-1) ))
+           %( raw_.y(raw_.size()-1) )
+           %( mean_(mean_.n_rows-1, 1) ))
     ));
 
-    mean_crv_->clear();
-    for (arma::uword i=0; i<avg.n_rows; ++i)
-      mean_crv_->append(avg(i,0), avg(i,1));
+    QList<QPointF> pts;
+    for (arma::uword i=0; i<mean_.n_rows; ++i)
+      pts.append(QPointF(mean_(i,0), mean_(i,1)));
+    mean_crv_->replace(pts);
 
     ui->info->setText("Moving average computed.");
-  //  plot_->replot();
   }
   else
   {
     ui->info->setText("Empty moving average.");
   }
-
-  mc_->wait();
-
-  bool startOver=false;
-  if (mc_->fraction()!=ui->avg_fraction->value())
-      startOver=true;
-
-  delete mc_;
-  mc_=nullptr;
-
-  if (startOver)
-      onMeanAvgFractionChange();
-  else
-      Q_EMIT averageValueReady();
 }
 
 
 void PlotWidget::onChangeXRange(const QString& v0, const QString& v1)
 {
-  double x0=rawdata_.col(0).min();
-  double x1=rawdata_.col(0).max();
+  x0_=v0;
+  x1_=v1;
+
+  size_t n=raw_.size();
+  if (n==0) return;
+
+  double x0=raw_.x(0), x1=raw_.x(n-1);
+  if (!raw_.xMonotonic())
+  {
+    for (size_t i=0; i<n; ++i)
+    {
+      x0=std::min(x0, raw_.x(i));
+      x1=std::max(x1, raw_.x(i));
+    }
+  }
 
   if (!v0.isEmpty()) x0=v0.toDouble();
   if (!v1.isEmpty()) x1=v1.toDouble();
 
-  visible_part_=rawdata_.rows( arma::find(rawdata_.col(0)>x0 && rawdata_.col(0)<x1) );
-  double ymin=0., ymax=1.;
-  if (visible_part_.n_rows>0)
+  i0_=0; i1_=n;
+  if (raw_.xMonotonic())
   {
-    ymin=visible_part_.col(1).min();
-    ymax=visible_part_.col(1).max();
+    // samples with x0 < x < x1
+    i0_=lowerIndex(raw_, 0, n, std::nextafter(x0, DBL_MAX));
+    i1_=std::max(i0_, lowerIndex(raw_, 0, n, x1));
+  }
 
+  // display only the points required at the current resolution
+  auto pts = raw_.extract(x0, x1, std::max(1, plot_->width()));
+  QList<QPointF> ptDisplay;
+  double ymin=DBL_MAX, ymax=-DBL_MAX;
+  for (const auto& p: pts)
+  {
+    ptDisplay.append(QPointF(p.first, p.second));
+    if (p.first>x0 && p.first<x1)
+    {
+      ymin=std::min(ymin, p.second);
+      ymax=std::max(ymax, p.second);
+    }
+  }
+  raw_crv_->replace(ptDisplay);
+
+  if (ymin<=ymax)
+  {
     if (ui->include_0_sw->isChecked())
     {
       if (ymin>0.) ymin=0.;
@@ -213,35 +380,29 @@ void PlotWidget::onChangeXRange(const QString& v0, const QString& v1)
 
     onMeanAvgFractionChange();
   }
+  else
+  {
+    ymin=0.;
+    ymax=1.;
+  }
 
   plotData_->axisX()->setRange(x0, x1);
   plotData_->axisY()->setRange(ymin, ymax);
-
-//  plot_->replot();
 }
 
 void PlotWidget::onToggleY0(bool)
 {
-  double x0=dynamic_cast<const QtCharts::QValueAxis&>(*plotData_->axisX()).min();
-  double x1=dynamic_cast<const QtCharts::QValueAxis&>(*plotData_->axisX()).max();
-  QString sx0="";
-  QString sx1="";
-  if ( fabs(x1-x0)>0 )
-  {
-    sx0=QString::number(x0);
-    sx1=QString::number(x1);
-  }
-  onChangeXRange(sx0, sx1);
+  onChangeXRange(x0_, x1_);
 }
 
 double PlotWidget::finalRawValue() const
 {
-    insight::assertion(raw_crv_->count()>0, "no data available");
-    return raw_crv_->at(raw_crv_->count()-1).y();
+    insight::assertion(raw_.size()>0, "no data available");
+    return raw_.y(raw_.size()-1);
 }
 
 double PlotWidget::finalMeanValue() const
 {
-    insight::assertion(mean_crv_->count()>0, "no mean value computed yet");
-    return mean_crv_->at(mean_crv_->count()-1).y();
+    insight::assertion(mean_.n_rows>0, "no mean value computed yet");
+    return mean_(mean_.n_rows-1, 1);
 }
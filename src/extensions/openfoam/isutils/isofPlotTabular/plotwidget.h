@@ -19,6 +19,7 @@
  */
 
 
+
 #ifndef PLOTWIDGET_H
 #define PLOTWIDGET_H
 
@@ -26,6 +27,7 @@
 #include <QThread>
 
 #include "base/linearalgebra.h"
+#include "iqlineseriesdata.h"
 
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
@@ -36,15 +38,17 @@ namespace Ui {
 }
 
 
+/**
+ * computes the moving average of samples without ordering in x
+ */
 class MeanComputer : public QThread
 {
   Q_OBJECT
-  const arma::mat& rawdata_;
+  arma::mat rawdata_;
   double frac_;
 public:
   MeanComputer(QObject *parent, const arma::mat& rawdata, double frac);
-  virtual void run();
-  double fraction() const;
+  void run() override;
 Q_SIGNALS:
   void resultReady(arma::mat meandata);
 };
@@ -54,15 +58,51 @@ class PlotWidget : public QWidget
 {
   Q_OBJECT
 
-  arma::mat rawdata_;
-  arma::mat visible_part_;
+  /**
+   * raw data with min/max summary for display
+   */
+  MinMaxPyramidSeries raw_;
+
+  /**
+   * running trapezoidal integral of the raw data,
+   * moving averages are evaluated from differences of it
+   */
+  std::vector<double> cumInt_;
+
+  arma::mat mean_;
+
+  QString x0_, x1_;
+
+  /**
+   * index range of the currently displayed raw data
+   */
+  size_t i0_, i1_;
+
+  /**
+   * background computation of the moving average,
+   * if the raw data is not sorted by x
+   */
   MeanComputer *mc_=nullptr;
+  bool restartMean_=false;
+
+  void computeMean();
+  void showMean();
 
 public:
   explicit PlotWidget(QWidget *parent = 0);
   ~PlotWidget();
 
-  void setData(const arma::mat& x, const arma::mat& y);
+  void clearData();
+  /**
+   * @brief appendData
+   * append the values x[i], y[i] for from<=i<x.size()
+   */
+  void appendData(const std::vector<double>& x, const std::vector<double>& y, size_t from=0);
+  /**
+   * @brief truncateData
+   * keep only the first n samples
+   */
+  void truncateData(size_t n);
   void changeAvgFraction(double f);
 
 public Q_SLOT:
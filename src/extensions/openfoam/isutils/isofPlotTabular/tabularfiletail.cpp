@@ -0,0 +1,230 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "tabularfiletail.h"
+
+#include "base/exception.h"
+#include "openfoam/openfoamtools.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+
+TabularFileTail::TabularFileTail(const boost::filesystem::path& file)
+    : file_(file),
+      offset_(0)
+{}
+
+
+TabularFileTail::~TabularFileTail()
+{
+    stopFollowing();
+}
+
+
+bool TabularFileTail::isStdIn() const
+{
+    return file_.string()=="-";
+}
+
+
+void TabularFileTail::addLine(const std::string &line)
+{
+    Row vals;
+    if (insight::parseTextFileLine(line, vals))
+    {
+        std::lock_guard<std::mutex> lck(mx_);
+        pending_.push_back(std::move(vals));
+    }
+}
+
+
+bool TabularFileTail::readNew()
+{
+    if (isStdIn())
+    {
+        if (offset_==0) // stdin can only be read once
+        {
+            std::string line;
+            while (getline(std::cin, line))
+            {
+                addLine(line);
+                offset_+=line.size()+1;
+            }
+        }
+        return true;
+    }
+
+    insight::assertion(
+        !isFollowing(),
+        "internal error: file %s is already followed in background",
+        file_.string().c_str() );
+
+    bool continued=true;
+
+    std::int64_t size=boost::filesystem::file_size(file_);
+    if (size<offset_)
+    {
+        // truncated: start over
+        restart();
+        continued=false;
+    }
+
+    if (size>offset_)
+    {
+        std::ifstream f(file_.string(), std::ios::binary);
+        f.seekg(offset_);
+
+        std::string buf(size-offset_, '\0');
+        f.read(&buf[0], buf.size());
+        buf.resize(f.gcount());
+
+        // consume complete lines only, a partially written last line
+        // is left for the next read
+        std::string::size_type b=0, e;
+        while ( (e=buf.find('\n', b)) != std::string::npos )
+        {
+            addLine(buf.substr(b, e-b));
+            b=e+1;
+        }
+        offset_+=b;
+    }
+
+    return continued;
+}
+
+
+void TabularFileTail::restart()
+{
+    if (isStdIn()) return;
+
+    stopFollowing();
+    offset_=0;
+    std::lock_guard<std::mutex> lck(mx_);
+    pending_.clear();
+}
+
+
+void TabularFileTail::startFollowing()
+{
+    if (isStdIn() || isFollowing()) return;
+
+    follower_.reset(
+        new insight::FileWatcher(
+            file_,
+            [this](const std::string& line)
+            {
+                addLine(line);
+                offset_+=line.size()+1;
+            },
+            true,
+            offset_ ) );
+}
+
+
+void TabularFileTail::stopFollowing()
+{
+    follower_.reset();
+}
+
+
+std::vector<TabularFileTail::Row> TabularFileTail::takeNewRows()
+{
+    std::vector<Row> nr;
+    std::lock_guard<std::mutex> lck(mx_);
+    std::swap(nr, pending_);
+    return nr;
+}
+
+
+
+
+size_t mergeRows(
+    std::vector<std::vector<double> >& data,
+    std::vector<TabularFileTail::Row> newRows,
+    bool sorted )
+{
+  size_t n0 = data.size() ? data[0].size() : 0;
+  if (newRows.empty())
+    return n0;
+
+  if (data.empty())
+  {
+    data.resize(newRows.front().size());
+  }
+  size_t nCols=data.size();
+
+  for (const auto& r: newRows)
+  {
+    insight::assertion(
+          r.size()==nCols,
+          "Incompatible data: number cols is %d but should be %d!",
+          int(r.size()), int(nCols) );
+  }
+
+  auto firstColLess =
+      [](const TabularFileTail::Row& a, const TabularFileTail::Row& b)
+      { return a[0]<b[0]; };
+
+  // position, where the first new row has to be inserted
+  size_t pos=n0;
+  if (sorted)
+  {
+    std::stable_sort(newRows.begin(), newRows.end(), firstColLess);
+    if (n0)
+    {
+      pos = std::upper_bound(
+            data[0].begin(), data[0].end(), newRows.front()[0] )
+            - data[0].begin();
+    }
+  }
+
+  std::vector<TabularFileTail::Row> merged;
+  if (pos==n0)
+  {
+    // usual case: new data continues the existing data
+    merged = std::move(newRows);
+  }
+  else
+  {
+    // merge the new rows with the existing rows behind pos
+    std::vector<TabularFileTail::Row> tail;
+    for (size_t i=pos; i<n0; ++i)
+    {
+      TabularFileTail::Row r(nCols);
+      for (size_t j=0; j<nCols; ++j) r[j]=data[j][i];
+      tail.push_back(r);
+    }
+    for (auto& c: data) c.resize(pos);
+
+    std::merge(
+          tail.begin(), tail.end(), newRows.begin(), newRows.end(),
+          std::back_inserter(merged), firstColLess );
+  }
+
+  for (const auto& r: merged)
+    for (size_t j=0; j<nCols; ++j)
+      data[j].push_back(r[j]);
+
+  return pos;
+}
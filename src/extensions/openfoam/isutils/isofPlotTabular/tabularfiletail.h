@@ -0,0 +1,119 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef TABULARFILETAIL_H
+#define TABULARFILETAIL_H
+
+#include "base/boost_include.h"
+#include "base/filewatcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * @brief The TabularFileTail class
+ * Reads tabular data from a text file, which is possibly still growing.
+ * Only the bytes appended since the last read are parsed.
+ */
+class TabularFileTail
+{
+public:
+    typedef std::vector<double> Row;
+
+private:
+    boost::filesystem::path file_;
+
+    /**
+     * byte offset behind the last complete line, which was consumed
+     */
+    std::int64_t offset_;
+
+    std::mutex mx_;
+    std::vector<Row> pending_;
+
+    std::unique_ptr<insight::FileWatcher> follower_;
+
+    void addLine(const std::string& line);
+
+public:
+    TabularFileTail(const boost::filesystem::path& file);
+    ~TabularFileTail();
+
+    inline const boost::filesystem::path& file() const { return file_; }
+
+    bool isStdIn() const;
+
+    /**
+     * @brief readNew
+     * parse all complete lines, which were appended since the last call
+     * @return
+     * false, if the file has been truncated or replaced. The read position
+     * is reset to the beginning of the file in that case and all data has to be
+     * re-read.
+     */
+    bool readNew();
+
+    /**
+     * @brief restart
+     * discard all unread rows and read from the beginning on next call to readNew
+     */
+    void restart();
+
+    /**
+     * @brief startFollowing
+     * watch the file in the background and collect appended lines,
+     * until stopFollowing is called
+     */
+    void startFollowing();
+    void stopFollowing();
+    inline bool isFollowing() const { return bool(follower_); }
+
+    /**
+     * @brief takeNewRows
+     * @return
+     * rows parsed since the last call
+     */
+    std::vector<Row> takeNewRows();
+};
+
+
+
+
+/**
+ * @brief mergeRows
+ * add rows to column-wise stored data.
+ * @param sorted
+ * if set, the data is kept sorted by the first column: the new rows are sorted
+ * (stable) and merged with the existing rows behind the first new value.
+ * Otherwise, they are just appended.
+ * @return
+ * index of the first row, which was changed. The rows before are untouched,
+ * usually this is the previous number of rows.
+ */
+size_t mergeRows(
+    std::vector<std::vector<double> >& data,
+    std::vector<TabularFileTail::Row> newRows,
+    bool sorted );
+
+#endif // TABULARFILETAIL_H
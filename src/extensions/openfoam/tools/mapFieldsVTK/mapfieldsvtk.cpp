@@ -4,8 +4,11 @@
 #include <limits>
 #include "vtkSmartPointer.h"
 #include "vtkGenericDataObjectReader.h"
-#include "vtkProbeFilter.h"
-#include "vtkIdTypeArray.h"
+#include "vtkDataSet.h"
+#include "vtkPointData.h"
+#include "vtkCellData.h"
+#include "vtkCellLocator.h"
+#include "vtkGenericCell.h"
 
 #include "uniof.h"
 #include "vtkconversion.h"
@@ -14,32 +17,103 @@
 #include "volFields.H"
 #include "surfaceFields.H"
 #include "IOobjectList.H"
+#include "Tuple2.H"
 
 #include <set>
 #include <memory>
+#include <vector>
 
 using namespace Foam;
 
 
 
-template<class T>
-void copyValue(double *vtkCmpts, T& ofCmpts)
+
+/**
+ * interpolation weights of the target cell centres
+ * in one source geometry. They are computed once
+ * and reused for all snapshots with the same source geometry.
+ */
+struct InterpolationWeights
 {
-    for (label i=0; i<pTraits<T>::nComponents; ++i)
+    //- containing (or nearest) source cell of each target cell, -1 if not found
+    std::vector<vtkIdType> cellIds;
+    //- start of the weights of target cell j in pointIds/weights (size n+1)
+    std::vector<std::size_t> offsets;
+    std::vector<vtkIdType> pointIds;
+    std::vector<double> weights;
+    label nFound, nExtrapolated;
+
+    InterpolationWeights
+    (
+        vtkDataSet* ds,
+        const pointField& target,
+        bool extrapolate
+    )
+    : cellIds(target.size(), -1),
+      offsets(target.size()+1, 0),
+      nFound(0),
+      nExtrapolated(0)
     {
-        setComponent(ofCmpts, i)=vtkCmpts[i];
+        auto loc = vtkSmartPointer<vtkCellLocator>::New();
+        loc->SetDataSet(ds);
+        loc->BuildLocator();
+
+        auto cell = vtkSmartPointer<vtkGenericCell>::New();
+        std::vector<double> cw(std::max(1, ds->GetMaxCellSize()));
+        double tol2 = probeTolerance2(ds);
+        double pc[3];
+
+        forAll(target, j)
+        {
+            double x[3] = { target[j].x(), target[j].y(), target[j].z() };
+
+            vtkIdType ci = loc->FindCell(x, tol2, cell, pc, cw.data());
+            if (ci>=0)
+            {
+                nFound++;
+            }
+            else if (extrapolate)
+            {
+                // nearest valid: interpolate at the closest point on the source
+                double cp[3], dist2;
+                int subId;
+                loc->FindClosestPoint(x, cp, cell, ci, subId, dist2);
+                if (ci>=0)
+                {
+                    cell->EvaluatePosition(cp, nullptr, subId, pc, dist2, cw.data());
+                    nExtrapolated++;
+                }
+            }
+
+            if (ci>=0)
+            {
+                cellIds[j]=ci;
+                for (vtkIdType k=0; k<cell->GetNumberOfPoints(); ++k)
+                {
+                    pointIds.push_back(cell->GetPointId(k));
+                    weights.push_back(cw[k]);
+                }
+            }
+            offsets[j+1]=pointIds.size();
+        }
     }
-}
+};
+
+
+
 
 template<class GeoField>
 void ReadAndSetFields
 (
     const fvMesh& mesh,
     const IOobjectList& objects,
-    vtkProbeFilter* ipf,
+    vtkDataSet* ds,
+    const InterpolationWeights& w,
     const HashTable<word, word>& fieldMatching
 )
 {
+    typedef typename GeoField::value_type Type;
+
     // Objects of field type
     IOobjectList fields(objects.
 #if OF_VERSION>=060505
@@ -49,9 +123,6 @@ void ReadAndSetFields
 #endif
                         );
 
-    auto *validPts = ipf->GetValidPoints();
-    auto *ipd = ipf->GetOutput();
-    auto *ippd = ipd->GetPointData();
 #if OF_VERSION>=060505
     forAllConstIters(
 #else
@@ -68,28 +139,58 @@ void ReadAndSetFields
             sourceName = fieldMatching[targetName];
         }
 
-        if (ippd->HasArray(sourceName.c_str()))
+        vtkDataArray *src = ds->GetPointData()->GetArray(sourceName.c_str());
+        bool isPointData = (src!=nullptr);
+        if (!src)
         {
-            auto *src = ippd->GetArray(sourceName.c_str());
+            src = ds->GetCellData()->GetArray(sourceName.c_str());
+        }
 
-            if (src->GetNumberOfComponents()!=pTraits<typename GeoField::value_type>::nComponents)
+        if (src)
+        {
+            if (src->GetNumberOfComponents()!=pTraits<Type>::nComponents)
             {
                 FatalErrorIn("SetFields") << "different number of components for field " << fieldIter()->name()
                                           <<": VTK:"<<label(src->GetNumberOfComponents())
-                                         <<", OpenFOAM:"<<pTraits<typename GeoField::value_type>::nComponents
+                                         <<", OpenFOAM:"<<pTraits<Type>::nComponents
                                         << abort(FatalError);
             }
 
+            // read the field from its original location
+            // and write it into the current time
             GeoField fld(*fieldIter(), mesh);
+            fld.instance() = mesh.time().timeName();
 
             Info<< "    Setting " << fld.name() << " from " << sourceName << endl;
-            for (vtkIdType i=0; i<validPts->GetNumberOfValues(); ++i)
+
+            double v[pTraits<Type>::nComponents];
+            forAll(fld, j)
             {
-                label cellI = validPts->GetValue(i);
-                copyValue(
-                            src->GetTuple(cellI),
-                            fld[cellI]
-                            );
+                if (w.cellIds[j]<0) continue;
+
+                if (isPointData)
+                {
+                    for (label k=0; k<pTraits<Type>::nComponents; ++k) v[k]=0.;
+                    for (auto l=w.offsets[j]; l<w.offsets[j+1]; ++l)
+                    {
+                        for (label k=0; k<pTraits<Type>::nComponents; ++k)
+                        {
+                            v[k] += w.weights[l]*src->GetComponent(w.pointIds[l], k);
+                        }
+                    }
+                }
+                else
+                {
+                    for (label k=0; k<pTraits<Type>::nComponents; ++k)
+                    {
+                        v[k] = src->GetComponent(w.cellIds[j], k);
+                    }
+                }
+
+                for (label k=0; k<pTraits<Type>::nComponents; ++k)
+                {
+                    setComponent(fld[j], k)=v[k];
+                }
             }
 
             fld.write();
@@ -104,6 +205,8 @@ int main(int argc, char *argv[])
   argList::validArgs.append("VTK file");
   argList::validOptions.insert("fieldMatching", "map of extra corresponding source and target fields ( (<target field> <source field name>) ... )");
   argList::validOptions.insert("createScalarFields", "list of fields to create before mapping");
+  argList::validOptions.insert("series", "list of further snapshots ( (<time> <VTK file>) ... ). Each is mapped into the given time directory, the fields of the current time serve as templates.");
+  argList::validOptions.insert("noExtrapolation", "leave cells outside of the source unmapped instead of taking the value at the nearest source location");
 
 # include "setRootCase.H"
 # include "createTime.H"
@@ -128,29 +231,16 @@ int main(int argc, char *argv[])
       );
   }
 
-  Info << "Reading VTK data." << endl;
-  auto r = vtkSmartPointer<vtkGenericDataObjectReader>::New();
-  r->SetFileName(vtkFile.c_str());
-  r->Update();
-
-  Info << "Performing interpolation." << endl;
-  auto targ = vtkSmartPointer<vtkPolyData>::New();
-  setPoints<vtkPolyData>(mesh.C().internalField(), targ);
-
-
-  // Gaussian kernel
-//    auto gaussianKernel = vtkSmartPointer<vtkGaussianKernel>::New();
-//    gaussianKernel->SetSharpness(2.0);
-//    gaussianKernel->SetRadius(12.0);
-
-//    auto ip=vtkSmartPointer<vtkPointInterpolator>::New();
-  auto ip=vtkSmartPointer<vtkProbeFilter>::New();
-  ip->SetInputData(targ);
-  ip->SetSourceData(r->GetOutput());
-
-  ip->Update();
+  List<Tuple2<scalar, fileName> > snapshots(1,
+      Tuple2<scalar, fileName>(runTime.value(), vtkFile) );
+  if (UNIOF_OPTIONFOUND(args, "series"))
+  {
+      snapshots.append(List<Tuple2<scalar, fileName> >(
+                  IStringStream(UNIOF_OPTION(args, "series"))()
+                  ));
+  }
 
-  Info << " Found correspondence for " << label(ip->GetValidPoints()->GetNumberOfValues()) << " out of " << mesh.C().internalField().size() << " cells." << endl;
+  bool extrapolate = !UNIOF_OPTIONFOUND(args, "noExtrapolation");
 
   std::set<std::unique_ptr<volScalarField> > createdFields; // need to keep them in memory until after mapping
 
@@ -174,12 +264,51 @@ int main(int argc, char *argv[])
       createdFields.insert(std::move(s));
   }
 
+  // templates of the fields to map
   IOobjectList objects(mesh, runTime.timeName());
-  ReadAndSetFields<volScalarField>(mesh, objects, ip, fieldMatching);
-  ReadAndSetFields<volVectorField>(mesh, objects, ip, fieldMatching);
-  ReadAndSetFields<volSymmTensorField>(mesh, objects, ip, fieldMatching);
-  ReadAndSetFields<volTensorField>(mesh, objects, ip, fieldMatching);
 
+  std::unique_ptr<InterpolationWeights> w;
+  std::vector<uint64_t> wSig;
+
+  forAll(snapshots, si)
+  {
+      runTime.setTime(snapshots[si].first(), si);
+
+      Info << "Reading VTK data from " << snapshots[si].second()
+           << " for time " << runTime.timeName() << "." << endl;
+      auto r = vtkSmartPointer<vtkGenericDataObjectReader>::New();
+      r->SetFileName(snapshots[si].second().c_str());
+      r->Update();
+
+      auto *ds = vtkDataSet::SafeDownCast(r->GetOutput());
+      if (!ds)
+      {
+          FatalErrorIn("mapFieldsVTK")
+              << "file "<<snapshots[si].second()<<" does not contain a data set!"
+              <<abort(FatalError);
+      }
+
+      auto sig = geometrySignature(ds);
+      if (!w || sig!=wSig)
+      {
+          Info << "Computing interpolation weights." << endl;
+          w.reset(new InterpolationWeights(ds, mesh.C().internalField(), extrapolate));
+          wSig = sig;
+
+          Info << " Found correspondence for " << returnReduce(w->nFound, sumOp<label>())
+               << " out of " << returnReduce(mesh.nCells(), sumOp<label>()) << " cells";
+          if (extrapolate)
+          {
+              Info << ", extrapolated " << returnReduce(w->nExtrapolated, sumOp<label>());
+          }
+          Info << "." << endl;
+      }
+
+      ReadAndSetFields<volScalarField>(mesh, objects, ds, *w, fieldMatching);
+      ReadAndSetFields<volVectorField>(mesh, objects, ds, *w, fieldMatching);
+      ReadAndSetFields<volSymmTensorField>(mesh, objects, ds, *w, fieldMatching);
+      ReadAndSetFields<volTensorField>(mesh, objects, ds, *w, fieldMatching);
+  }
 
   return 0;
 }
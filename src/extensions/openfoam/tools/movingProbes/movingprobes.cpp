@@ -3,11 +3,118 @@
 #include "uniof.h"
 
 #include "meshSearch.H"
-#include "cloudSet.H"
+#include "interpolation.H"
 
 using namespace Foam;
 
 
+
+
+/**
+ * locate the probes in the local mesh part.
+ * The search starts from the cell of the previous time (walk),
+ * the octree is only used, if the walk fails.
+ * Probes outside the local mesh part get the nearest cell
+ * and its distance, probes inside get distance zero.
+ */
+void locateProbes
+(
+    const fvMesh& mesh,
+    meshSearch& searchEngine,
+    const pointField& pts,
+    labelList& cells,
+    scalarField& dist
+)
+{
+    forAll(pts, pi)
+    {
+        const point& p = pts[pi];
+
+        label ci = -1;
+        if (cells[pi]>=0)
+        {
+            ci = searchEngine.findCell(p, cells[pi], true);
+        }
+        if (ci<0)
+        {
+            ci = searchEngine.findCell(p, -1, true);
+        }
+
+        if (ci>=0)
+        {
+            dist[pi] = 0;
+        }
+        else if (mesh.nCells()>0)
+        {
+            ci = searchEngine.findNearestCell(p, -1, true);
+            dist[pi] = mag(mesh.C()[ci] - p);
+        }
+        else
+        {
+            dist[pi] = GREAT;
+        }
+
+        cells[pi] = ci;
+    }
+}
+
+
+
+
+template<class Type>
+void sampleField
+(
+    const fvMesh& mesh,
+    const word& fieldName,
+    const word& interpolationScheme,
+    const pointField& pts,
+    const labelList& cells,
+    const scalarField& dist,
+    label& col,
+    label stride,
+    scalarField& values
+)
+{
+    typedef GeometricField<Type, fvPatchField, volMesh> FieldType;
+
+    FieldType vf
+    (
+        IOobject
+        (
+            fieldName,
+            mesh.time().timeName(),
+            mesh,
+            IOobject::MUST_READ,
+            IOobject::NO_WRITE
+        ),
+        mesh
+    );
+
+    autoPtr<interpolation<Type> > interp
+    (
+        interpolation<Type>::New(interpolationScheme, vf)
+    );
+
+    forAll(pts, pi)
+    {
+        label ci = cells[pi];
+        if (ci<0) continue;
+
+        // no extrapolation outside of the mesh: take the nearest cell value
+        Type v = dist[pi]>0 ? vf[ci] : interp().interpolate(pts[pi], ci);
+
+        for (direction c=0; c<pTraits<Type>::nComponents; c++)
+        {
+            values[pi*stride + col + c] = component(v, c);
+        }
+    }
+
+    col += pTraits<Type>::nComponents;
+}
+
+
+
+
 int main(int argc, char *argv[])
 {
     timeSelector::addOptions();
@@ -16,6 +123,9 @@ int main(int argc, char *argv[])
     argList::validArgs.append("velocity");
     argList::validArgs.append("output file");
 
+    argList::validOptions.insert("fields", "list of scalar or vector fields to sample (default: (p))");
+    argList::validOptions.insert("interpolationScheme", "interpolation scheme (default: cellPoint, use cell for cell values)");
+
 #include "setRootCase.H"
 #include "createTime.H"
     instantList timeDirs = timeSelector::select0(runTime, args);
@@ -32,43 +142,159 @@ int main(int argc, char *argv[])
 
     fileName outfilename(UNIOF_ADDARG(args,2));
 
-    OFstream f(outfilename);
+    wordList fieldNames(1, word("p"));
+    if (UNIOF_OPTIONFOUND(args, "fields"))
+    {
+        fieldNames = wordList(IStringStream(UNIOF_OPTION(args, "fields"))());
+    }
 
-    f<<"# t";
-    forAll(points, pi)
+    word interpolationScheme("cellPoint");
+    if (UNIOF_OPTIONFOUND(args, "interpolationScheme"))
     {
-        f<<" pt"<<pi<<"@"<<points[pi];
+        interpolationScheme = word(IStringStream(UNIOF_OPTION(args, "interpolationScheme"))());
     }
-    f<<endl;
+
+    autoPtr<meshSearch> searchEngine(new meshSearch(mesh));
+    labelList cells(points.size(), -1);
+    scalarField dist(points.size(), GREAT);
+
+    autoPtr<OFstream> f;
+    wordList columns;
 
     forAll(timeDirs, timeI)
     {
         runTime.setTime(timeDirs[timeI], timeI);
         Info<< "Time = " << runTime.timeName() << endl;
-        mesh.readUpdate();
+        fvMesh::readUpdateState state = mesh.readUpdate();
 
-        IOobject pheader
+        if (state != fvMesh::UNCHANGED)
+        {
+            searchEngine.reset(new meshSearch(mesh));
+            if (state != fvMesh::POINTS_MOVED)
+            {
+                // cell labels are invalid after topology change
+                cells = -1;
+            }
+        }
+
+        pointField curPts( points + U*runTime.value() );
+
+        locateProbes(mesh, searchEngine(), curPts, cells, dist);
+
+        // field types from the headers (the same on all processors)
+        labelList nCmpts(fieldNames.size(), 0);
+        DynamicList<word> curColumns;
+        forAll(fieldNames, fi)
+        {
+            const word& fn = fieldNames[fi];
+            IOobject header
             (
-                "p",
+                fn,
                 runTime.timeName(),
                 mesh,
                 IOobject::MUST_READ,
                 IOobject::NO_WRITE
-                );
-        volScalarField p(pheader, mesh);
-
-        auto curPts = points + U*runTime.value();
+            );
+            if (UNIOF_HEADEROK(header, volScalarField))
+            {
+                nCmpts[fi] = pTraits<scalar>::nComponents;
+                curColumns.append(fn);
+            }
+            else if (UNIOF_HEADEROK(header, volVectorField))
+            {
+                nCmpts[fi] = pTraits<vector>::nComponents;
+                for (direction c=0; c<vector::nComponents; c++)
+                {
+                    curColumns.append(fn+"_"+vector::componentNames[c]);
+                }
+            }
+            else
+            {
+                FatalErrorIn("movingProbes::main")
+                    << "Field " << fn
+                    << " is not available as scalar or vector field at time "
+                    << runTime.timeName()
+                    << abort(FatalError);
+            }
+        }
 
-        f<<runTime.value();
-        forAll(curPts(), pi)
+        // per probe: distance to the containing/nearest cell, then the field values
+        label stride = 1 + sum(nCmpts);
+        scalarField values(points.size()*stride, 0.0);
+        forAll(dist, pi)
         {
-            auto ci=mesh.findNearestCell(curPts()[pi]);
-            auto pc = p[ci];
-            f<<" "<<pc;
+            values[pi*stride] = dist[pi];
+        }
+        label col = 1;
+        forAll(fieldNames, fi)
+        {
+            if (nCmpts[fi]==pTraits<scalar>::nComponents)
+            {
+                sampleField<scalar>(mesh, fieldNames[fi], interpolationScheme, curPts, cells, dist, col, stride, values);
+            }
+            else
+            {
+                sampleField<vector>(mesh, fieldNames[fi], interpolationScheme, curPts, cells, dist, col, stride, values);
+            }
         }
-        f<<endl;
 
+        // single gather per time
+        List<scalarField> allValues(Pstream::nProcs());
+        allValues[Pstream::myProcNo()] = values;
+        Pstream::gatherList(allValues);
+
+        if (Pstream::master())
+        {
+            if (!f.valid())
+            {
+                columns.transfer(curColumns);
+                f.reset(new OFstream(outfilename));
 
+                f()<<"# t";
+                forAll(points, pi)
+                {
+                    if (columns.size()==1)
+                    {
+                        // keep the original format for a single scalar field
+                        f()<<" pt"<<pi<<"@"<<points[pi];
+                    }
+                    else
+                    {
+                        forAll(columns, ci)
+                        {
+                            f()<<" pt"<<pi<<"@"<<points[pi]<<":"<<columns[ci];
+                        }
+                    }
+                }
+                f()<<endl;
+            }
+            else if (wordList(curColumns) != columns)
+            {
+                FatalErrorIn("movingProbes::main")
+                    << "Field types changed at time " << runTime.timeName()
+                    << abort(FatalError);
+            }
+
+            f()<<runTime.value();
+            forAll(points, pi)
+            {
+                // processor containing the probe (or with the nearest cell)
+                label proci = 0;
+                forAll(allValues, pj)
+                {
+                    if (allValues[pj][pi*stride] < allValues[proci][pi*stride])
+                    {
+                        proci = pj;
+                    }
+                }
+
+                for (label c=1; c<stride; c++)
+                {
+                    f()<<" "<<allValues[proci][pi*stride + c];
+                }
+            }
+            f()<<endl;
+        }
     }
 
     Info<< "End\n" << endl;
@@ -24,8 +24,10 @@
 #include "base/analysis.h"
 #include "base/analysislibrary.h"
 #include "base/resultset.h"
+#include "base/indexedresultfile.h"
 #include "base/resultelements/chart.h"
 #include "base/table.h"
+#include "base/tools.h"
 #include "insightcaeapplication.h"
 
 #include <iostream>
@@ -74,6 +76,81 @@ void listContents(const ResultElementCollection& el, const std::string indent=""
 };
 
 
+void listContents(const IndexedResultFile& rf)
+{
+  const auto& paths = rf.contents();
+  for (size_t i=0; i<paths.size(); ++i)
+  {
+    const auto& path = paths[i];
+    auto depth = std::count(path.begin(), path.end(), '/');
+    std::string indent(depth, '\t');
+    auto name = path.substr(path.rfind('/')+1);
+
+    const auto& type = rf.elementType(path);
+    if (boost::ends_with(type, "Chart"))
+    {
+      // curve labels are only available from the chart itself
+      cout<<indent<<name<<" ("<<type<<")"<<endl;
+      if (const auto* chart = dynamic_cast<const Chart*>(&rf.element(path)))
+      {
+        for (const auto& d: chart->chartData()->plc_)
+        {
+          cout<<indent<<" - "<<d.plaintextlabel_<<std::endl;
+        }
+      }
+    }
+    else if ( i+1<paths.size() && boost::starts_with(paths[i+1], path+"/") )
+    {
+      // children follow their collection
+      cout<<indent<<name<<"/"<<endl;
+    }
+    else
+    {
+      cout<<indent<<name<<" ("<<type<<")"<<endl;
+    }
+  }
+}
+
+
+
+
+/**
+ * a loaded result file. It is either read completely or only indexed,
+ * if the requested actions need just single elements
+ * (see IndexedResultFile).
+ */
+struct ResultFile
+{
+  std::unique_ptr<ResultSet> full;
+  std::unique_ptr<IndexedResultFile> indexed;
+
+  template<class T>
+  const T& get(const std::string& path) const
+  {
+    if (full)
+      return full->get<T>(path);
+    else
+      return indexed->get<T>(path);
+  }
+
+  double getScalar(const std::string& path) const
+  {
+    if (full)
+      return full->getScalar(path);
+    else
+      return indexed->getScalar(path);
+  }
+
+  const ParameterSet& parameters() const
+  {
+    if (full)
+      return full->parameters();
+    else
+      return indexed->parameters();
+  }
+};
+
+
 
 const std::vector<unsigned int> colorTable = {
   0xe6194b,
@@ -206,7 +283,7 @@ void addCurveToPlot(ResultSet& results, const std::string& args)
 
 
 double comparePlotCurves(
-        const ResultSet& results,
+        const ResultFile& results,
         const std::string& chartPath,
         const std::string& curveA,
         const std::string& curveB )
@@ -267,6 +344,8 @@ int main(int argc, char *argv[])
                       "Save result set to specified file. Will be applied to every loaded set, so make only sense, if a single result set is loaded.")
         ("display,d", "Display each result file in separate window")
         ("input-file,f", po::value< StringList >(),"Specifies input file(s).")
+        ("threads,j", po::value< int >()->default_value(0),
+                      "Number of threads for reading the input files (0: all hardware threads).")
         ("compareplot", po::value< string >(), "Compare plots. Specify path to plot. Append name of the curve with ':'.")
         ("compareplotpoints", po::value< string >(),
           "Compare points in plots. Specify path to plot. "
@@ -347,7 +426,7 @@ int main(int argc, char *argv[])
         std::vector<string> fns;
         if (vm.count("input-file"))
             fns=vm["input-file"].as<StringList>();
-        std::vector<std::unique_ptr<ResultSet> > results;
+        std::vector<ResultFile> results(fns.size());
 
         std::unique_ptr<ParameterSet> deflPtr;
         if (vm.count("analysis"))
@@ -357,35 +436,68 @@ int main(int argc, char *argv[])
                     vm["analysis"].as<std::string>() );
         }
 
+        // the complete result sets are only required for
+        // modification, rendering and display.
+        // Otherwise, only the requested elements are read.
+        bool readIndexed =
+            !( vm.count("display") || vm.count("render") || vm.count("renderchart")
+              || vm.count("saveAs") || vm.count("add-curve") )
+            && ( vm.count("list") || vm.count("compareplot") || vm.count("compareplotpoints")
+                || vm.count("comparescalar") || vm.count("compareplotcurves")
+                || vm.count("compose") );
 
         // load results
-        for (std::string fn: fns)
+        for (const auto& fn: fns)
         {
-          boost::filesystem::path inpath(fn);
-
-          insight::assertion( boost::filesystem::exists(inpath),
-                              "input file "+inpath.string()+" does not exist!" );
+          insight::assertion( boost::filesystem::exists(fn),
+                              "input file "+fn+" does not exist!" );
+        }
 
-          {
-              cout<<"Reading results file "<<inpath<<"..."<<flush;
-              auto result=ResultSet::createFromFile(
-                  boost::filesystem::path(fn),
-                  std::move(deflPtr) );
+        if (fns.size()>0)
+        {
+          cout<<"Reading "<<fns.size()<<" results file(s)"
+              <<(readIndexed?" (indexed)":"")<<"..."<<flush;
+          parallelFor(
+              fns.size(),
+              [&](size_t i)
+              {
+                auto defl = deflPtr ? deflPtr->cloneAs<ParameterSet>() : nullptr;
+                if (readIndexed)
+                {
+                  results[i].indexed =
+                      std::make_unique<IndexedResultFile>(fns[i], std::move(defl));
+                }
+                else
+                {
+                  results[i].full =
+                      ResultSet::createFromFile(fns[i], std::move(defl));
+                }
+              },
+              vm["threads"].as<int>() );
+          cout<<"done."<<endl;
+        }
 
-              results.push_back( std::move(result) );
-              cout<<"done."<<endl;
-          }
-          auto result=results.back().get();
+        for (size_t i=0; i<fns.size(); ++i)
+        {
+          boost::filesystem::path inpath(fns[i]);
 
           if (vm.count("list"))
           {
             someActionDone=true;
             cout<<std::string(80, '=')<<endl<<endl;
             cout<<"Result file: "<<inpath<<endl<<endl;
-            listContents(*result);
+            if (results[i].full)
+              listContents(*results[i].full);
+            else
+              listContents(*results[i].indexed);
             cout<<endl<<std::string(80, '=')<<endl<<endl;
           }
 
+          if (!results[i].full)
+            continue;
+
+          auto result=results[i].full.get();
+
           if (vm.count("add-curve"))
           {
               auto acs=vm["add-curve"].as<StringList>();
@@ -455,7 +567,7 @@ int main(int argc, char *argv[])
                             idx<results.size(),
                             "index of result set out of range: \""+cargs[0]+"\"" );
 
-                cumulatedDistance += comparePlotCurves(*results[idx], cargs[1], cargs[2], cargs[3]);
+                cumulatedDistance += comparePlotCurves(results[idx], cargs[1], cargs[2], cargs[3]);
             }
 
             std::unique_ptr<std::ostream> osPtr;
@@ -507,7 +619,7 @@ int main(int argc, char *argv[])
                             "index of result set out of range: \""+ccargs[0]+"\"" );
                 auto path = ccargs[1];
 
-                auto& rr = results[idx]->get<ResultElement>(path);
+                auto& rr = results[idx].get<ResultElement>(path);
                 r->insert(
                      ccargs[2],
                      rr.cloneAs<ResultElement>()
@@ -553,7 +665,7 @@ int main(int argc, char *argv[])
             std::vector<double> vals;
             for (size_t j=0; j<varnames.size(); j++)
             {
-              vals.push_back(results[i]->getScalar(varnames[j])*sfs[j]);
+              vals.push_back(results[i].getScalar(varnames[j])*sfs[j]);
             }
             sorted_vals.push_back(NameAndValues(fns[i], vals));
           }
@@ -651,7 +763,7 @@ int main(int argc, char *argv[])
               insight::assertion( chart_curve.size()==2,
                                   "a curve name must be specified after each chart name, separated by colon" );
 
-              const auto& chart = results[i]->get<Chart>(chart_curve[0]);
+              const auto& chart = results[i].get<Chart>(chart_curve[0]);
 
               auto crv = std::find_if( chart.chartData()->plc_.begin(), chart.chartData()->plc_.end(),
                                        [&](const PlotCurve& pc) { return pc.plaintextlabel()==chart_curve[1]; } );
@@ -708,7 +820,7 @@ int main(int argc, char *argv[])
             for (size_t i=0; i<results.size(); i++)
             {
 
-              const auto& chart = results[i]->get<Chart>(chartName);
+              const auto& chart = results[i].get<Chart>(chartName);
 
               auto crv = std::find_if( chart.chartData()->plc_.begin(), chart.chartData()->plc_.end(),
                                        [&](const PlotCurve& pc) { return pc.plaintextlabel()==curveName; } );
@@ -721,7 +833,7 @@ int main(int argc, char *argv[])
                 std::string xparamname=chart_curve[2];
                 try
                 {
-                  const auto& sr = results[i]->get<ScalarResult>(xparamname);
+                  const auto& sr = results[i].get<ScalarResult>(xparamname);
                   x.push_back(sr());
                 }
                 catch (const std::exception& e)
@@ -729,7 +841,7 @@ int main(int argc, char *argv[])
                   try
                   {
                     // try parameters
-                    auto sp = results[i]->parameters().getDouble(xparamname);
+                    auto sp = results[i].parameters().getDouble(xparamname);
                     x.push_back(sp);
                   }
                   catch (const std::exception& e)
@@ -764,7 +876,7 @@ int main(int argc, char *argv[])
           {
               for (size_t i=0; i<results.size(); i++)
               {
-                auto& cr=results[i];
+                auto& cr=results[i].full;
                 auto w=new ResultViewWindow();
                 w->loadResults(std::move(cr));
                 w->setWindowTitle(w->windowTitle()+" - "+QString::fromStdString(fns[i]));
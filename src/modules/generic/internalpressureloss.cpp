@@ -202,27 +202,13 @@ void InternalPressureLoss::createMesh(insight::OpenFOAMCase& cm, ProgressDisplay
         }
         else
         {
-            auto feat=surfaceFeatureExtract(w.second.file->geometry(), 30.);
-
-            shm_cfg.features.push_back(
-                snappyHexMeshFeats::FeaturePtr(
-                    new snappyHexMeshFeats::ExplicitFeatureCurve(
-                        snappyHexMeshFeats::ExplicitFeatureCurve::Parameters()
-                            .set_level(maxLevel)
-                            .set_scalefactor(p().geometryscale)
-                            .set_geometry(make_geometryFile(feat))
-                            .set_name(w.first+"_features")
-                       )));
-
             int nLayers=0;
             if (boost::get<Parameters::geometry_default_type::role_wall_type>(&w.second.role))
             {
                 nLayers=p().mesh.nLayers;
             }
 
-            shm_cfg.features.push_back(
-                snappyHexMeshFeats::FeaturePtr(
-                    new snappyHexMeshFeats::Geometry(
+            auto geom = std::make_shared<snappyHexMeshFeats::Geometry>(
                         snappyHexMeshFeats::Geometry::Parameters()
                             .set_minLevel(minLevel)
                             .set_maxLevel(maxLevel)
@@ -230,7 +216,22 @@ void InternalPressureLoss::createMesh(insight::OpenFOAMCase& cm, ProgressDisplay
                             .set_scalefactor(p().geometryscale)
                            .set_geometry(w.second.file)
                            .set_name(w.first)
+                       );
+
+            // extract from the same triangulation,
+            // which is written into the STL file
+            auto feat=surfaceFeatureExtract(geom->triangulation(), 30.);
+
+            shm_cfg.features.push_back(
+                snappyHexMeshFeats::FeaturePtr(
+                    new snappyHexMeshFeats::ExplicitFeatureCurve(
+                        snappyHexMeshFeats::ExplicitFeatureCurve::Parameters()
+                            .set_level(maxLevel)
+                            .set_geometry(make_geometryFile(feat))
+                            .set_name(w.first+"_features")
                        )));
+
+            shm_cfg.features.push_back(geom);
         }
     }
 
@@ -83,6 +83,7 @@ void c_new_job()
     m.u.newjob.command_size = strlen(new_command) + 1; /* add null */
     m.u.newjob.wait_enqueuing = command_line.wait_enqueuing;
     m.u.newjob.num_slots = command_line.num_slots;
+    m.u.newjob.est_runtime = command_line.est_runtime;
 
     /* Send the message */
     send_msg(server_socket, &m);
@@ -673,3 +674,37 @@ void c_swap_jobs()
     return;
 }
 
+
+/* Print the state of all jobs and all subsequent state transitions,
+ * one line per event, until the server quits. */
+void c_subscribe()
+{
+    struct msg m;
+    int res;
+
+    m.type = SUBSCRIBE;
+    send_msg(server_socket, &m);
+
+    while (1)
+    {
+        res = recv_msg(server_socket, &m);
+        if(res == -1)
+            error("Error in subscribe");
+
+        if (res == 0)
+            break;
+        if(res != sizeof(m))
+            error("Error in subscribe 2");
+        if (m.type == JOB_EVENT)
+        {
+            char * buffer;
+            buffer = (char *) malloc(m.u.size);
+            recv_bytes(server_socket, buffer, m.u.size);
+            printf("%s", buffer);
+            fflush(stdout);
+            free(buffer);
+        }
+        else
+            warning("Wrong internal message in subscribe");
+    }
+}
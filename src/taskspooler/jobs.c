@@ -40,6 +40,18 @@ static struct Notify *first_notify = 0;
 
 int max_jobs;
 
+/* Scheduling statistics, reported in the list header */
+static struct
+{
+    struct timeval last_change; /* of busy_slots or max_slots */
+    double busy_slot_seconds;
+    double max_slot_seconds;
+    int started_jobs;
+    int backfilled_jobs;
+    double sum_wait;
+    double max_wait;
+} sched_stats;
+
 static struct Job * get_job(int jobid);
 void notify_errorlevel(struct Job *p);
 
@@ -191,6 +203,7 @@ int wake_hold_client()
     if (p)
     {
         p->state = QUEUED;
+        s_notify_job_event(p, "queued");
         return p->jobid;
     }
     return -1;
@@ -329,6 +342,8 @@ int s_newjob(int s, struct msg *m)
     else
         p->state = HOLDING_CLIENT;
     p->num_slots = m->u.newjob.num_slots;
+    p->est_runtime = m->u.newjob.est_runtime;
+    p->backfilled = 0;
     p->store_output = m->u.newjob.store_output;
     p->should_keep_finished = m->u.newjob.should_keep_finished;
     p->notify_errorlevel_to = 0;
@@ -462,6 +477,9 @@ int s_newjob(int s, struct msg *m)
         free(ptr);
     }
 
+    if (p->state == QUEUED)
+        s_notify_job_event(p, "queued");
+
     return p->jobid;
 }
 
@@ -472,6 +490,10 @@ void s_removejob(int jobid)
     struct Job *p;
     struct Job *newnext;
 
+    p = findjob(jobid);
+    if (p != 0)
+        s_notify_job_event(p, "removed");
+
     if (firstjob->jobid == jobid)
     {
         struct Job *newfirst;
@@ -505,10 +527,197 @@ void s_removejob(int jobid)
     p->next = newnext;
 }
 
-/* -1 if no one should be run. */
+static double timeval2double(const struct timeval *t)
+{
+    return t->tv_sec + 1e-6 * t->tv_usec;
+}
+
+static double now_seconds()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return timeval2double(&t);
+}
+
+/* Integrate the busy and the available slots over time.
+ * To be called before busy_slots or max_slots change. */
+static void account_slots()
+{
+    struct timeval now;
+    double dt;
+
+    gettimeofday(&now, 0);
+    if (sched_stats.last_change.tv_sec != 0)
+    {
+        dt = timeval2double(&now) - timeval2double(&sched_stats.last_change);
+        sched_stats.busy_slot_seconds += dt * busy_slots;
+        sched_stats.max_slot_seconds += dt * max_slots;
+    }
+    sched_stats.last_change = now;
+}
+
+/* Returns a line with the scheduling statistics. Has to be freed. */
+char * sched_stats_string()
+{
+    char *line;
+    double util = 0.;
+    double mean_wait = 0.;
+
+    account_slots();
+    if (sched_stats.max_slot_seconds > 0.)
+        util = 100. * sched_stats.busy_slot_seconds / sched_stats.max_slot_seconds;
+    if (sched_stats.started_jobs > 0)
+        mean_wait = sched_stats.sum_wait / sched_stats.started_jobs;
+
+    line = malloc(100);
+    snprintf(line, 100, "util=%.0f%% wait=%.0f/%.0fs backfill=%i/%i",
+            util,
+            mean_wait,
+            sched_stats.max_wait,
+            sched_stats.backfilled_jobs,
+            sched_stats.started_jobs);
+
+    return line;
+}
+
+/* A queued job may not run before the job it depends on has finished */
+static int dependency_satisfied(const struct Job *p)
+{
+    if (p->depend_on >= 0)
+    {
+        struct Job *do_depend_job = get_job(p->depend_on);
+        if (do_depend_job != NULL &&
+            (do_depend_job->state == QUEUED || do_depend_job->state == RUNNING))
+            return 0;
+    }
+    return 1;
+}
+
+/* Expected end of a running job, -1 if unknown (no estimate given) */
+static double expected_end_time(const struct Job *p, double now)
+{
+    double start;
+
+    if (p->est_runtime <= 0)
+        return -1;
+
+    start = timeval2double(&p->info.start_time);
+    if (start <= 0)
+        start = now; /* runjob_ok not yet received */
+
+    /* Overdue jobs are expected to end any moment */
+    if (start + p->est_runtime < now)
+        return now;
+
+    return start + p->est_runtime;
+}
+
+struct RunningSlots
+{
+    double end;
+    int slots;
+};
+
+static int compare_running_slots(const void *a, const void *b)
+{
+    const struct RunningSlots *ra = a;
+    const struct RunningSlots *rb = b;
+
+    /* unknown end times last */
+    if (ra->end < 0 && rb->end < 0)
+        return 0;
+    if (ra->end < 0)
+        return 1;
+    if (rb->end < 0)
+        return -1;
+    return (ra->end > rb->end) - (ra->end < rb->end);
+}
+
+/* Determine the reservation for a job which does not fit into the free slots:
+ * the shadow time is the earliest time, at which enough slots will be free
+ * (-1 if unknown), the extra slots are those not needed by the job
+ * at the shadow time. */
+static void compute_reservation(const struct Job *head, int free_slots,
+        double now, double *shadow_time, int *extra_slots)
+{
+    struct Job *p;
+    struct RunningSlots *running;
+    int nrunning = 0;
+    int avail = free_slots;
+    int i;
+
+    *shadow_time = -1;
+    *extra_slots = 0;
+
+    for(p = firstjob; p != 0; p = p->next)
+        if (p->state == RUNNING)
+            ++nrunning;
+
+    if (nrunning == 0)
+        return;
+
+    running = (struct RunningSlots *) malloc(nrunning * sizeof(*running));
+    if (running == 0)
+        error("Cannot allocate memory for the reservation of jobid %i",
+                head->jobid);
+
+    i = 0;
+    for(p = firstjob; p != 0; p = p->next)
+        if (p->state == RUNNING)
+        {
+            running[i].end = expected_end_time(p, now);
+            running[i].slots = p->num_slots;
+            ++i;
+        }
+
+    qsort(running, nrunning, sizeof(*running), compare_running_slots);
+
+    for(i = 0; i < nrunning; ++i)
+    {
+        avail += running[i].slots;
+        if (avail >= head->num_slots)
+        {
+            *shadow_time = running[i].end;
+            *extra_slots = avail - head->num_slots;
+            break;
+        }
+    }
+
+    free(running);
+}
+
+static void start_job(struct Job *p, double now, int backfilled)
+{
+    double wait;
+
+    account_slots();
+    busy_slots = busy_slots + p->num_slots;
+
+    p->backfilled = backfilled;
+
+    wait = now - timeval2double(&p->info.enqueue_time);
+    sched_stats.started_jobs++;
+    sched_stats.sum_wait += wait;
+    if (wait > sched_stats.max_wait)
+        sched_stats.max_wait = wait;
+    if (backfilled)
+        sched_stats.backfilled_jobs++;
+}
+
+/* -1 if no one should be run.
+ *
+ * EASY backfilling: the first runnable queued job is started, if it fits into
+ * the free slots. Otherwise it gets a reservation at the time, when enough
+ * running jobs will have finished according to their run time estimates.
+ * Later jobs may then only be started, if they finish before that time, or if
+ * they use only slots not needed by the reserved job. */
 int next_run_job()
 {
     struct Job *p;
+    struct Job *head = 0;
+    double now;
+    double shadow_time = -1;
+    int extra_slots = 0;
 
     const int free_slots = max_slots - busy_slots;
 
@@ -522,33 +731,47 @@ int next_run_job()
     if (firstjob == 0)
         return -1;
 
+    now = now_seconds();
+
     /* Look for a runnable task */
-    p = firstjob;
-    while(p != 0)
+    for(p = firstjob; p != 0; p = p->next)
     {
-        if (p->state == QUEUED)
-        {
-            if (p->depend_on >= 0)
-            {
-                struct Job *do_depend_job = get_job(p->depend_on);
-                /* We won't try to run any job do_depending on an unfinished
-                 * job */
-                if (do_depend_job != NULL &&
-                    (do_depend_job->state == QUEUED || do_depend_job->state == RUNNING))
-                {
-                    /* Next try */
-                    p = p->next;
-                    continue;
-                }
-            }
+        if (p->state != QUEUED)
+            continue;
 
+        /* We won't try to run any job do_depending on an unfinished
+         * job */
+        if (!dependency_satisfied(p))
+            continue;
+
+        if (head == 0)
+        {
             if (free_slots >= p->num_slots)
             {
-                busy_slots = busy_slots + p->num_slots;
+                start_job(p, now, 0);
                 return p->jobid;
             }
+
+            /* A job needing more than all slots would block the queue forever */
+            if (p->num_slots > max_slots)
+                continue;
+
+            head = p;
+            compute_reservation(head, free_slots, now,
+                    &shadow_time, &extra_slots);
+            continue;
+        }
+
+        if (free_slots < p->num_slots)
+            continue;
+
+        if ( (p->est_runtime > 0 && shadow_time >= 0
+                    && now + p->est_runtime <= shadow_time)
+                || p->num_slots <= extra_slots )
+        {
+            start_job(p, now, 1);
+            return p->jobid;
         }
-        p = p->next;
     }
 
     return -1;
@@ -660,7 +883,10 @@ void job_finished(const struct Result *result, int jobid)
      * we call this to clean up the jobs list in case of the client closing the
      * connection. */
     if (p->state == RUNNING)
+    {
+        account_slots();
         busy_slots = busy_slots - p->num_slots;
+    }
 
     /* Mark state */
     if (result->skipped)
@@ -677,6 +903,8 @@ void job_finished(const struct Result *result, int jobid)
     else
         pinfo_addinfo(&p->info, 100, "Exit status: died with exit code %i\n", p->result.errorlevel);
 
+    s_notify_job_event(p, jstate2string(p->state));
+
     /* Find the pointing node, to
      * update it removing the finished job. */
     {
@@ -748,6 +976,8 @@ void s_process_runjob_ok(int jobid, char *oname, int pid)
     p->pid = pid;
     p->output_filename = oname;
     pinfo_set_start_time(&p->info);
+
+    s_notify_job_event(p, "running");
 }
 
 void s_send_runjob(int s, int jobid)
@@ -831,8 +1061,18 @@ void s_job_info(int s, int jobid)
     write(s, p->command, strlen(p->command));
     fd_nprintf(s, 100, "\n");
     fd_nprintf(s, 100, "Slots required: %i\n", p->num_slots);
+    if (p->est_runtime > 0)
+        fd_nprintf(s, 100, "Estimated run time: %is\n", p->est_runtime);
     fd_nprintf(s, 100, "Enqueue time: %s",
             ctime(&p->info.enqueue_time.tv_sec));
+    if ((p->state == RUNNING || p->state == FINISHED)
+            && p->info.start_time.tv_sec != 0)
+    {
+        fd_nprintf(s, 100, "Time waited in queue: %fs%s\n",
+                timeval2double(&p->info.start_time)
+                    - timeval2double(&p->info.enqueue_time),
+                p->backfilled ? " (backfilled)" : "");
+    }
     if (p->state == RUNNING)
     {
         fd_nprintf(s, 100, "Start time: %s",
@@ -1028,6 +1268,8 @@ int s_remove_job(int s, int *jobid)
     /* Notify the clients in wait_job */
     check_notify_list(m.u.jobid);
 
+    s_notify_job_event(p, "removed");
+
     /* Update the list pointers */
     if (p == first_finished_job)
         first_finished_job = p->next;
@@ -1308,7 +1550,10 @@ void s_wait_running_job(int s, int jobid)
 void s_set_max_slots(int new_max_slots)
 {
     if (new_max_slots > 0)
+    {
+        account_slots();
         max_slots = new_max_slots;
+    }
     else
         warning("Received new_max_slots=%i", new_max_slots);
 }
@@ -1395,6 +1640,36 @@ void s_swap_jobs(int s, int jobid1, int jobid2)
     send_swap_jobs_ok(s);
 }
 
+/* Send the current state of all jobs to a new subscriber.
+ * Subsequent state transitions are sent by s_notify_job_event(). */
+void s_subscribe(int s)
+{
+    struct Job *p;
+    struct msg m;
+    char *buffer;
+    int i;
+    struct Job *lists[2];
+
+    lists[0] = first_finished_job;
+    lists[1] = firstjob;
+
+    for(i = 0; i < 2; ++i)
+        for(p = lists[i]; p != 0; p = p->next)
+        {
+            if (p->state == HOLDING_CLIENT)
+                continue;
+
+            buffer = job_event_line(p, jstate2string(p->state));
+
+            m.type = JOB_EVENT;
+            m.u.size = strlen(buffer) + 1;
+            send_msg(s, &m);
+            send_bytes(s, buffer, m.u.size);
+
+            free(buffer);
+        }
+}
+
 static void send_state(int s, enum Jobstate state)
 {
     struct msg m;
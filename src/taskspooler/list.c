@@ -33,9 +33,12 @@ char * joblistdump_headers()
 char * joblist_headers()
 {
     char * line;
+    char * stats;
 
-    line = malloc(100);
-    snprintf(line, 100, "%-4s %-10s %-20s %-8s %-14s %s [run=%i/%i]\n",
+    stats = sched_stats_string();
+
+    line = malloc(200);
+    snprintf(line, 200, "%-4s %-10s %-20s %-8s %-14s %s [run=%i/%i %s]\n",
             "ID",
             "State",
             "Output",
@@ -43,7 +46,10 @@ char * joblist_headers()
             "Times(r/u/s)",
             "Command",
             busy_slots,
-            max_slots);
+            max_slots,
+            stats);
+
+    free(stats);
 
     return line;
 }
@@ -207,3 +213,62 @@ char * joblist_line(const struct Job *p)
 }
 
 
+
+/* One line describing a job state transition, sent to subscribers:
+ * <id> <event> <errorlevel> <queue wait s> <run time s> <len>:<output> <command>
+ * The output file name is length-prefixed and the command is the rest of
+ * the line, so both may contain spaces. No output file gives "0:". */
+char * job_event_line(const struct Job *p, const char *event)
+{
+    char * line;
+    int maxlen;
+    const char * output_filename = "";
+    int errorlevel = -1;
+    float wait = 0.;
+    float run = 0.;
+    struct timeval now;
+
+    gettimeofday(&now, 0);
+
+    if (p->info.start_time.tv_sec != 0)
+    {
+        wait = p->info.start_time.tv_sec - p->info.enqueue_time.tv_sec;
+        wait += (float) (p->info.start_time.tv_usec
+                - p->info.enqueue_time.tv_usec) / 1000000.;
+    }
+    else if (p->info.enqueue_time.tv_sec != 0)
+    {
+        wait = now.tv_sec - p->info.enqueue_time.tv_sec;
+        wait += (float) (now.tv_usec - p->info.enqueue_time.tv_usec) / 1000000.;
+    }
+
+    if (p->state == FINISHED || p->state == SKIPPED)
+    {
+        errorlevel = p->result.errorlevel;
+        run = p->result.real_ms;
+    }
+    else if (p->state == RUNNING && p->info.start_time.tv_sec != 0)
+        run = pinfo_time_until_now(&p->info);
+
+    if (p->store_output && p->output_filename != 0)
+        output_filename = p->output_filename;
+
+    maxlen = 4 + 1 + 10 + 1 + 8 + 2*(14 + 1) + 10 + 1 + strlen(output_filename) + 1
+        + strlen(p->command) + 20; /* 20 is the margin for errors */
+
+    line = (char *) malloc(maxlen);
+    if (line == NULL)
+        error("Malloc for %i failed.\n", maxlen);
+
+    snprintf(line, maxlen, "%i %s %i %0.2f %0.2f %i:%s %s\n",
+            p->jobid,
+            event,
+            errorlevel,
+            wait,
+            run,
+            (int) strlen(output_filename),
+            output_filename,
+            p->command);
+
+    return line;
+}
@@ -45,6 +45,7 @@ static void default_command_line()
     command_line.wait_enqueuing = 1;
     command_line.stderr_apart = 0;
     command_line.num_slots = 1;
+    command_line.est_runtime = 0;
 }
 
 void get_command(int index, int argc, char **argv)
@@ -84,7 +85,7 @@ void parse_opts(int argc, char **argv)
 
     /* Parse options */
     while(1) {
-        c = getopt(argc, argv, ":VhKgClnfmBEr:t:c:o:p:w:k:u:s:U:i:N:L:dS:D:");
+        c = getopt(argc, argv, ":VhKgClnfmBEMr:t:c:o:p:w:k:u:s:U:i:N:L:dS:D:T:");
 
         if (c == -1)
             break;
@@ -102,6 +103,9 @@ void parse_opts(int argc, char **argv)
             case 'l':
                 command_line.request = c_LIST;
                 break;
+            case 'M':
+                command_line.request = c_SUBSCRIBE;
+                break;
             case 'h':
                 command_line.request = c_SHOW_HELP;
                 break;
@@ -155,6 +159,11 @@ void parse_opts(int argc, char **argv)
                 if (command_line.num_slots < 0)
                     command_line.num_slots = 0;
                 break;
+            case 'T':
+                command_line.est_runtime = atoi(optarg);
+                if (command_line.est_runtime < 0)
+                    command_line.est_runtime = 0;
+                break;
             case 'r':
                 command_line.request = c_REMOVEJOB;
                 command_line.jobid = atoi(optarg);
@@ -335,7 +344,7 @@ static void go_background()
 
 static void print_help(const char *cmd)
 {
-    printf("usage: %s [action] [-ngfmdE] [-L <lab>] [-D <id>] [cmd...]\n", cmd);
+    printf("usage: %s [action] [-ngfmdE] [-L <lab>] [-D <id>] [-N <num>] [-T <sec>] [cmd...]\n", cmd);
     printf("Env vars:\n");
     printf("  TS_SOCKET  the path to the unix socket used by the ts command.\n");
     printf("  TS_MAILTO  where to mail the result (on -m). Local user by default.\n");
@@ -350,6 +359,7 @@ static void print_help(const char *cmd)
     printf("  -K       kill the task spooler server\n");
     printf("  -C       clear the list of finished jobs\n");
     printf("  -l       show the job list (default action)\n");
+    printf("  -M       print the state of all jobs, then every state change as it happens.\n");
     printf("  -S [num] get/set the number of max simultaneous jobs of the server.\n");
     printf("  -t [id]  \"tail -n 10 -f\" the output of the job. Last run if not specified.\n");
     printf("  -c [id]  like -t, but shows all the lines. Last run if not specified.\n");
@@ -375,6 +385,8 @@ static void print_help(const char *cmd)
     printf("  -D <id>  the job will be run only if the job of given id ends well.\n");
     printf("  -L <lab> name this task with a label, to be distinguished on listing.\n");
     printf("  -N <num> number of slots required by the job (1 default).\n");
+    printf("  -T <sec> estimated run time of the job. Allows starting it ahead of\n");
+    printf("           a waiting job which needs more slots, if that is not delayed.\n");
 }
 
 static void print_version()
@@ -457,6 +469,11 @@ int main(int argc, char **argv)
         c_list_jobs();
         c_wait_server_lines();
         break;
+    case c_SUBSCRIBE:
+        if (!command_line.need_server)
+            error("The command %i needs the server", command_line.request);
+        c_subscribe();
+        break;
     case c_KILL_SERVER:
         if (!command_line.need_server)
             error("The command %i needs the server", command_line.request);
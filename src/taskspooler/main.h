@@ -10,7 +10,7 @@
 enum
 {
     CMD_LEN=500,
-    PROTOCOL_VERSION=730
+    PROTOCOL_VERSION=732
 };
 
 enum msg_types
@@ -44,7 +44,9 @@ enum msg_types
     GET_MAX_SLOTS_OK,
     GET_VERSION,
     VERSION,
-    NEWJOB_NOK
+    NEWJOB_NOK,
+    SUBSCRIBE,
+    JOB_EVENT
 };
 
 enum Request
@@ -67,7 +69,8 @@ enum Request
     c_INFO,
     c_SET_MAX_SLOTS,
     c_GET_MAX_SLOTS,
-    c_KILL_JOB
+    c_KILL_JOB,
+    c_SUBSCRIBE
 };
 
 struct Command_line {
@@ -92,6 +95,7 @@ struct Command_line {
     } command;
     char *label;
     int num_slots; /* Slots for the job to use. Default 1 */
+    int est_runtime; /* Estimated run time in seconds. 0 means unknown */
 };
 
 enum Process_type {
@@ -142,6 +146,7 @@ struct msg
             int depend_on; /* -1 means depend on previous */
             int wait_enqueuing;
             int num_slots;
+            int est_runtime;
         } newjob;
         struct {
             int ofilename_size;
@@ -191,6 +196,8 @@ struct Job
     char *label;
     struct Procinfo info;
     int num_slots;
+    int est_runtime; /* seconds, 0 if unknown */
+    int backfilled; /* started ahead of the reserved job */
 };
 
 enum ExitCodes
@@ -227,6 +234,7 @@ char *build_command_string();
 void c_send_max_slots(int max_slots);
 void c_get_max_slots();
 void c_check_version();
+void c_subscribe();
 
 /* jobs.c */
 void s_list(int s);
@@ -258,10 +266,13 @@ void s_get_max_slots(int s);
 int job_is_running(int jobid);
 int job_is_holding_client(int jobid);
 int wake_hold_client();
+char * sched_stats_string();
+void s_subscribe(int s);
 
 /* server.c */
 void server_main(int notify_fd, char *_path);
 void dump_conns_struct(FILE *out);
+void s_notify_job_event(const struct Job *p, const char *event);
 
 /* server_start.c */
 int try_connect(int s);
@@ -310,6 +321,7 @@ void warning_msg(const struct msg *m, const char *str, ...);
 char * joblist_headers();
 char * joblist_line(const struct Job *p);
 char * joblistdump_headers();
+char * job_event_line(const struct Job *p, const char *event);
 
 /* print.c */
 int fd_nprintf(int fd, int maxsize, const char *fmt, ...);
@@ -52,6 +52,7 @@ struct Client_conn
     int socket;
     int hasjob;
     int jobid;
+    int subscribed; /* receives JOB_EVENT messages */
 };
 
 /* Globals */
@@ -267,6 +268,7 @@ static void server_loop(int ls)
             if (cs == -1)
                 error("Accepting from %i", ls);
             client_cs[nconnections].hasjob = 0;
+            client_cs[nconnections].subscribed = 0;
             client_cs[nconnections].socket = cs;
             ++nconnections;
         }
@@ -509,6 +511,11 @@ static enum Break
             s_send_version(s);
             break;
 
+        case SUBSCRIBE:
+            s_subscribe(s);
+            client_cs[index].subscribed = 1;
+            break;
+
         default:
             /* Command not supported */
             /* On unknown message, we close the client,
@@ -566,12 +573,63 @@ static void s_newjob_nok(int index)
     send_msg(s, &m);
 }
 
+/* Send without blocking the server loop. Returns 0 on failure. */
+static int send_nonblocking(int fd, const char *data, int bytes)
+{
+    int res;
+    int offset = 0;
+
+    while(bytes > 0)
+    {
+        res = send(fd, data + offset, bytes, MSG_DONTWAIT);
+        if (res <= 0)
+            return 0;
+        offset += res;
+        bytes -= res;
+    }
+    return 1;
+}
+
+/* Send a job state transition to all subscribed clients.
+ * A subscriber which does not keep up is dropped. */
+void s_notify_job_event(const struct Job *p, const char *event)
+{
+    int i;
+    struct msg m;
+    char *buffer = 0;
+
+    for(i=0; i < nconnections; ++i)
+    {
+        if (!client_cs[i].subscribed)
+            continue;
+
+        if (buffer == 0)
+        {
+            buffer = job_event_line(p, event);
+            m.type = JOB_EVENT;
+            m.u.size = strlen(buffer) + 1;
+        }
+
+        if (!send_nonblocking(client_cs[i].socket, (const char *) &m, sizeof(m))
+                || !send_nonblocking(client_cs[i].socket, buffer, m.u.size))
+        {
+            warning("Dropping subscriber on socket %i", client_cs[i].socket);
+            client_cs[i].subscribed = 0;
+            /* the server loop will see the end of connection and remove it */
+            shutdown(client_cs[i].socket, SHUT_RDWR);
+        }
+    }
+
+    free(buffer);
+}
+
 static void dump_conn_struct(FILE *out, const struct Client_conn *p)
 {
     fprintf(out, "  new_conn\n");
     fprintf(out, "    socket %i\n", p->socket);
     fprintf(out, "    hasjob \"%i\"\n", p->hasjob);
     fprintf(out, "    jobid %i\n", p->jobid);
+    fprintf(out, "    subscribed %i\n", p->subscribed);
 }
 
 void dump_conns_struct(FILE *out)
@@ -180,7 +180,7 @@ void SynchronisedAnalysisQueue::enqueue ( AnalysisInstance&& data )
     // Add the data to the queue
     m_queue.push ( std::move(data) );
     // Notify others that data is ready
-    m_cond.notify_one();
+    m_cond.notify_all();
 }
 
 
@@ -207,10 +207,60 @@ AnalysisInstance SynchronisedAnalysisQueue::dequeue()
 
 
 
+bool SynchronisedAnalysisQueue::dequeue ( AnalysisInstance& data )
+{
+    boost::unique_lock<boost::mutex> lock ( m_mutex );
+
+    while ( m_queue.size() ==0 && !closed_ )
+    {
+        m_cond.wait ( lock );
+    }
+
+    if ( m_queue.size() ==0 )
+        return false;
+
+    data = std::move(m_queue.front());
+    m_queue.pop();
+    return true;
+}
+
+
+
+void SynchronisedAnalysisQueue::close()
+{
+    boost::unique_lock<boost::mutex> lock ( m_mutex );
+    closed_ = true;
+    m_cond.notify_all();
+}
+
+
+
 void SynchronisedAnalysisQueue::storeProcessed(
     AnalysisInstance &&processedInstance)
 {
+    boost::unique_lock<boost::mutex> lock ( m_mutex );
     processed_.push_back(std::move(processedInstance));
+    m_cond.notify_all();
+}
+
+
+
+size_t SynchronisedAnalysisQueue::waitForProcessed(
+    size_t n,
+    const std::function<void(const AnalysisInstance&)>& visit )
+{
+    boost::unique_lock<boost::mutex> lock ( m_mutex );
+
+    while ( processed_.size() <= n )
+    {
+        m_cond.wait ( lock );
+    }
+
+    for (size_t i=n; i<processed_.size(); ++i)
+    {
+        visit(processed_[i]);
+    }
+    return processed_.size();
 }
 
 void SynchronisedAnalysisQueue::cancelAll()
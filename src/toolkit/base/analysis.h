@@ -36,6 +36,7 @@
 #include "base/progressdisplayer/textprogressdisplayer.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <queue>
@@ -294,6 +295,7 @@ private:
     boost::mutex m_mutex; // The mutex to synchronise on
     boost::condition_variable m_cond; // The condition to wait for
     AnalysisInstanceList processed_;
+    bool closed_ = false;
 
 public:
 
@@ -303,8 +305,22 @@ public:
     // Get data from the queue. Wait for data if not available
     AnalysisInstance dequeue();
 
+    // Get data from the queue. Wait for data until the queue is closed.
+    // Returns false, if the queue is closed and empty.
+    bool dequeue ( AnalysisInstance& data );
+
+    // No further data will be enqueued, release waiting consumers
+    void close();
+
     void storeProcessed(AnalysisInstance&& processedInstance);
 
+    // Wait until more than n instances have been processed.
+    // The newly processed instances are passed to visit (while the queue is locked).
+    // Returns the number of processed instances.
+    size_t waitForProcessed(
+        size_t n,
+        const std::function<void(const AnalysisInstance&)>& visit );
+
     inline size_t n_instances() const
     {
         return m_queue.size();
@@ -314,6 +330,7 @@ public:
     {
         m_queue=std::queue<AnalysisInstance>();
         processed_.clear();
+        closed_=false;
     }
 
     inline bool isEmpty()
@@ -133,10 +133,9 @@ void AnalysisWorkerThread::operator() ()
 
   try
   {
-    while ( !queue_->isEmpty() )
+    AnalysisInstance ai;
+    while ( queue_->dequeue(ai) )
     {
-      AnalysisInstance ai = queue_->dequeue();
-
       // run analysis and transfer results into given ResultSet object
       PrefixedProgressDisplayer pd(displayer_, ai.name,
                                    PrefixedProgressDisplayer::Prefixed,
@@ -146,21 +145,18 @@ void AnalysisWorkerThread::operator() ()
       {
         auto& analysis= *(ai.analysis);
 
-          std::cout<<"name "<<ai.name<<std::endl;
         auto result = analysis(pd);
 
         ai.results=std::move(result);
       }
       catch ( std::exception& e )
       {
-          std::cout<<"name2 "<<ai.name<<std::endl;
-        // ai.exception = std::current_exception();
         WarningDispatcher::getCurrent().issue(
               "An exception has occurred while processing the instance "+ai.name+" of the parameter study."
               "The analsis of this instance was not completed.\n"
               "Reason: "+e.what()
               );
-        ai.exception = std::make_exception_ptr(e);
+        ai.exception = std::current_exception();
       }
 
       queue_->storeProcessed(std::move(ai));
@@ -98,7 +98,8 @@ public:
  * Objects of this class work together with the SynchronizedAnalysisQueue.
  * The latter holds a pool of Analyses to process.
  * For each processor, an AnalysisWorkerThread object is created.
- * It grabs an Analysis form the queue, processes it and grabs the next until none is left.
+ * It grabs an Analysis form the queue, processes it and grabs the next
+ * until the queue has been closed and none is left.
  */
 class AnalysisWorkerThread
     : boost::noncopyable
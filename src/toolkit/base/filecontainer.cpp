@@ -21,6 +21,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sstream>
+#include <iomanip>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -52,6 +53,17 @@ MD5HashPtr calcBufferHash(const std::string& buffer)
 }
 
 
+std::string hexDigest(const MD5Hash& hash)
+{
+  std::ostringstream os;
+  for (auto c: hash)
+  {
+    os << std::hex << std::setw(2) << std::setfill('0') << int(c);
+  }
+  return os.str();
+}
+
+
 #ifdef WIN32
 #warning hash calculation routine not working
 #else
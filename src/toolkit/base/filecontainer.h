@@ -23,6 +23,15 @@ class PathParameter;
 typedef std::array<unsigned char, MD5_DIGEST_LENGTH> MD5Hash;
 typedef std::shared_ptr<MD5Hash> MD5HashPtr;
 
+MD5HashPtr calcBufferHash(const std::string& buffer);
+
+/**
+ * @brief hexDigest
+ * @return
+ * the hash as lower case hex string (32 characters)
+ */
+std::string hexDigest(const MD5Hash& hash);
+
 
 bool operator<(const timespec& lhs, const timespec& rhs);
 bool operator==(const timespec& lhs, const timespec& rhs);
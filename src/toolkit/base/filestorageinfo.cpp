@@ -1,5 +1,8 @@
 #include "base/filestorageinfo.h"
 
+#include <fstream>
+#include <vector>
+
 namespace insight {
 
 
@@ -31,4 +34,83 @@ FileStorageInfo::FileStorageInfo(
 
 
 
+
+namespace
+{
+
+boost::filesystem::path stampFile(const boost::filesystem::path& file)
+{
+    return file.parent_path() / ("."+file.filename().string()+".hash");
+}
+
+}
+
+
+
+
+bool generatedFileIsUpToDate(
+    const boost::filesystem::path& file,
+    const std::string& contentHash )
+{
+    auto sf=stampFile(file);
+    if (!boost::filesystem::exists(file) || !boost::filesystem::exists(sf))
+        return false;
+
+    std::string existingHash;
+    {
+        std::ifstream f(sf.string());
+        std::getline(f, existingHash);
+    }
+    if (existingHash!=contentHash)
+        return false;
+
+    boost::filesystem::last_write_time(sf, std::time(nullptr));
+    return true;
+}
+
+
+
+
+void markGeneratedFile(
+    const boost::filesystem::path& file,
+    const std::string& contentHash )
+{
+    std::ofstream f(stampFile(file).string());
+    f << contentHash << std::endl;
+}
+
+
+
+
+void removeStaleFiles(
+    const boost::filesystem::path& directory,
+    std::time_t since )
+{
+    using namespace boost::filesystem;
+
+    if (!exists(directory)) return;
+
+    std::vector<path> stale;
+    for (recursive_directory_iterator i(directory), end; i!=end; ++i)
+    {
+        const auto& f = i->path();
+        if (!is_regular_file(f)) continue;
+        if (last_write_time(f)>=since) continue;
+
+        // unchanged generated file, which was reused in this run
+        auto sf=stampFile(f);
+        if (exists(sf) && last_write_time(sf)>=since) continue;
+
+        stale.push_back(f);
+    }
+
+    for (const auto& f: stale)
+    {
+        remove(f);
+    }
+}
+
+
+
+
 } // namespace insight
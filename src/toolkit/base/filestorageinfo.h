@@ -3,6 +3,7 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
+#include <ctime>
 #include "base/hierarchicaldatafilter.h"
 
 namespace insight {
@@ -31,6 +32,12 @@ struct FileStorageInfo
 
     boost::optional<AdditionalFiles> additionalFiles;
 
+    /**
+     * number of threads, which may be used for generating the
+     * additional files of different elements concurrently
+     */
+    int nThreads = 1;
+
     FileStorageInfo();
 
     FileStorageInfo(
@@ -42,6 +49,38 @@ struct FileStorageInfo
         boost::optional<boost::filesystem::path>() );
 };
 
+
+
+
+/**
+ * @brief generatedFileIsUpToDate
+ * check, whether a generated file (e.g. a chart image) exists
+ * and was created from content with the given hash.
+ * The hash is stored in a hidden file next to the generated file.
+ * If the file is up to date, the hash file is touched
+ * to mark the file as used, see removeStaleFiles().
+ */
+bool generatedFileIsUpToDate(
+    const boost::filesystem::path& file,
+    const std::string& contentHash );
+
+/**
+ * @brief markGeneratedFile
+ * store the content hash for a generated file
+ */
+void markGeneratedFile(
+    const boost::filesystem::path& file,
+    const std::string& contentHash );
+
+/**
+ * @brief removeStaleFiles
+ * remove all files below directory, which were neither written
+ * nor found up to date by generatedFileIsUpToDate() since the given time.
+ */
+void removeStaleFiles(
+    const boost::filesystem::path& directory,
+    std::time_t since );
+
 } // namespace insight
 
 #endif // FILESTORAGEINFO_H
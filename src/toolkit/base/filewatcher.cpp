@@ -12,11 +12,21 @@ namespace insight {
 FileWatcher::FileWatcher(
     const boost::filesystem::path &filePath,
     std::function<void (const std::string &)> processLine,
-    bool async )
+    bool async,
+    std::int64_t startAtByte )
 {
-  auto tailWorker = [filePath,processLine]() {
+  auto tailWorker = [filePath,processLine,startAtByte]() {
     try {
-    auto tailjob = Job::forkExternalProcess("tail", {"-f", filePath.string()});
+    std::vector<std::string> args;
+    if (startAtByte>=0)
+    {
+      // tail counts bytes starting from 1
+      args={"-c", "+"+std::to_string(startAtByte+1)};
+    }
+    args.push_back("-f");
+    args.push_back(filePath.string());
+
+    auto tailjob = Job::forkExternalProcess("tail", args);
 
     tailjob->ios_run_with_interruption(
           [&](const std::string& line)
@@ -4,6 +4,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/thread.hpp>
 
+#include <cstdint>
+
 namespace insight {
 
 class FileWatcher
@@ -11,10 +13,16 @@ class FileWatcher
   boost::thread tailJobThread;
 
 public:
+  /**
+   * @param startAtByte
+   * if non-negative, report all lines from this byte offset on,
+   * instead of only the last few lines of the existing file content
+   */
   FileWatcher(
       const boost::filesystem::path& filePath,
       std::function<void(const std::string&)> processLine,
-      bool async=true );
+      bool async=true,
+      std::int64_t startAtByte=-1 );
 
   ~FileWatcher();
 
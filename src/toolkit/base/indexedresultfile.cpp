@@ -0,0 +1,680 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "indexedresultfile.h"
+
+#include "base/tools.h"
+#include "base/rapidxml.h"
+#include "base/parameterset.h"
+#include "base/resultelementcollection.h"
+#include "base/resultelements/numericalresult.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+using namespace boost::filesystem;
+
+
+namespace insight {
+
+
+
+
+namespace
+{
+
+const std::string indexFileSignature = "insight-result-index";
+const int indexFileVersion = 1;
+
+
+bool isCollectionType(const std::string& typeName)
+{
+    static std::mutex mtx;
+    static std::map<std::string, bool> isCollection;
+
+    std::lock_guard<std::mutex> l(mtx);
+    auto i=isCollection.find(typeName);
+    if (i==isCollection.end())
+    {
+        bool ic=false;
+        try
+        {
+            std::unique_ptr<ResultElement> re(
+                ResultElement::lookup(typeName, "", "", "") );
+            ic = bool(dynamic_cast<ResultElementCollection*>(re.get()));
+        }
+        catch (...)
+        {
+            // unknown type: will fail on access
+        }
+        i=isCollection.insert({typeName, ic}).first;
+    }
+    return i->second;
+}
+
+
+std::string decodeXMLEntities(const std::string& s)
+{
+    if (s.find('&')==std::string::npos)
+        return s;
+
+    std::string r;
+    for (size_t i=0; i<s.size(); ++i)
+    {
+        if (s[i]=='&')
+        {
+            auto j=s.find(';', i);
+            if (j!=std::string::npos)
+            {
+                auto ent=s.substr(i+1, j-i-1);
+                char c=0;
+                if (ent=="lt") c='<';
+                else if (ent=="gt") c='>';
+                else if (ent=="amp") c='&';
+                else if (ent=="quot") c='"';
+                else if (ent=="apos") c='\'';
+                else if (ent.size()>1 && ent[0]=='#')
+                {
+                    c = char( ent[1]=='x' ?
+                                  std::stoi(ent.substr(2), nullptr, 16) :
+                                  std::stoi(ent.substr(1)) );
+                }
+                if (c)
+                {
+                    r+=c;
+                    i=j;
+                    continue;
+                }
+            }
+        }
+        r+=s[i];
+    }
+    return r;
+}
+
+
+/**
+ * Minimal scanner over the XML text of a result file.
+ * It only determines the extent of the elements and reads
+ * the name attribute. Text and attribute values are skipped.
+ */
+class ResultFileScanner
+{
+    const char *beg_, *p_, *end_;
+    const boost::filesystem::path& file_;
+
+    [[noreturn]] void fail(const std::string& msg) const
+    {
+        throw insight::Exception(
+            "malformed result file %s at offset %d: %s",
+            file_.string().c_str(), int(p_-beg_), msg.c_str() );
+    }
+
+    void skipPast(const char* terminator)
+    {
+        auto n=strlen(terminator);
+        auto i=std::search(p_, end_, terminator, terminator+n);
+        if (i==end_) fail(std::string("missing ")+terminator);
+        p_=i+n;
+    }
+
+    void skipSpace()
+    {
+        while (p_<end_ && isspace(*p_)) ++p_;
+    }
+
+    std::string readName()
+    {
+        auto s=p_;
+        while (p_<end_ && !isspace(*p_) && *p_!='/' && *p_!='>' && *p_!='=')
+            ++p_;
+        return std::string(s, p_);
+    }
+
+public:
+    enum Mode { Document, Root, Container, Skip };
+
+    struct Tag
+    {
+        std::string name, nameAttribute;
+        std::streamoff begin, end;
+        bool closing=false, selfClosing=false;
+    };
+
+    ResultFileScanner(const char* data, size_t size, const boost::filesystem::path& file)
+        : beg_(data), p_(data), end_(data+size), file_(file)
+    {}
+
+    /**
+     * advance to the next start or end tag.
+     * Returns false at the end of the file.
+     */
+    bool next(Tag& t)
+    {
+        for (;;)
+        {
+            p_=static_cast<const char*>(memchr(p_, '<', end_-p_));
+            if (!p_)
+            {
+                p_=end_;
+                return false;
+            }
+
+            t.begin=p_-beg_;
+            size_t remain=end_-p_;
+            if (remain>=2 && p_[1]=='?')
+            {
+                skipPast("?>");
+            }
+            else if (remain>=4 && strncmp(p_, "<!--", 4)==0)
+            {
+                skipPast("-->");
+            }
+            else if (remain>=9 && strncmp(p_, "<![CDATA[", 9)==0)
+            {
+                skipPast("]]>");
+            }
+            else if (remain>=2 && p_[1]=='!')
+            {
+                skipPast(">");
+            }
+            else if (remain>=2 && p_[1]=='/')
+            {
+                p_+=2;
+                t.name=readName();
+                t.nameAttribute.clear();
+                t.closing=true;
+                t.selfClosing=false;
+                skipPast(">");
+                t.end=p_-beg_;
+                return true;
+            }
+            else
+            {
+                ++p_;
+                t.name=readName();
+                t.nameAttribute.clear();
+                t.closing=false;
+                t.selfClosing=false;
+                for (;;)
+                {
+                    skipSpace();
+                    if (p_>=end_) fail("unterminated tag "+t.name);
+                    if (*p_=='>')
+                    {
+                        ++p_;
+                        break;
+                    }
+                    if (*p_=='/')
+                    {
+                        skipPast(">");
+                        t.selfClosing=true;
+                        break;
+                    }
+                    auto attrName=readName();
+                    skipSpace();
+                    if (p_>=end_ || *p_!='=') fail("expected '=' after attribute "+attrName);
+                    ++p_;
+                    skipSpace();
+                    if (p_>=end_ || (*p_!='"' && *p_!='\'')) fail("expected quoted value of attribute "+attrName);
+                    char q=*p_++;
+                    auto ve=static_cast<const char*>(memchr(p_, q, end_-p_));
+                    if (!ve) fail("unterminated value of attribute "+attrName);
+                    if (attrName=="name")
+                        t.nameAttribute=decodeXMLEntities(std::string(p_, ve));
+                    p_=ve+1;
+                }
+                t.end=p_-beg_;
+                return true;
+            }
+        }
+    }
+};
+
+}
+
+
+
+
+IndexedResultFile::IndexedResultFile(
+    const boost::filesystem::path& file,
+    std::unique_ptr<ParameterSet> defaultParameters )
+  : file_(file),
+    defaultParameters_(std::move(defaultParameters))
+{
+    CurrentExceptionContext ex("opening result file %s", file.string().c_str());
+
+    insight::assertion(
+        exists(file_),
+        "result file %s does not exist!", file_.string().c_str() );
+
+    auto size=file_size(file_);
+    auto mtime=last_write_time(file_);
+
+    if (!readIndex(size, mtime))
+    {
+        buildIndex();
+        writeIndex(size, mtime);
+    }
+}
+
+
+
+
+IndexedResultFile::~IndexedResultFile()
+{}
+
+
+
+
+boost::filesystem::path IndexedResultFile::indexFilePath(
+    const boost::filesystem::path& file )
+{
+    return file.parent_path() / ("."+file.filename().string()+".index");
+}
+
+
+
+
+std::vector<std::unique_ptr<IndexedResultFile> >
+IndexedResultFile::openAll(
+    const std::vector<boost::filesystem::path>& files,
+    const ParameterSet* defaultParameters,
+    int nThreads )
+{
+    std::vector<std::unique_ptr<IndexedResultFile> > result(files.size());
+    parallelFor(
+        files.size(),
+        [&](size_t i)
+        {
+            result[i]=std::make_unique<IndexedResultFile>(
+                files[i],
+                defaultParameters ?
+                    defaultParameters->cloneAs<ParameterSet>() : nullptr );
+        },
+        nThreads );
+    return result;
+}
+
+
+
+
+void IndexedResultFile::addEntry(const std::string& path, Entry&& e)
+{
+    if (entries_.insert({path, std::move(e)}).second)
+    {
+        paths_.push_back(path);
+    }
+}
+
+
+
+
+bool IndexedResultFile::readIndex(uintmax_t fileSize, std::time_t mtime)
+{
+    std::ifstream f(indexFilePath(file_).string());
+    if (!f.good())
+        return false;
+
+    std::string sig;
+    int version;
+    uintmax_t s;
+    std::time_t t;
+    if (!(f >> sig >> version >> s >> t)
+        || sig!=indexFileSignature
+        || version!=indexFileVersion
+        || s!=fileSize || t!=mtime )
+    {
+        return false;
+    }
+
+    std::string line;
+    std::getline(f, line);
+    while (std::getline(f, line))
+    {
+        if (line.empty()) continue;
+
+        std::istringstream is(line);
+        std::string kind;
+        Entry e;
+        if (!(is >> kind >> e.begin >> e.end))
+            return false;
+
+        if (kind=="P")
+        {
+            parametersEntry_=std::make_unique<Entry>(std::move(e));
+        }
+        else if (kind=="E")
+        {
+            is >> e.type;
+            is.get();
+            std::string path;
+            std::getline(is, path);
+            if (e.type.empty() || path.empty())
+                return false;
+            addEntry(path, std::move(e));
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
+
+
+
+
+void IndexedResultFile::buildIndex()
+{
+    CurrentExceptionContext ex("indexing result file %s", file_.string().c_str());
+
+    paths_.clear();
+    entries_.clear();
+    parametersEntry_.reset();
+
+    boost::iostreams::mapped_file_source mf(file_.string());
+    ResultFileScanner scanner(mf.data(), mf.size(), file_);
+
+    struct Frame
+    {
+        ResultFileScanner::Mode mode;
+        std::string tag;
+        int entry; // index in entries, if it is a result element
+        bool isParameters;
+        std::streamoff begin;
+    };
+    std::vector<Frame> stack;
+
+    // in order of the start tags
+    std::vector<std::pair<std::string, Entry> > entries;
+
+    ResultFileScanner::Tag t;
+    while (scanner.next(t))
+    {
+        if (t.closing)
+        {
+            insight::assertion(
+                !stack.empty() && stack.back().tag==t.name,
+                "unexpected closing tag %s in result file %s",
+                t.name.c_str(), file_.string().c_str() );
+
+            auto& f=stack.back();
+            if (f.entry>=0)
+            {
+                entries[f.entry].second.end=t.end;
+            }
+            else if (f.isParameters)
+            {
+                parametersEntry_=std::make_unique<Entry>(Entry{f.tag, f.begin, t.end});
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        auto parentMode = stack.empty() ?
+                    ResultFileScanner::Document : stack.back().mode;
+
+        Frame f{ResultFileScanner::Skip, t.name, -1, false, t.begin};
+
+        switch (parentMode)
+        {
+        case ResultFileScanner::Document:
+            if (t.name=="root") f.mode=ResultFileScanner::Root;
+            break;
+
+        case ResultFileScanner::Root:
+            if (t.name=="results") f.mode=ResultFileScanner::Container;
+            else if (t.name=="parameters") f.isParameters=true;
+            break;
+
+        case ResultFileScanner::Container:
+            if (!t.nameAttribute.empty())
+            {
+                auto pe=stack.back().entry;
+                auto path = pe<0 ?
+                            t.nameAttribute : entries[pe].first+"/"+t.nameAttribute;
+                f.entry=entries.size();
+                entries.push_back({path, Entry{t.name, t.begin, t.end}});
+                if (isCollectionType(t.name))
+                    f.mode=ResultFileScanner::Container;
+            }
+            break;
+
+        case ResultFileScanner::Skip:
+            break;
+        }
+
+        if (t.selfClosing)
+        {
+            if (f.isParameters)
+            {
+                parametersEntry_=std::make_unique<Entry>(Entry{f.tag, f.begin, t.end});
+            }
+        }
+        else
+        {
+            stack.push_back(std::move(f));
+        }
+    }
+
+    insight::assertion(
+        stack.empty(),
+        "result file %s is truncated", file_.string().c_str() );
+
+    for (auto& e: entries)
+    {
+        addEntry(e.first, std::move(e.second));
+    }
+}
+
+
+
+
+void IndexedResultFile::writeIndex(uintmax_t fileSize, std::time_t mtime) const
+{
+    auto indexFile=indexFilePath(file_);
+    try
+    {
+        auto tmp=indexFile.parent_path() / unique_path(indexFile.filename().string()+".%%%%%%%%");
+        {
+            std::ofstream f(tmp.string());
+            if (!f.good()) return;
+
+            f << indexFileSignature << " " << indexFileVersion
+              << " " << fileSize << " " << mtime << "\n";
+            if (parametersEntry_)
+            {
+                f << "P " << parametersEntry_->begin << " " << parametersEntry_->end << "\n";
+            }
+            for (const auto& p: paths_)
+            {
+                const auto& e=entries_.at(p);
+                f << "E " << e.begin << " " << e.end << " " << e.type << " " << p << "\n";
+            }
+            if (!f.good())
+            {
+                f.close();
+                boost::filesystem::remove(tmp);
+                return;
+            }
+        }
+        boost::filesystem::rename(tmp, indexFile);
+    }
+    catch (...)
+    {
+        // the index is just a cache
+    }
+}
+
+
+
+
+std::string IndexedResultFile::readRange(const Entry& e) const
+{
+    std::ifstream f(file_.string(), std::ios::in|std::ios::binary);
+    f.seekg(e.begin);
+    std::string content(e.end-e.begin, '\0');
+    f.read(&content[0], content.size());
+    insight::assertion(
+        f.gcount()==std::streamsize(content.size()),
+        "could not read element from result file %s (file changed?)",
+        file_.string().c_str() );
+    return content;
+}
+
+
+
+
+const boost::filesystem::path& IndexedResultFile::fileName() const
+{
+    return file_;
+}
+
+
+
+
+const std::vector<std::string>& IndexedResultFile::contents() const
+{
+    return paths_;
+}
+
+
+
+
+bool IndexedResultFile::contains(const std::string& path) const
+{
+    return entries_.count(path)>0;
+}
+
+
+
+
+const std::string& IndexedResultFile::elementType(const std::string& path) const
+{
+    auto i=entries_.find(path);
+    if (i==entries_.end())
+    {
+        throw insight::Exception(
+            "Result %s not found in result file %s",
+            path.c_str(), file_.string().c_str() );
+    }
+    return i->second.type;
+}
+
+
+
+
+const ResultElement& IndexedResultFile::element(const std::string& path) const
+{
+    const auto& type=elementType(path);
+
+    std::lock_guard<std::mutex> l(mtx_);
+
+    auto i=loaded_.find(path);
+    if (i==loaded_.end())
+    {
+        CurrentExceptionContext ex(
+            "reading result %s from file %s",
+            path.c_str(), file_.string().c_str() );
+
+        auto xml=readRange(entries_.at(path));
+        XMLDocument doc(xml.begin(), xml.end(), type);
+        insight::assertion(
+            doc.rootNode,
+            "no node %s found", type.c_str() );
+
+        std::unique_ptr<ResultElement> re(
+            ResultElement::lookup(type, "", "", "") );
+        re->readFromNode(std::string(), *doc.rootNode);
+
+        i=loaded_.insert({path, std::move(re)}).first;
+    }
+    return *i->second;
+}
+
+
+
+
+double IndexedResultFile::getScalar(const std::string& path) const
+{
+    return get<NumericalResult<double> >(path).value();
+}
+
+
+
+
+bool IndexedResultFile::hasParameters() const
+{
+    return bool(parametersEntry_) || bool(defaultParameters_);
+}
+
+
+
+
+const ParameterSet& IndexedResultFile::parameters() const
+{
+    std::lock_guard<std::mutex> l(mtx_);
+
+    if (!parameters_)
+    {
+        if (parametersEntry_)
+        {
+            CurrentExceptionContext ex(
+                "reading input parameters from file %s", file_.string().c_str() );
+
+            auto xml=readRange(*parametersEntry_);
+            XMLDocument doc(xml.begin(), xml.end(), "parameters");
+            insight::assertion(
+                doc.rootNode,
+                "no parameters node found" );
+
+            if (defaultParameters_)
+            {
+                defaultParameters_->readFromNode(std::string(), *doc.rootNode);
+                parameters_=std::move(defaultParameters_);
+            }
+            else
+            {
+                parameters_=ParameterSet::create(*doc.rootNode);
+            }
+        }
+        else if (defaultParameters_)
+        {
+            parameters_=std::move(defaultParameters_);
+        }
+        else
+        {
+            throw insight::Exception(
+                "result file %s contains no input parameters",
+                file_.string().c_str() );
+        }
+    }
+    return *parameters_;
+}
+
+
+
+
+} // namespace insight
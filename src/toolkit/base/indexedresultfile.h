@@ -0,0 +1,174 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef INSIGHT_INDEXEDRESULTFILE_H
+#define INSIGHT_INDEXEDRESULTFILE_H
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "base/exception.h"
+#include "base/resultelement.h"
+
+namespace insight {
+
+class ParameterSet;
+
+
+
+
+/**
+ * @brief The IndexedResultFile class
+ * Read access to single elements of a result file (*.isr) without parsing
+ * the whole file.
+ *
+ * On construction, only the byte ranges of the result elements
+ * (addressed by their path, like in ResultElementCollection::get)
+ * and of the input parameters are determined. An element is parsed on its
+ * first access. Large payloads like images or embedded files are thus
+ * only decoded, if they are actually requested.
+ *
+ * The index is stored in a hidden file next to the result file
+ * (see indexFilePath()) and reused, as long as size and modification time of
+ * the result file are unchanged. If the index file cannot be written,
+ * the index is silently rebuilt on every construction.
+ *
+ * Nested ResultSets are not resolved: they are not written with a name
+ * into the result file.
+ */
+class IndexedResultFile
+{
+public:
+    struct Entry
+    {
+        std::string type;
+        std::streamoff begin, end;
+    };
+
+private:
+    boost::filesystem::path file_;
+    mutable std::unique_ptr<ParameterSet> defaultParameters_;
+
+    std::vector<std::string> paths_;
+    std::map<std::string, Entry> entries_;
+    std::unique_ptr<Entry> parametersEntry_;
+
+    mutable std::mutex mtx_;
+    mutable std::map<std::string, std::unique_ptr<ResultElement> > loaded_;
+    mutable std::unique_ptr<ParameterSet> parameters_;
+
+    bool readIndex(uintmax_t fileSize, std::time_t mtime);
+    void buildIndex();
+    void writeIndex(uintmax_t fileSize, std::time_t mtime) const;
+    void addEntry(const std::string& path, Entry&& e);
+
+    std::string readRange(const Entry& e) const;
+
+public:
+    /**
+     * @brief IndexedResultFile
+     * @param file
+     * the result file
+     * @param defaultParameters
+     * if given, the stored input parameters are read into this parameter set.
+     * Otherwise, the parameter set is created from the stored values alone.
+     */
+    IndexedResultFile(
+        const boost::filesystem::path& file,
+        std::unique_ptr<ParameterSet> defaultParameters = nullptr );
+
+    ~IndexedResultFile();
+
+    static boost::filesystem::path indexFilePath(const boost::filesystem::path& file);
+
+    /**
+     * @brief openAll
+     * open (and index, if required) a number of result files concurrently
+     * @param defaultParameters
+     * a copy of this parameter set is used for each file, if given
+     * @param nThreads
+     * number of threads (all hardware threads, if <=0)
+     */
+    static std::vector<std::unique_ptr<IndexedResultFile> > openAll(
+        const std::vector<boost::filesystem::path>& files,
+        const ParameterSet* defaultParameters = nullptr,
+        int nThreads = 0 );
+
+    const boost::filesystem::path& fileName() const;
+
+    /**
+     * @brief contents
+     * @return
+     * the paths of all result elements, including collections,
+     * in the order of appearance in the file
+     */
+    const std::vector<std::string>& contents() const;
+
+    bool contains(const std::string& path) const;
+
+    /**
+     * @brief elementType
+     * @return
+     * the type name of the element. It is known without loading the element.
+     */
+    const std::string& elementType(const std::string& path) const;
+
+    /**
+     * @brief element
+     * parse the element on first access. Thread-safe.
+     */
+    const ResultElement& element(const std::string& path) const;
+
+    template<class T>
+    const T& get(const std::string& path) const
+    {
+        if (const auto* pt = dynamic_cast<const T*>(&element(path)))
+        {
+            return *pt;
+        }
+        throw insight::Exception(
+            "Result %s in file %s is not of requested type!",
+            path.c_str(), file_.string().c_str() );
+    }
+
+    double getScalar(const std::string& path) const;
+
+    bool hasParameters() const;
+
+    /**
+     * @brief parameters
+     * parse the input parameters on first access. Thread-safe.
+     */
+    const ParameterSet& parameters() const;
+};
+
+
+
+
+} // namespace insight
+
+#endif // INSIGHT_INDEXEDRESULTFILE_H
@@ -22,8 +22,15 @@
 
 #include "latextools.h"
 
+#include <algorithm>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
 
+#include "base/filecontainer.h"
+
 #include <boost/filesystem.hpp>
 #include "base/exception.h"
 #include "boost/algorithm/string.hpp"
@@ -262,113 +269,255 @@ LaTeXReplacements::LaTeXReplacements()
   simple_replacements_.add(">", "\\textgreater ");
 }
 
-struct TemporaryCachedFile
-: public boost::filesystem::path
+/**
+ * On-disk cache of formulas, rendered into PNG images.
+ * The images are stored under the MD5 hash of formula and resolution,
+ * so that they are reused by later sessions and other processes.
+ * All formulas, which are missing in the cache, are rendered in a single
+ * LaTeX run (one page per formula) and a single dvipng call.
+ */
+class FormulaRenderCache
 {
-  TemporaryCachedFile(const std::string& extension)
-    : boost::filesystem::path
-      (
-        boost::filesystem::unique_path
-        (
-          boost::filesystem::temp_directory_path()
-          / ("html-replacement-%%%%%%%."+extension)
-        )
-       )
+  boost::filesystem::path cacheDir_;
+  size_t maxEntries_;
+  size_t nInsertedSincePrune_;
+  std::mutex mtx_;
+
+  boost::filesystem::path imageFile(const std::string& formula_code, int dpi) const
   {
+    std::string key = str(format("%d\n%s") % dpi % formula_code);
+
+    return cacheDir_ / (hexDigest(*calcBufferHash(key))+".png");
   }
 
-  ~TemporaryCachedFile()
+  /**
+   * remove the least recently used images, if the cache is too large
+   */
+  void prune()
   {
-    if (boost::filesystem::exists(*this))
-      boost::filesystem::remove(*this);
+    std::vector<std::pair<std::time_t, boost::filesystem::path> > entries;
+    for (boost::filesystem::directory_iterator i(cacheDir_), end; i!=end; ++i)
+    {
+      if (i->path().extension()==".png")
+      {
+        boost::system::error_code ec;
+        auto t = boost::filesystem::last_write_time(i->path(), ec);
+        if (!ec) entries.push_back({t, i->path()});
+      }
+    }
+
+    if (entries.size()>maxEntries_)
+    {
+      std::sort(entries.begin(), entries.end());
+      for (size_t i=0; i<entries.size()-maxEntries_; ++i)
+      {
+        boost::system::error_code ec;
+        boost::filesystem::remove(entries[i].second, ec);
+      }
+    }
+    nInsertedSincePrune_=0;
   }
-};
 
+  /**
+   * render all formulas in one LaTeX run.
+   * @return
+   * false, if the number of pages in the output does not match
+   * (e.g. because of LaTeX errors)
+   */
+  bool renderBatch(
+      const std::vector<std::string>& formulas,
+      int dpi,
+      const std::vector<boost::filesystem::path>& outputs )
+  {
+    insight::CurrentExceptionContext ex(
+        "rendering %d formulas into PNG images", int(formulas.size()) );
 
+    CaseDirectory subdir(false, boost::filesystem::temp_directory_path()/"runLatex" );
+    insight::dbg()<<"subdir: "<<subdir<<std::endl;
 
+    boost::filesystem::path tex_filename = subdir/"input.tex";
+    {
+      std::ofstream tex( tex_filename.string() );
+      tex<<
+            "\\documentclass{article}\n"
+            "\\pagestyle{empty}\n"
+            "\\begin{document}\n";
+      for (const auto& formula_code: formulas)
+      {
+        insight::dbg()<<"formula code: "<<formula_code<<std::endl;
+        tex << "\\[" << formula_code << "\\]\n"
+               "\\newpage\n";
+      }
+      tex << "\\end{document}";
+    }
 
+    boost::process::system
+    (
+       boost::process::search_path("latex"),
+       boost::process::args
+          ({
+            "-file-line-error-style",
+            "-interaction=nonstopmode",
+            tex_filename.filename().string()
+           }),
+       boost::process::std_out > boost::process::null,
+       boost::process::std_err > boost::process::null,
+       boost::process::start_dir(boost::filesystem::absolute(subdir))
+    );
+
+    boost::process::system
+    (
+       boost::process::search_path("dvipng"),
+       boost::process::args
+          ({"--freetype0",
+            "-Q", "9",
+            "-z", "3",
+            "--depth",
+            "-q",
+            "-T", "tight",
+            "-D", std::to_string(dpi),
+            "-bg", "Transparent",
+            "-o", (subdir/"formula%d.png").string(),
+            tex_filename.replace_extension(".dvi").string()
+           })
+    );
+
+    auto page = [&](size_t i) { return subdir/str(format("formula%d.png")%(i+1)); };
+
+    if ( !boost::filesystem::exists(page(formulas.size()-1))
+         || boost::filesystem::exists(page(formulas.size())) )
+    {
+      return false;
+    }
 
-typedef std::shared_ptr<TemporaryCachedFile> TemporaryCachedFilePtr;
+    for (size_t i=0; i<formulas.size(); ++i)
+    {
+      // copy and rename, so that concurrent readers never see incomplete files
+      auto tmp = boost::filesystem::unique_path(
+          outputs[i].parent_path() / (outputs[i].filename().string()+".%%%%%%") );
+      boost::filesystem::copy_file(page(i), tmp);
+      boost::filesystem::rename(tmp, outputs[i]);
+    }
+    return true;
+  }
 
-// maybe need to add some expiry duration...
-struct FilesCache
-    : std::map<std::string, TemporaryCachedFilePtr>
-{
-};
+public:
+  FormulaRenderCache()
+    : maxEntries_(5000),
+      nInsertedSincePrune_(0)
+  {
+    if (char *cd=getenv("INSIGHT_FORMULA_CACHE_DIR"))
+    {
+      cacheDir_=cd;
+    }
+    else if (char *userdir = getenv(
+#ifdef WIN32
+                "USERPROFILE"
+#else
+                "HOME"
+#endif
+                ))
+    {
+      cacheDir_=boost::filesystem::path(userdir)/".insight"/"cache"/"formulas";
+    }
+    else
+    {
+      cacheDir_=boost::filesystem::temp_directory_path()/"insight-formula-cache";
+    }
 
-void runLatex(const std::string& formula_code, const boost::filesystem::path& output)
-{
-  insight::CurrentExceptionContext ex("rendering formula into PNG image");
-
-  insight::dbg()<<"formula code: "<<formula_code<<std::endl;
-
-  CaseDirectory subdir(false, boost::filesystem::temp_directory_path()/"runLatex" );
-  insight::dbg()<<"subdir: "<<subdir<<std::endl;
-
-  boost::filesystem::path tex_filename = subdir/"input.tex";
-  std::ofstream tex( tex_filename.string() );
-  tex<<
-        "\\documentclass{article}\n"
-        "\\pagestyle{empty}\n"
-        "\\begin{document}\n"
-        "\\[" << formula_code << "\\]\n"
-        "\\newpage\n"
-        "\\end{document}"
-        ;
-  tex.close();
-
-
-  boost::process::system
-  (
-     boost::process::search_path("latex"),
-     boost::process::args
-        ({
-          "-file-line-error-style",
-          "-interaction=nonstopmode",
-          tex_filename.filename().string()
-         }),
-     boost::process::start_dir(boost::filesystem::absolute(subdir))
-  );
+    if (!boost::filesystem::exists(cacheDir_))
+    {
+      boost::filesystem::create_directories(cacheDir_);
+    }
+    prune();
+  }
 
-  boost::process::system
-  (
-     boost::process::search_path("dvipng"),
-     boost::process::args
-        ({"--freetype0",
-          "-Q", "9",
-          "-z", "3",
-          "--depth",
-          "-q",
-          "-T", "tight",
-          "-D", "150",
-          "-bg", "Transparent",
-          "-o", output.string(),
-          tex_filename.replace_extension(".dvi").string()
-         })
-  );
+  /**
+   * make sure, that all given formulas are present in the cache
+   */
+  void render(const std::vector<std::string>& formulas, int dpi)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
 
-  insight::dbg()<<"tex file: "<<tex_filename<<", output file: "<<output<<std::endl;
-}
+    std::vector<std::string> missing;
+    std::vector<boost::filesystem::path> outputs;
+    std::set<std::string> seen;
+    for (const auto& f: formulas)
+    {
+      auto img=imageFile(f, dpi);
+      if (!boost::filesystem::exists(img) && seen.insert(f).second)
+      {
+        missing.push_back(f);
+        outputs.push_back(img);
+      }
+    }
 
-struct FormulaRenderFilesCache
-: public FilesCache
-{
-  boost::filesystem::path renderLatexFormula(const std::string& formula_code)
+    if (missing.size()>0)
+    {
+      if (!renderBatch(missing, dpi, outputs))
+      {
+        // isolate the problematic formulas
+        insight::Warning(
+            "batch rendering of formulas failed, rendering them one by one" );
+        for (size_t i=0; i<missing.size(); ++i)
+        {
+          if (!renderBatch({missing[i]}, dpi, {outputs[i]}))
+          {
+            insight::Warning("could not render formula \"%s\"", missing[i].c_str());
+          }
+        }
+      }
+
+      nInsertedSincePrune_+=missing.size();
+      if (nInsertedSincePrune_ > maxEntries_/10)
+      {
+        prune();
+      }
+    }
+  }
+
+  boost::filesystem::path renderLatexFormula(const std::string& formula_code, int dpi)
   {
-    auto i=find(formula_code);
-    if (i!=end())
+    auto img=imageFile(formula_code, dpi);
+    if (boost::filesystem::exists(img))
     {
-      return *i->second;
+      // mark as recently used
+      boost::system::error_code ec;
+      boost::filesystem::last_write_time(img, std::time(nullptr), ec);
     }
     else
     {
-      TemporaryCachedFilePtr result(new TemporaryCachedFile("png"));
+      render({formula_code}, dpi);
+    }
+    return img;
+  }
 
-      runLatex(formula_code, *result);
+  static FormulaRenderCache& global()
+  {
+    static FormulaRenderCache cache;
+    return cache;
+  }
+};
 
-      insert(value_type(formula_code, result));
-      return *result;
-    }
+
+
+
+/**
+ * collects the formulas in a text
+ */
+struct FormulaCollector
+: PlainTextReplacements
+{
+  std::vector<std::string> formulas_;
+
+  void appendInlineFormula(const std::string& latex_formula) override
+  {
+    formulas_.push_back(latex_formula);
+  }
+
+  void appendDisplayFormula(const std::string& latex_formula) override
+  {
+    formulas_.push_back(latex_formula);
   }
 };
 
@@ -378,8 +527,6 @@ struct FormulaRenderFilesCache
 struct HTMLReplacements
 : Replacements
 {
-  static FormulaRenderFilesCache formulaCache;
-
   int imageWidth_;
 
   HTMLReplacements(int imageWidth);
@@ -401,7 +548,7 @@ struct HTMLReplacements
 
   void appendInlineFormula(const std::string& latex_formula) override
   {
-    auto rff = formulaCache.renderLatexFormula(latex_formula);
+    auto rff = FormulaRenderCache::global().renderLatexFormula(latex_formula, 150);
     std::string code = "<img src=\"file:///"+rff.generic_path().string()+"\">";
     insight::dbg()<<code<<std::endl;
     reformatted_ += code;
@@ -409,7 +556,7 @@ struct HTMLReplacements
 
   void appendDisplayFormula(const std::string& latex_formula) override
   {
-    auto rff = formulaCache.renderLatexFormula(latex_formula);
+    auto rff = FormulaRenderCache::global().renderLatexFormula(latex_formula, 150);
     std::string code = "<br>\n  <img src=\"file:///"+rff.generic_path().string()+"\"><br>\n";
     insight::dbg()<<code<<std::endl;
     reformatted_ += code;
@@ -426,8 +573,6 @@ struct HTMLReplacements
   }
 };
 
-FormulaRenderFilesCache HTMLReplacements::formulaCache;
-
 std::string combine(const std::vector<std::string>& strings)
 {
   return join(strings, "");
@@ -615,12 +760,28 @@ std::string SimpleLatex::toLaTeX() const
 
 std::string SimpleLatex::toHTML(int imageWidth) const
 {
+  prerenderFormulas({*this});
   HTMLReplacements rep(imageWidth);
   return reformat(simpleLatex_code_, rep);
 }
 
 
 
+void SimpleLatex::prerenderFormulas(const std::vector<SimpleLatex>& texts)
+{
+  FormulaCollector fc;
+  for (const auto& t: texts)
+  {
+    reformat(t.simpleLatex(), fc);
+  }
+  if (fc.formulas_.size()>0)
+  {
+    FormulaRenderCache::global().render(fc.formulas_, 150);
+  }
+}
+
+
+
 std::string SimpleLatex::toPlainText() const
 {
   PlainTextReplacements rep;
@@ -695,34 +856,6 @@ bool LatexRunner::run_bibtex()
 
 
 
-// Check .log for "Rerun" warnings
-bool LatexRunner::needs_rerun()
-{
-    std::string log_file = base_name + ".log";
-    std::ifstream log( (workdir/log_file).string() );
-    if (!log.is_open()) return false;
-
-    std::string line;
-    // Standard patterns that require a rerun
-    static const std::vector<boost::regex> rerun_patterns = {
-        boost::regex("Rerun to get cross-references right"),
-        boost::regex("Rerun to get outlines right"),
-        boost::regex("Rerun LaTeX"),
-        boost::regex("There were undefined references"),
-        boost::regex("Label\\(s\\) may have changed"),
-    };
-
-    while (std::getline(log, line)) {
-        for (const auto& pattern : rerun_patterns) {
-            if (boost::regex_search(line, pattern))
-                return true;
-        }
-    }
-    return false;
-}
-
-
-
 // Check .aux for \bibdata (means bibtex is needed)
 bool LatexRunner::needs_bibtex(const std::string& aux_file)
 {
@@ -739,36 +872,55 @@ bool LatexRunner::needs_bibtex(const std::string& aux_file)
 
 
 
-// Full build loop
-bool LatexRunner::build()
+std::string LatexRunner::auxiliary_content()
 {
-    std::cout << "[1] Running pdflatex..." << std::endl;
-    if (run_pdflatex() != 0)
+    std::string content;
+    for (const std::string ext: {".aux", ".out"})
     {
-        std::cerr << "pdflatex failed. Check " << base_name << ".log" << std::endl;
-        return false;
+        std::ifstream f( (workdir/(base_name+ext)).string() );
+        if (f.is_open())
+        {
+            content += std::string(
+                std::istreambuf_iterator<char>(f),
+                std::istreambuf_iterator<char>() );
+        }
     }
+    return content;
+}
+
 
-    // Run bibtex if needed (after first pdflatex pass)
-    if (run_bibtex())
-    {
-        std::cout << "[bibtex] Running bibtex..." << std::endl;
-    }
 
-    for (int i = 2; i <= max_runs; ++i)
+// Full build loop
+bool LatexRunner::build()
+{
+    // aux files of a previous build in the same directory are reused:
+    // rerun only, if pdflatex changed them
+    for (int i = 1; i <= max_runs; ++i)
     {
-        if (!needs_rerun())
-        {
-            std::cout << "Done. Stable after " << (i - 1) << " run(s)." << std::endl;
-            return true;
-        }
+        auto before = auxiliary_content();
 
-        std::cout << "[" << i << "] Rerun needed, running pdflatex..." << std::endl;
+        std::cout << "[" << i << "] Running pdflatex..." << std::endl;
         if (run_pdflatex() != 0)
         {
-            std::cerr << "pdflatex failed on run " << i << std::endl;
+            std::cerr << "pdflatex failed on run " << i
+                      << ". Check " << base_name << ".log" << std::endl;
             return false;
         }
+
+        bool changed = (auxiliary_content() != before);
+
+        // Run bibtex if needed (the citations are in the aux file)
+        if ( changed && run_bibtex() )
+        {
+            std::cout << "[bibtex] Running bibtex..." << std::endl;
+            changed = true;
+        }
+
+        if (!changed)
+        {
+            std::cout << "Done. Stable after " << i << " run(s)." << std::endl;
+            return true;
+        }
     }
 
     std::cerr << "Warning: reached max runs (" << max_runs << "), references may be unresolved." << std::endl;
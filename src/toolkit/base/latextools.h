@@ -22,6 +22,7 @@
 #define INSIGHT_LATEXTOOLS_H
 
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
 
 namespace insight 
@@ -62,7 +63,22 @@ public:
   std::string& simpleLatex();
   
   std::string toLaTeX() const;
+  /**
+   * @brief toHTML
+   * formulas are rendered into PNG images, which are
+   * kept in a persistent cache (~/.insight/cache/formulas
+   * or $INSIGHT_FORMULA_CACHE_DIR)
+   */
   std::string toHTML(int imageWidth) const;
+
+  /**
+   * @brief prerenderFormulas
+   * render the formulas of all given texts, which are not yet cached,
+   * in a single LaTeX run. Should be called before toHTML() is called
+   * on a larger number of texts.
+   */
+  static void prerenderFormulas(const std::vector<SimpleLatex>& texts);
+
   std::string toPlainText() const;
 
   bool empty() const;
@@ -90,13 +106,13 @@ struct LatexRunner
     // // Run bibtex once if .aux references a bibliography
     bool run_bibtex();
 
-    // Check .log for "Rerun" warnings
-    bool needs_rerun();
+    // Content of the .aux and .out files
+    std::string auxiliary_content();
 
     // Check .aux for \bibdata (means bibtex is needed)
     bool needs_bibtex(const std::string& aux_file);
 
-    // Full build loop
+    // Full build loop: rerun pdflatex, until the auxiliary files do not change
     bool build();
 };
 
@@ -30,6 +30,7 @@
 #include "base/cppextensions.h"
 
 #include "base/translations.h"
+#include "base/tools.h"
 
 // #include "minpack.h"
 // #include <dlib/optimization.h>
@@ -37,6 +38,7 @@
 
 #include "gsl/gsl_multiroots.h"
 
+
 #include <vtkMatrix4x4.h>
 
 
@@ -615,14 +617,47 @@ arma::mat RegressionModel::weights(const arma::mat& x) const
   return ones(x.n_rows);
 }
 
+arma::mat RegressionModel::evaluateJacobian(const arma::mat&) const
+{
+  return arma::mat();
+}
+
 double RegressionModel::computeQuality(const arma::mat& y, const arma::mat& x) const
 {
   return arma::as_scalar( weights(x).t() * pow( y - evaluateObjective(x), 2) );
 }
 
 
+double nonlinearRegressionLM(const arma::mat& y, const arma::mat& x, RegressionModel& model, double tol);
+
+
 double nonlinearRegression(const arma::mat& y, const arma::mat& x,RegressionModel& model, double tol)
 {
+    bool hasJacobian=false;
+    {
+        arma::mat p0=arma::zeros(model.numP());
+        model.setInitialValues(p0.memptr());
+        model.setParameters(p0.memptr());
+        hasJacobian = model.evaluateJacobian(x).n_elem>0;
+    }
+
+    if ( hasJacobian || model.numP()>=10 )
+    {
+        // the simplex method is slow for many parameters
+        try
+        {
+            return nonlinearRegressionLM(y, x, model, tol);
+        }
+        catch (const std::exception& e)
+        {
+            std::ostringstream os;
+            os<<"x=["<<x.t()<<"]\ty=["<<y.t()<<"]";
+            throw insight::Exception(
+                "nonlinearRegression(): Failed to do regression.\n"
+                "Supplied data: "+os.str()+"\n"+e.what() );
+        }
+    }
+
     try
     {
         const gsl_multimin_fminimizer_type *T =
@@ -1197,6 +1232,301 @@ arma::mat nonlinearSolveND(
 }
 
 
+
+namespace
+{
+
+arma::sp_mat finiteDifferenceJacobian(
+    const std::function<arma::mat(const arma::mat&)>& obj,
+    const arma::mat& x, const arma::mat& f0,
+    const arma::mat& h, int nThreads )
+{
+    arma::mat J(f0.n_elem, x.n_elem);
+    insight::parallelFor(
+        x.n_elem,
+        [&](size_t j)
+        {
+            arma::mat xp=x;
+            xp(j)+=h(j);
+            arma::mat fp=obj(xp);
+            J.col(j)=arma::vectorise(fp-f0)/h(j);
+        },
+        nThreads );
+    return arma::sp_mat(J);
+}
+
+
+arma::mat finiteDifferenceSteps(const arma::mat& x)
+{
+    return 1.5e-8*arma::clamp(arma::abs(arma::vectorise(x)), 1., arma::datum::inf);
+}
+
+
+/**
+ * Levenberg-Marquardt iteration for min |obj(x)|^2.
+ * Converged, if the sum of absolute residuals is below tol
+ * or, unless requireRoot is set, if the step becomes smaller than tol (relative).
+ */
+arma::mat levenbergMarquardt(
+    const std::function<arma::mat(const arma::mat&)>& obj,
+    const std::function<arma::sp_mat(const arma::mat& x, const arma::mat& f)>& jacobian,
+    const arma::mat& x0,
+    double tol, int nMaxIter, double relax,
+    const std::function<void(const arma::mat&)>& perIterationCallback,
+    bool requireRoot )
+{
+    arma::mat x=arma::vectorise(x0);
+    arma::mat f=arma::vectorise(obj(x));
+    double Q=arma::dot(f, f);
+    double lambda=1e-3;
+
+    for (int iter=0; iter<nMaxIter; ++iter)
+    {
+        if (arma::accu(arma::abs(f))<tol)
+            return x;
+
+        arma::sp_mat J=jacobian(x, f);
+        insight::assertion(
+            J.n_rows==f.n_elem && J.n_cols==x.n_elem,
+            "Jacobian has wrong size (expected %dx%d, got %dx%d)",
+            f.n_elem, x.n_elem, J.n_rows, J.n_cols );
+
+        arma::mat A(J.t()*J);
+        arma::mat g(J.t()*f);
+        arma::mat D=arma::diagmat(arma::clamp(A.diag(), 1e-12, arma::datum::inf));
+
+        bool accepted=false;
+        while (!accepted && lambda<1e16)
+        {
+            arma::mat dx;
+            if (arma::solve(dx, A+lambda*D, -g, arma::solve_opts::no_approx))
+            {
+                arma::mat xn=x+relax*dx;
+                arma::mat fn=arma::vectorise(obj(xn));
+                double Qn=arma::dot(fn, fn);
+                if (Qn<Q)
+                {
+                    bool smallStep =
+                        arma::norm(xn-x, 2) < tol*(arma::norm(x, 2)+tol);
+                    x=xn; f=fn; Q=Qn;
+                    lambda=std::max(0.1*lambda, 1e-12);
+                    accepted=true;
+
+                    if (perIterationCallback)
+                        perIterationCallback(x);
+
+                    if (smallStep && !requireRoot)
+                        return x;
+                }
+            }
+            if (!accepted)
+                lambda*=10.;
+        }
+
+        if (!accepted)
+        {
+            // no further reduction possible: local minimum
+            if (requireRoot && !(arma::accu(arma::abs(f))<tol))
+                throw insight::NonConvergenceException(iter);
+            return x;
+        }
+    }
+
+    if (requireRoot && !(arma::accu(arma::abs(f))<tol))
+        throw insight::NonConvergenceException(nMaxIter);
+
+    return x;
+}
+
+
+}
+
+
+
+
+arma::mat nonlinearSolveND(
+    std::function<arma::mat(const arma::mat& x)> obj,
+    const JacobianFunction& jacobian,
+    const arma::mat& x0,
+    double tol, int nMaxIter, double relax,
+    std::function<void(const arma::mat&)> perIterationCallback,
+    int nThreads )
+{
+    return levenbergMarquardt(
+        obj,
+        [&](const arma::mat& x, const arma::mat& f) -> arma::sp_mat
+        {
+            if (jacobian)
+                return jacobian(x);
+            else
+                return finiteDifferenceJacobian(
+                    obj, x, f, finiteDifferenceSteps(x), nThreads );
+        },
+        x0, tol, nMaxIter, relax,
+        perIterationCallback, true );
+}
+
+
+
+
+arma::mat nonlinearLeastSquaresND(
+    std::function<arma::mat(const arma::mat& x)> obj,
+    const JacobianFunction& jacobian,
+    const arma::mat& x0,
+    double tol, int nMaxIter,
+    int nThreads )
+{
+    return levenbergMarquardt(
+        obj,
+        [&](const arma::mat& x, const arma::mat& f) -> arma::sp_mat
+        {
+            if (jacobian)
+                return jacobian(x);
+            else
+                return finiteDifferenceJacobian(
+                    obj, x, f, finiteDifferenceSteps(x), nThreads );
+        },
+        x0, tol, nMaxIter, 1.0,
+        std::function<void(const arma::mat&)>(), false );
+}
+
+
+
+
+arma::mat nonlinearMinimizeND(
+    const std::function<double(const arma::mat&)>& model,
+    const GradientFunction& gradient,
+    const arma::mat& x0,
+    double tol, int nMaxIter,
+    int nThreads )
+{
+    const int n=x0.n_elem;
+
+    auto grad = [&](const arma::mat& x) -> arma::mat
+    {
+        if (gradient)
+            return arma::vectorise(gradient(x));
+
+        // central differences
+        arma::mat h=std::pow(arma::datum::eps, 1./3.)
+                    *arma::clamp(arma::abs(x), 1., arma::datum::inf);
+        arma::mat fd(n, 2);
+        insight::parallelFor(
+            2*n,
+            [&](size_t k)
+            {
+                int j=k/2;
+                arma::mat xp=x;
+                xp(j)+= (k%2==0 ? h(j) : -h(j));
+                fd(j, k%2)=model(xp);
+            },
+            nThreads );
+        return (fd.col(0)-fd.col(1))/(2.*h);
+    };
+
+    arma::mat x=arma::vectorise(x0);
+    double fx=model(x);
+    arma::mat g=grad(x);
+    arma::mat H=arma::eye(n, n); // inverse Hessian approximation
+
+    for (int iter=0; iter<nMaxIter; ++iter)
+    {
+        if (arma::norm(g, "inf")<tol)
+            break;
+
+        arma::mat p=-H*g;
+        double slope=arma::dot(g, p);
+        if (!(slope<0.))
+        {
+            // not a descent direction: restart
+            H=arma::eye(n, n);
+            p=-g;
+            slope=arma::dot(g, p);
+        }
+
+        // backtracking line search (Armijo condition)
+        double alpha=1.0, fn=0.;
+        arma::mat xn;
+        for (;;)
+        {
+            xn=x+alpha*p;
+            fn=model(xn);
+            if (fn <= fx+1e-4*alpha*slope)
+                break;
+            alpha*=0.5;
+            if (alpha*arma::norm(p, 2) < arma::datum::eps*(arma::norm(x, 2)+1.))
+                return x; // no descent possible anymore
+        }
+
+        arma::mat s=xn-x;
+        arma::mat gn=grad(xn);
+        arma::mat y=gn-g;
+        double sy=arma::dot(s, y);
+
+        if (sy > 1e-12*arma::norm(s, 2)*arma::norm(y, 2))
+        {
+            if (iter==0)
+                H*=sy/arma::dot(y, y);
+            double rho=1./sy;
+            arma::mat I=arma::eye(n, n);
+            H = (I-rho*s*y.t()) * H * (I-rho*y*s.t()) + rho*s*s.t();
+        }
+
+        bool smallStep = arma::norm(s, 2) < tol*(arma::norm(x, 2)+tol);
+        x=xn; fx=fn; g=gn;
+        if (smallStep)
+            break;
+    }
+
+    return x;
+}
+
+
+
+
+
+
+double nonlinearRegressionLM(const arma::mat& y, const arma::mat& x, RegressionModel& model, double tol)
+{
+    // residuals sqrt(w)*(y-F(x)) are minimized in the least squares sense.
+    // The model is stateful, so the finite differences are not evaluated in parallel.
+    int np=model.numP();
+    arma::mat sw=arma::sqrt(model.weights(x));
+
+    arma::mat p0=arma::zeros(np), h=arma::zeros(np);
+    model.setInitialValues(p0.memptr());
+    model.setStepHints(h.memptr());
+    h=1e-6*arma::clamp(arma::abs(h), SMALL, arma::datum::inf);
+
+    auto residual = [&](const arma::mat& p) -> arma::mat
+    {
+        model.setParameters(p.memptr());
+        return sw % (y - model.evaluateObjective(x));
+    };
+
+    arma::mat p = nonlinearLeastSquaresND(
+        residual,
+        [&](const arma::mat& p) -> arma::sp_mat
+        {
+            model.setParameters(p.memptr());
+            arma::mat dF=model.evaluateJacobian(x);
+            if (dF.n_elem>0)
+            {
+                return arma::sp_mat( -arma::repmat(sw, 1, np) % dF );
+            }
+            else
+            {
+                return finiteDifferenceJacobian(
+                    residual, p, residual(p), h, 1 );
+            }
+        },
+        p0, tol, 1000, 1 );
+
+    model.setParameters(p.memptr());
+    return model.computeQuality(y, x);
+}
+
+
 arma::mat movingAverage(
     const arma::mat& timeProfs,
     double fraction,
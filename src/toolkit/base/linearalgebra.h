@@ -309,11 +309,21 @@ public:
   virtual void setInitialValues(double* x) const =0;
   virtual void setStepHints(double* x) const;
   virtual arma::mat weights(const arma::mat& x) const;
+
+  /**
+   * derivatives of evaluateObjective(x) w.r.t. the parameters
+   * (one row per x, one column per parameter).
+   * Returns an empty matrix, if not available (default).
+   */
+  virtual arma::mat evaluateJacobian(const arma::mat& x) const;
+
   double computeQuality(const arma::mat& y, const arma::mat& x) const;
 };
 
 /**
  * fits parameters of a nonlinear model F
+ * Uses a Levenberg-Marquardt iteration, if the model provides a Jacobian
+ * or has many parameters, and the Nelder-Mead simplex otherwise.
  * return fit quality
  */
 double nonlinearRegression(const arma::mat& y, const arma::mat& x, RegressionModel& model, double tol=1e-3);
@@ -388,6 +398,65 @@ arma::mat nonlinearSolveND(
         = std::function<void(const arma::mat&)>()
     );
 
+
+/**
+ * Jacobian of a vector function (one row per function component, one column per x)
+ */
+typedef std::function<arma::sp_mat(const arma::mat& x)> JacobianFunction;
+
+/**
+ * gradient of a scalar function (column vector)
+ */
+typedef std::function<arma::mat(const arma::mat& x)> GradientFunction;
+
+/**
+ * @brief nonlinearSolveND
+ * solves obj(x)=0 by a Levenberg-Marquardt iteration.
+ * @param jacobian
+ * the (sparse) Jacobian of obj. If empty, it is computed by finite differences.
+ * @param nThreads
+ * number of threads for evaluating the finite difference columns.
+ * 0: number of cores. obj needs to be thread-safe, if not set to 1.
+ */
+arma::mat nonlinearSolveND(
+    std::function<arma::mat(const arma::mat& x)> obj,
+    const JacobianFunction& jacobian,
+    const arma::mat& x0,
+    double tol=1e-3, int nMaxIter=10000, double relax=1.0,
+    std::function<void(const arma::mat&)> perIterationCallback
+        = std::function<void(const arma::mat&)>(),
+    int nThreads=0
+    );
+
+/**
+ * @brief nonlinearLeastSquaresND
+ * minimizes |obj(x)|^2 by a Levenberg-Marquardt iteration.
+ * Arguments like for nonlinearSolveND.
+ */
+arma::mat nonlinearLeastSquaresND(
+    std::function<arma::mat(const arma::mat& x)> obj,
+    const JacobianFunction& jacobian,
+    const arma::mat& x0,
+    double tol=1e-3, int nMaxIter=10000,
+    int nThreads=0
+    );
+
+/**
+ * @brief nonlinearMinimizeND
+ * minimizes model(x) by BFGS with backtracking line search.
+ * @param gradient
+ * the gradient of model. If empty, it is computed by central differences.
+ * @param nThreads
+ * number of threads for evaluating the finite differences.
+ * 0: number of cores. model needs to be thread-safe, if not set to 1.
+ */
+arma::mat nonlinearMinimizeND(
+    const std::function<double(const arma::mat&)>& model,
+    const GradientFunction& gradient,
+    const arma::mat& x0,
+    double tol=1e-3, int nMaxIter=10000,
+    int nThreads=0 );
+
 arma::mat movingAverage(const arma::mat& timeProfs, double fraction=0.5, bool first_col_is_time=true, bool centerwindow=false);
 
 /**
@@ -26,12 +26,18 @@
 #include "parameterstudy.h"
 #include "base/plottools.h"
 #include "base/analysisthread.h"
+#include "base/progressdisplayer/prefixedprogressdisplayer.h"
+#include "base/parameters/selectionparameter.h"
 
 #include "boost/assign.hpp"
 #include "boost/ptr_container/ptr_deque.hpp"
+#include "boost/ptr_container/ptr_vector.hpp"
 #include "boost/thread.hpp"
 #include "boost/assign/ptr_map_inserter.hpp"
+#include <cstdlib>
+#include <iomanip>
 #include <iterator>
+#include <limits>
 
 
 
@@ -102,7 +108,57 @@ ParameterStudy<BaseAnalysis,var_params>::defaultParameters()
       4, "Maximum number of parallel threads to run at the same time"
     ) 
   );
-        
+
+  dfp->getSubset(subname).insert
+  (
+    "sampling",
+    std::make_unique<SelectionParameter>
+    (
+      "fullFactorial",
+      SelectionParameter::ItemList{"fullFactorial", "latinHypercube", "sobol", "adaptive"},
+      "Selection of the variants."
+      " fullFactorial: all combinations of the values of the parameter ranges."
+      " latinHypercube, sobol: space-filling designs between the smallest and largest value of each range."
+      " adaptive: space-filling initial design, further variants are placed, where the response (run/adaptiveResponse) varies strongly."
+    )
+  );
+
+  dfp->getSubset(subname).insert
+  (
+    "nSamples",
+    std::make_unique<IntParameter>
+    (
+      10, "Total number of variants. Not used for full factorial sampling."
+    )
+  );
+
+  dfp->getSubset(subname).insert
+  (
+    "nInitialSamples",
+    std::make_unique<IntParameter>
+    (
+      5, "Number of variants of the initial design in adaptive sampling."
+    )
+  );
+
+  dfp->getSubset(subname).insert
+  (
+    "samplingSeed",
+    std::make_unique<IntParameter>
+    (
+      0, "Seed of the random number generator for latin hypercube and adaptive sampling."
+    )
+  );
+
+  dfp->getSubset(subname).insert
+  (
+    "adaptiveResponse",
+    std::make_unique<StringParameter>
+    (
+      "", "Path of the scalar result, which controls the adaptive sampling."
+    )
+  );
+
   return dfp;
 }
 
@@ -125,40 +181,82 @@ void ParameterStudy<BaseAnalysis,var_params>::modifyInstanceParameters(
 
 
 
+namespace
+{
+
+/**
+ * shortest representation, which reads back as the same value
+ */
+std::string exactNumberString(double v)
+{
+    std::string s;
+    for (int prec=6; prec<=std::numeric_limits<double>::max_digits10; ++prec)
+    {
+      std::ostringstream os;
+      os<<std::setprecision(prec)<<v;
+      s=os.str();
+      if (std::strtod(s.c_str(), nullptr)==v)
+        break;
+    }
+    return s;
+}
+
+}
+
+
+
+
 template<
   class BaseAnalysis,
   const RangeParameterList& var_params
 >
-void ParameterStudy<BaseAnalysis,var_params>::generateInstance(
-  SynchronisedAnalysisQueue& instances,
+std::string ParameterStudy<BaseAnalysis,var_params>::instanceName(
+  size_t index,
+  const ParameterStudySampler::Point& x
+) const
+{
+    std::ostringstream n;
+    n<<"subcase__"<<std::setw(4)<<std::setfill('0')<<index;
+    for (int j=0; j<var_params.size(); j++)
+    {
+      std::string nameMod(var_params[j]);
+      boost::replace_all(nameMod, "/", "_");
+      n<<"__"<<nameMod<<"="<<exactNumberString(x[j]);
+    }
+    return n.str();
+}
+
+
+
+
+template<
+  class BaseAnalysis,
+  const RangeParameterList& var_params
+>
+AnalysisInstance ParameterStudy<BaseAnalysis,var_params>::generateInstance(
   const ParameterSet& templ,
-  DoubleRangeParameter::RangeList::const_iterator i[]
+  const std::string& name,
+  const ParameterStudySampler::Point& x,
+  ProgressDisplayer& displayer
 )
 {
-    std::ostringstream n; n<<"subcase";
-
     auto newp=std::make_unique<AnalysisParameterSet>(BaseAnalysis::typeName);
 
     newp->copyMatching(templ);
     for (int j=0; j<var_params.size(); j++)
     {
-      double cv = *i[j];
-      newp->setDouble(var_params[j], cv);
-
-      std::string nameMod(var_params[j]);
-      boost::replace_all(nameMod, "/", "_");
-      n<<"__"<<nameMod<<"="<<cv;
+      newp->setDouble(var_params[j], x[j]);
     }
 
     //append instance
     auto emptyresset = std::make_unique<ResultSet>(
         newp->template cloneAs<ParameterSet>(),
         BaseAnalysis::description().name,
-        "Computation instance "+n.str() );
+        "Computation instance "+name );
 
-    modifyInstanceParameters(n.str(), *newp);
+    modifyInstanceParameters(name, *newp);
 
-    path ep=executionPath()/n.str();
+    path ep=executionPath()/name;
 
     // create workdir, if nonexistent.
     // Might be required by supplementedInputData constructor
@@ -167,12 +265,6 @@ void ParameterStudy<BaseAnalysis,var_params>::generateInstance(
 
     newp->resolveRelativePaths(ep);
 
-    std::cout<<std::string(80, '=')+'\n';
-    std::cout<<"Applied Parameters for instance "<<n.str()<<std::endl;
-    std::cout<<*newp;
-    std::cout<<std::string(80, '=')+"\n\n";
-    std::cout<<std::flush;
-
     // create analysis object
     auto newinst =
         Analysis::analyses()(
@@ -180,46 +272,14 @@ void ParameterStudy<BaseAnalysis,var_params>::generateInstance(
                 Analysis::supplementedInputDatas()(
                     BaseAnalysis::typeName,
                     ParameterSetInput(*newp), ep,
-            *consoleProgressDisplayer.forkNewAction(99, "Processing input data") ) );
+            *displayer.forkNewAction(99, "Processing input data") ) );
 
-    instances.enqueue(
-        AnalysisInstance{
-            n.str(),
+    return AnalysisInstance{
+            name,
             std::move(newp),
             std::move(newinst),
             std::move(emptyresset),
-            nullptr  } );
-}
-
-
-
-
-template<
-  class BaseAnalysis,
-  const RangeParameterList& var_params
->
-void ParameterStudy<BaseAnalysis,var_params>::generateInstances
-(
-  SynchronisedAnalysisQueue& instances, 
-  const ParameterSet& templ,
-  int myIdx, 
-  DoubleRangeParameter::RangeList::const_iterator i[]
-)
-{
-  if (myIdx == var_params.size())
-  {
-    // Put it all together
-      generateInstance(instances, templ, i);
-  }
-  else
-  {
-    const DoubleRangeParameter& crp =
-          templ.get<DoubleRangeParameter>(var_params[myIdx]);
-    for (i[myIdx] = crp.values().begin(); i[myIdx] != crp.values().end(); ++i[myIdx])
-    {
-        generateInstances(instances, templ, myIdx+1, i);
-    }
-  }
+            nullptr  };
 }
 
 
@@ -303,10 +363,31 @@ template<
 >
 void ParameterStudy<BaseAnalysis,var_params>::setupQueue()
 {
-  DoubleRangeParameter::RangeList::const_iterator iters[var_params.size()];
-  
   queue_.clear();
-  generateInstances(queue_, parameters(), 0, iters);
+
+  instanceTemplate_ = parameters().template cloneAs<ParameterSet>();
+
+  std::vector<std::vector<double> > levels;
+  for (const auto& vp: var_params)
+  {
+    const auto& vals =
+        instanceTemplate_->template get<DoubleRangeParameter>(vp).values();
+    levels.push_back(std::vector<double>(vals.begin(), vals.end()));
+  }
+
+  sampler_ = ParameterStudySampler::create(
+      parameters().template get<SelectionParameter>("run/sampling").selection(),
+      levels,
+      parameters().getInt("run/nSamples"),
+      parameters().getInt("run/nInitialSamples"),
+      parameters().getInt("run/samplingSeed") );
+
+  if (sampler_->needsResponse())
+  {
+    insight::assertion(
+        !parameters().getString("run/adaptiveResponse").empty(),
+        "adaptive sampling requires the path of a scalar result (run/adaptiveResponse)" );
+  }
 }
 
 
@@ -318,19 +399,125 @@ template<
 >
 void ParameterStudy<BaseAnalysis,var_params>::processQueue(insight::ProgressDisplayer& displayer)
 {
-  int nt = std::min( parameters().getInt("run/numthread"), int(queue_.n_instances()) );
-  
+  insight::assertion(
+      bool(sampler_),
+      "internal error: setupQueue() has to be called before processQueue()" );
+
+  int nt = std::min<int>( parameters().getInt("run/numthread"), sampler_->expectedSize() );
+  std::string responsePath = parameters().getString("run/adaptiveResponse");
+
   boost::ptr_vector<AnalysisWorkerThread> threads;
   for (int i=0; i<nt; i++)
   {
     threads.push_back(new AnalysisWorkerThread(&queue_, &displayer));
   }
-  
+
   for(auto& t: threads)
   {
     workers_.create_thread(boost::ref(t));
   }
-  
+
+  // The instances are generated here in the main thread
+  // (the CAD feature cache e.g. is not thread safe),
+  // the workers only run the analyses.
+  // Not more than 2*nt instances are kept pending.
+  std::map<std::string, ParameterStudySampler::Point> pending;
+  size_t nIssued=0, nProcessed=0;
+
+  auto collectResults = [&]()
+  {
+    nProcessed = queue_.waitForProcessed(
+        nProcessed,
+        [&](const AnalysisInstance& ai)
+        {
+          boost::optional<double> response;
+          if (!ai.exception && sampler_->needsResponse())
+          {
+            try
+            {
+              response = ai.results->getScalar(responsePath);
+            }
+            catch (const std::exception& e)
+            {
+              insight::Warning(
+                    "response %s of instance %s is not available: %s",
+                    responsePath.c_str(), ai.name.c_str(), e.what() );
+            }
+          }
+          auto p = pending.find(ai.name);
+          insight::assertion(
+              p!=pending.end(),
+              "internal error: no pending sample for instance %s",
+              ai.name.c_str() );
+          sampler_->addResult(p->second, response);
+          pending.erase(p);
+        }
+    );
+  };
+
+  try
+  {
+    for (;;)
+    {
+      ParameterStudySampler::Point x;
+      auto st=sampler_->next(x);
+
+      if (st==ParameterStudySampler::Finished)
+        break;
+
+      if ( st==ParameterStudySampler::Wait
+           || nIssued-nProcessed >= size_t(2*nt) )
+      {
+        insight::assertion(
+            nIssued>nProcessed,
+            "internal error: sampler waits for results but no instance is pending" );
+        collectResults();
+        continue;
+      }
+
+      auto name = instanceName(nIssued, x);
+      insight::assertion(
+          pending.emplace(name, x).second,
+          "internal error: instance name %s is not unique",
+          name.c_str() );
+      nIssued++;
+
+      std::ostringstream vals;
+      for (int j=0; j<var_params.size(); j++)
+        vals<<" "<<var_params[j]<<"="<<x[j];
+      std::cout<<"Starting instance "<<name<<":"<<vals.str()<<std::endl;
+
+      PrefixedProgressDisplayer pd(&displayer, name,
+                                   PrefixedProgressDisplayer::Prefixed,
+                                   PrefixedProgressDisplayer::ParallelPrefix);
+      try
+      {
+        queue_.enqueue( generateInstance(*instanceTemplate_, name, x, pd) );
+      }
+      catch ( std::exception& e )
+      {
+        WarningDispatcher::getCurrent().issue(
+              "An exception has occurred while creating the instance "+name+" of the parameter study."
+              "The analysis of this instance was not completed.\n"
+              "Reason: "+e.what()
+              );
+        AnalysisInstance ai;
+        ai.name = name;
+        ai.exception = std::current_exception();
+        queue_.storeProcessed(std::move(ai));
+      }
+    }
+  }
+  catch (...)
+  {
+    queue_.close();
+    workers_.interrupt_all();
+    workers_.join_all();
+    throw;
+  }
+
+  queue_.close();
+
   //wait for computation to finish
   workers_.join_all();
 
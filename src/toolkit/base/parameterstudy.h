@@ -23,6 +23,7 @@
 
 #include <base/analysis.h>
 #include "base/parameters/doublerangeparameter.h"
+#include "base/parameterstudysampling.h"
 
 
 
@@ -52,24 +53,36 @@ class ParameterStudy
 {
 
 protected:
-  void generateInstance
+  /**
+   * unique name of the variant: it contains the running sample index,
+   * since different samples may print the same values
+   */
+  std::string instanceName
   (
-    SynchronisedAnalysisQueue& instances,
-    const ParameterSet& templ,
-    DoubleRangeParameter::RangeList::const_iterator i[]
-  );
+    size_t index,
+    const ParameterStudySampler::Point& x
+  ) const;
 
-  void generateInstances
+  /**
+   * create the analysis of a single variant.
+   * Executed sequentially in the main thread,
+   * only the analyses themselves run in the worker threads.
+   */
+  AnalysisInstance generateInstance
   (
-    SynchronisedAnalysisQueue& instances, 
     const ParameterSet& templ,
-    int myIdx, 
-    DoubleRangeParameter::RangeList::const_iterator i[]
+    const std::string& name,
+    const ParameterStudySampler::Point& x,
+    ProgressDisplayer& displayer
   );
-  
+
   SynchronisedAnalysisQueue queue_;
   boost::thread_group workers_;
 
+  // state of the instance generation, set up by setupQueue()
+  std::unique_ptr<ParameterSet> instanceTemplate_;
+  std::unique_ptr<ParameterStudySampler> sampler_;
+
   
 public:
 //   declareType("Parameter Study");
@@ -94,7 +107,18 @@ public:
   ) const;
   
   virtual void modifyInstanceParameters(const std::string& subcase_name, ParameterSet& newp) const;
+
+  /**
+   * prepare the generation of the variants.
+   * The current parameters are used as template for all instances.
+   * The instances themselves are only created in processQueue(),
+   * shortly before a worker thread becomes available.
+   */
   virtual void setupQueue();
+
+  /**
+   * create and run the variants in run/numthread parallel threads
+   */
   virtual void processQueue(insight::ProgressDisplayer& displayer);
   virtual ResultSetPtr evaluateRuns();
   
@@ -0,0 +1,482 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "parameterstudysampling.h"
+
+#include "base/exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace insight {
+
+
+
+
+ParameterStudySampler::~ParameterStudySampler()
+{}
+
+
+
+
+void ParameterStudySampler::addResult(const Point&, boost::optional<double>)
+{}
+
+
+
+
+bool ParameterStudySampler::needsResponse() const
+{
+    return false;
+}
+
+
+
+
+std::unique_ptr<ParameterStudySampler> ParameterStudySampler::create(
+    const std::string& type,
+    const std::vector<std::vector<double> >& levels,
+    int nSamples,
+    int nInitialSamples,
+    int seed )
+{
+    if (type=="fullFactorial" || levels.size()==0)
+    {
+        return std::make_unique<FullFactorialSampler>(levels);
+    }
+
+    Point lower, upper;
+    for (const auto& l: levels)
+    {
+        insight::assertion(
+            l.size()>0,
+            "empty range of parameter values" );
+        lower.push_back(*std::min_element(l.begin(), l.end()));
+        upper.push_back(*std::max_element(l.begin(), l.end()));
+    }
+
+    insight::assertion(
+        nSamples>0,
+        "the number of samples has to be positive (got %d)", nSamples );
+
+    if (type=="latinHypercube")
+    {
+        return std::make_unique<LatinHypercubeSampler>(lower, upper, nSamples, seed);
+    }
+    else if (type=="sobol")
+    {
+        return std::make_unique<SobolSampler>(lower, upper, nSamples);
+    }
+    else if (type=="adaptive")
+    {
+        return std::make_unique<AdaptiveSampler>(
+            lower, upper, nSamples, std::max(1, nInitialSamples), seed);
+    }
+    else
+    {
+        throw insight::Exception(
+            "unknown sampling type: %s", type.c_str() );
+    }
+}
+
+
+
+
+FullFactorialSampler::FullFactorialSampler(
+    const std::vector<std::vector<double> >& levels )
+    : levels_(levels),
+      idx_(levels.size(), 0),
+      finished_(false)
+{
+    for (const auto& l: levels_)
+    {
+        if (l.empty()) finished_=true;
+    }
+}
+
+
+
+
+ParameterStudySampler::State FullFactorialSampler::next(Point& x)
+{
+    if (finished_)
+        return Finished;
+
+    x.resize(levels_.size());
+    for (size_t j=0; j<levels_.size(); ++j)
+    {
+        x[j]=levels_[j][idx_[j]];
+    }
+
+    // advance, last index fastest
+    finished_=true;
+    for (size_t j=levels_.size(); j-- > 0; )
+    {
+        if (++idx_[j] < levels_[j].size())
+        {
+            finished_=false;
+            break;
+        }
+        idx_[j]=0;
+    }
+
+    return Available;
+}
+
+
+
+
+size_t FullFactorialSampler::expectedSize() const
+{
+    size_t n=1;
+    for (const auto& l: levels_)
+    {
+        n*=l.size();
+    }
+    return n;
+}
+
+
+
+
+LatinHypercubeSampler::LatinHypercubeSampler(
+    const Point& lower, const Point& upper,
+    size_t nSamples, int seed )
+    : lower_(lower), upper_(upper),
+      n_(nSamples), i_(0),
+      rng_(seed),
+      perm_(lower.size())
+{
+    for (auto& p: perm_)
+    {
+        p.resize(n_);
+        std::iota(p.begin(), p.end(), 0);
+        std::shuffle(p.begin(), p.end(), rng_);
+    }
+}
+
+
+
+
+ParameterStudySampler::State LatinHypercubeSampler::next(Point& x)
+{
+    if (i_>=n_)
+        return Finished;
+
+    std::uniform_real_distribution<double> u(0., 1.);
+    x.resize(lower_.size());
+    for (size_t j=0; j<lower_.size(); ++j)
+    {
+        x[j] = lower_[j]
+             + (upper_[j]-lower_[j]) * (double(perm_[j][i_])+u(rng_)) / double(n_);
+    }
+    ++i_;
+
+    return Available;
+}
+
+
+
+
+size_t LatinHypercubeSampler::expectedSize() const
+{
+    return n_;
+}
+
+
+
+
+namespace
+{
+
+// primitive polynomials and initial direction numbers
+// for dimensions 2.. (new-joe-kuo-6.21201)
+struct SobolDirection
+{
+    unsigned int s, a;
+    std::vector<unsigned int> m;
+};
+
+const std::vector<SobolDirection> sobolDirections = {
+    { 1, 0,  {1} },
+    { 2, 1,  {1, 3} },
+    { 3, 1,  {1, 3, 1} },
+    { 3, 2,  {1, 1, 1} },
+    { 4, 1,  {1, 1, 3, 3} },
+    { 4, 4,  {1, 3, 5, 13} },
+    { 5, 2,  {1, 1, 5, 5, 17} },
+    { 5, 4,  {1, 1, 5, 5, 5} },
+    { 5, 7,  {1, 1, 7, 11, 19} },
+    { 5, 11, {1, 1, 5, 1, 1} },
+    { 5, 13, {1, 1, 1, 3, 11} },
+    { 5, 14, {1, 3, 5, 5, 31} }
+};
+
+const unsigned int sobolBits = 32;
+
+}
+
+
+const size_t SobolSampler::maxDimension = sobolDirections.size()+1;
+
+
+SobolSampler::SobolSampler(
+    const Point& lower, const Point& upper,
+    size_t nSamples )
+    : lower_(lower), upper_(upper),
+      n_(nSamples), i_(0),
+      v_(lower.size(), std::vector<unsigned int>(sobolBits)),
+      x_(lower.size(), 0)
+{
+    insight::assertion(
+        lower.size()<=maxDimension,
+        "Sobol sampling supports at most %d parameters (got %d)",
+        int(maxDimension), int(lower.size()) );
+
+    for (size_t j=0; j<lower.size(); ++j)
+    {
+        auto& v=v_[j];
+        if (j==0)
+        {
+            for (unsigned int k=0; k<sobolBits; ++k)
+                v[k] = 1u << (sobolBits-1-k);
+        }
+        else
+        {
+            const auto& sd=sobolDirections[j-1];
+            for (unsigned int k=0; k<sobolBits; ++k)
+            {
+                if (k<sd.s)
+                {
+                    v[k] = sd.m[k] << (sobolBits-1-k);
+                }
+                else
+                {
+                    v[k] = v[k-sd.s] ^ (v[k-sd.s] >> sd.s);
+                    for (unsigned int l=1; l<sd.s; ++l)
+                    {
+                        if ((sd.a >> (sd.s-1-l)) & 1u)
+                            v[k] ^= v[k-l];
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+
+
+ParameterStudySampler::State SobolSampler::next(Point& x)
+{
+    if (i_>=n_)
+        return Finished;
+
+    // Gray code construction: flip the direction number
+    // of the rightmost zero bit of the point index
+    unsigned int c=0;
+    for (size_t value=i_; value & 1u; value>>=1)
+        ++c;
+
+    x.resize(lower_.size());
+    for (size_t j=0; j<lower_.size(); ++j)
+    {
+        x_[j] ^= v_[j][c];
+        x[j] = lower_[j]
+             + (upper_[j]-lower_[j]) * double(x_[j]) / std::pow(2., sobolBits);
+    }
+    ++i_;
+
+    return Available;
+}
+
+
+
+
+size_t SobolSampler::expectedSize() const
+{
+    return n_;
+}
+
+
+
+
+AdaptiveSampler::AdaptiveSampler(
+    const Point& lower, const Point& upper,
+    size_t nSamples, size_t nInitialSamples,
+    int seed )
+    : lower_(lower), upper_(upper),
+      nTotal_(nSamples),
+      nInitial_(std::min(nInitialSamples, nSamples)),
+      nIssued_(0),
+      initial_(lower, upper, nInitial_, seed),
+      nPending_(0)
+{
+    auto d=lower.size();
+    SobolSampler cs(
+        Point(std::min(d, SobolSampler::maxDimension), 0.),
+        Point(std::min(d, SobolSampler::maxDimension), 1.),
+        std::max<size_t>(100, 20*nTotal_) );
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0., 1.);
+    Point c;
+    while (cs.next(c)==Available)
+    {
+        // fill remaining dimensions randomly
+        while (c.size()<d) c.push_back(u(rng));
+        candidates_.push_back(c);
+    }
+}
+
+
+
+
+ParameterStudySampler::Point AdaptiveSampler::normalized(const Point& x) const
+{
+    Point xn(x.size());
+    for (size_t j=0; j<x.size(); ++j)
+    {
+        double delta=upper_[j]-lower_[j];
+        xn[j] = delta>0. ? (x[j]-lower_[j])/delta : 0.;
+    }
+    return xn;
+}
+
+
+
+
+ParameterStudySampler::State AdaptiveSampler::next(Point& x)
+{
+    auto dist = [](const Point& a, const Point& b)
+    {
+        double d2=0.;
+        for (size_t j=0; j<a.size(); ++j)
+            d2+=std::pow(a[j]-b[j], 2);
+        return std::sqrt(d2);
+    };
+
+    if (nIssued_>=nTotal_)
+        return Finished;
+
+    if (nIssued_<nInitial_)
+    {
+        initial_.next(x);
+    }
+    else
+    {
+        // the initial design needs to be evaluated first
+        if ( (evaluated_.size()<nInitial_ || evaluated_.size()<2) && nPending_>0 )
+            return Wait;
+
+        if (candidates_.empty())
+            return Finished;
+
+        double rmin=std::numeric_limits<double>::max(), rmax=-rmin;
+        for (const auto& e: evaluated_)
+        {
+            rmin=std::min(rmin, e.second);
+            rmax=std::max(rmax, e.second);
+        }
+        double range = rmax>rmin ? rmax-rmin : 1.;
+
+        size_t k = std::min(lower_.size()+1, evaluated_.size());
+
+        double bestScore=-1.;
+        size_t best=0;
+        std::vector<std::pair<double, double> > nb(evaluated_.size());
+        for (size_t i=0; i<candidates_.size(); ++i)
+        {
+            const auto& c=candidates_[i];
+
+            double dmin=std::numeric_limits<double>::max();
+            for (const auto& s: sampled_)
+                dmin=std::min(dmin, dist(c, s));
+
+            // spread of the responses in the neighbourhood
+            double spread=0.;
+            if (k>1)
+            {
+                for (size_t l=0; l<evaluated_.size(); ++l)
+                    nb[l]={dist(c, evaluated_[l].first), evaluated_[l].second};
+                std::partial_sort(nb.begin(), nb.begin()+k, nb.end());
+                auto mm=std::minmax_element(
+                    nb.begin(), nb.begin()+k,
+                    [](const std::pair<double,double>& a, const std::pair<double,double>& b)
+                    { return a.second<b.second; } );
+                spread=(mm.second->second-mm.first->second)/range;
+            }
+
+            // the constant keeps filling unexplored regions
+            double score = dmin*(spread+0.1);
+            if (score>bestScore)
+            {
+                bestScore=score;
+                best=i;
+            }
+        }
+
+        const auto& c=candidates_[best];
+        x.resize(c.size());
+        for (size_t j=0; j<c.size(); ++j)
+            x[j]=lower_[j]+(upper_[j]-lower_[j])*c[j];
+        candidates_.erase(candidates_.begin()+best);
+    }
+
+    sampled_.push_back(normalized(x));
+    ++nIssued_;
+    ++nPending_;
+    return Available;
+}
+
+
+
+
+void AdaptiveSampler::addResult(const Point& x, boost::optional<double> response)
+{
+    if (nPending_>0) --nPending_;
+    if (response)
+    {
+        evaluated_.push_back({normalized(x), *response});
+    }
+}
+
+
+
+
+size_t AdaptiveSampler::expectedSize() const
+{
+    return nTotal_;
+}
+
+
+
+
+bool AdaptiveSampler::needsResponse() const
+{
+    return true;
+}
+
+
+
+
+} // namespace insight
@@ -0,0 +1,214 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef INSIGHT_PARAMETERSTUDYSAMPLING_H
+#define INSIGHT_PARAMETERSTUDYSAMPLING_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace insight {
+
+
+
+
+/**
+ * @brief The ParameterStudySampler class
+ * Produces the points in the space of the varied parameters,
+ * at which a parameter study evaluates its base analysis.
+ * The points are produced one by one, when a worker becomes available.
+ *
+ * Not thread-safe: the caller has to synchronize the access.
+ */
+class ParameterStudySampler
+{
+public:
+    typedef std::vector<double> Point;
+
+    enum State {
+        /** a new point is available */
+        Available,
+        /** no point can be proposed before more results are available */
+        Wait,
+        /** all points have been produced */
+        Finished
+    };
+
+    virtual ~ParameterStudySampler();
+
+    /**
+     * @brief next
+     * @param x
+     * set to the next point, if Available is returned
+     */
+    virtual State next(Point& x) =0;
+
+    /**
+     * @brief addResult
+     * report the evaluated response of a previously produced point.
+     * Unset, if the evaluation failed.
+     */
+    virtual void addResult(const Point& x, boost::optional<double> response);
+
+    /**
+     * @brief expectedSize
+     * @return
+     * the (maximum) total number of points
+     */
+    virtual size_t expectedSize() const =0;
+
+    /**
+     * @brief needsResponse
+     * @return
+     * true, if addResult() has to be called with response values
+     */
+    virtual bool needsResponse() const;
+
+    static std::unique_ptr<ParameterStudySampler> create(
+        const std::string& type,
+        const std::vector<std::vector<double> >& levels,
+        int nSamples,
+        int nInitialSamples,
+        int seed );
+};
+
+
+
+
+/**
+ * @brief The FullFactorialSampler class
+ * all combinations of the given values. The last parameter varies fastest.
+ */
+class FullFactorialSampler
+    : public ParameterStudySampler
+{
+    std::vector<std::vector<double> > levels_;
+    std::vector<size_t> idx_;
+    bool finished_;
+
+public:
+    FullFactorialSampler(const std::vector<std::vector<double> >& levels);
+
+    State next(Point& x) override;
+    size_t expectedSize() const override;
+};
+
+
+
+
+/**
+ * @brief The LatinHypercubeSampler class
+ * random latin hypercube design with nSamples points
+ * in the box between lower and upper.
+ */
+class LatinHypercubeSampler
+    : public ParameterStudySampler
+{
+    Point lower_, upper_;
+    size_t n_, i_;
+    std::mt19937 rng_;
+    std::vector<std::vector<size_t> > perm_;
+
+public:
+    LatinHypercubeSampler(
+        const Point& lower, const Point& upper,
+        size_t nSamples, int seed = 0 );
+
+    State next(Point& x) override;
+    size_t expectedSize() const override;
+};
+
+
+
+
+/**
+ * @brief The SobolSampler class
+ * quasi-random Sobol sequence (direction numbers by Joe & Kuo)
+ * in the box between lower and upper. The first point (origin) is skipped.
+ * Supports up to 13 parameters.
+ */
+class SobolSampler
+    : public ParameterStudySampler
+{
+    Point lower_, upper_;
+    size_t n_, i_;
+    std::vector<std::vector<unsigned int> > v_;
+    std::vector<unsigned int> x_;
+
+public:
+    static const size_t maxDimension;
+
+    SobolSampler(
+        const Point& lower, const Point& upper,
+        size_t nSamples );
+
+    State next(Point& x) override;
+    size_t expectedSize() const override;
+};
+
+
+
+
+/**
+ * @brief The AdaptiveSampler class
+ * starts with a latin hypercube design of nInitialSamples points.
+ * The remaining points are selected one after another from a set of
+ * Sobol candidate points: the candidate with the largest product of
+ * the distance to the already sampled points and
+ * the spread of the responses of its nearest neighbours is chosen.
+ * Thus the samples concentrate in regions of strong variation of the response,
+ * while unexplored regions are still filled.
+ */
+class AdaptiveSampler
+    : public ParameterStudySampler
+{
+    Point lower_, upper_;
+    size_t nTotal_, nInitial_, nIssued_;
+    LatinHypercubeSampler initial_;
+
+    std::vector<Point> candidates_;
+    std::vector<Point> sampled_; // normalized coordinates
+    std::vector<std::pair<Point, double> > evaluated_; // normalized coordinates
+    size_t nPending_;
+
+    Point normalized(const Point& x) const;
+
+public:
+    AdaptiveSampler(
+        const Point& lower, const Point& upper,
+        size_t nSamples, size_t nInitialSamples,
+        int seed = 0 );
+
+    State next(Point& x) override;
+    void addResult(const Point& x, boost::optional<double> response) override;
+    size_t expectedSize() const override;
+    bool needsResponse() const override;
+};
+
+
+
+
+} // namespace insight
+
+#endif // INSIGHT_PARAMETERSTUDYSAMPLING_H
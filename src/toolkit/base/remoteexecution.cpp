@@ -215,6 +215,22 @@ void RemoteExecutionConfig::syncToLocal(
 
 
 
+void RemoteExecutionConfig::syncToLocal(
+    bool includeProcessorDirectories,
+    const TimeDirectorySelection& timeSelection,
+    const std::vector<string> &exclude_pattern,
+    std::function<void (int, const string &)> progress_callback)
+{
+    RemoteLocation::syncToLocal(
+                localDir_,
+                includeProcessorDirectories,
+                timeSelection,
+                exclude_pattern, progress_callback);
+}
+
+
+
+
 boost::filesystem::path RemoteExecutionConfig::defaultConfigFileName()
 {
     return "meta.foam";
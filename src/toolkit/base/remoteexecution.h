@@ -119,6 +119,15 @@ public:
                             std::function<void(int,const std::string&)>()
     );
 
+    virtual void syncToLocal
+    (
+        bool includeProcessorDirectories,
+        const TimeDirectorySelection& timeSelection,
+        const std::vector<std::string>& exclude_pattern = std::vector<std::string>(),
+        std::function<void(int progress,const std::string& status_text)> progress_callback =
+                            std::function<void(int,const std::string&)>()
+    );
+
 
     static boost::filesystem::path defaultConfigFileName();
     static boost::filesystem::path defaultConfigFile(const boost::filesystem::path& location);
@@ -14,6 +14,7 @@
 #include <boost/process/async.hpp>
 
 #include <regex>
+#include <limits>
 #include "rapidxml/rapidxml_print.hpp"
 
 #include <signal.h>
@@ -478,28 +479,167 @@ void RemoteLocation::syncToLocal
     std::function<void(int,const std::string&)> pf
 )
 {
-  CurrentExceptionContext ex("download remote files to local directory");
-  assertValid();
+  syncToLocal(
+      localDir,
+      includeProcessorDirectories,
+      TimeDirectorySelection(
+        skipTimeSteps ?
+          TimeDirectorySelection::NoTimes :
+          TimeDirectorySelection::AllTimes ),
+      exclude_pattern, pf );
+}
 
-  std::vector<std::string> excl = exclude_pattern;
-  if (skipTimeSteps)
+
+
+
+RemoteLocation::TimeDirectorySelection::TimeDirectorySelection(Mode m)
+  : mode(m),
+    fromTime(-std::numeric_limits<double>::max()),
+    toTime(std::numeric_limits<double>::max())
+{}
+
+
+
+
+bool RemoteLocation::TimeDirectorySelection::isSelected(double t, double latestTime) const
+{
+  auto eq = [](double a, double b)
   {
-    auto files = remoteLS();
+    return std::fabs(a-b) <= 1e-9*std::max(1., std::fabs(b));
+  };
+
+  switch (mode)
+  {
+    case AllTimes:
+      return true;
+    case NoTimes:
+      return false;
+    case LatestTime:
+      return eq(t, latestTime);
+    case ListedTimes:
+      return std::any_of(
+          times.begin(), times.end(),
+          [&](double s) { return eq(t, s); } );
+    case TimeRange:
+      return (t>=fromTime || eq(t, fromTime)) && (t<=toTime || eq(t, toTime));
+  }
+  return true;
+}
 
-    // remove non-numbers
-    files.erase(remove_if(files.begin(), files.end(),
-                          [&](const bfs_path& f)
-    {
-      try { toNumber<double>(f.string()); return false; }
-      catch (...) { return true; }
-    }), files.end());
 
+
+
+std::vector<std::string> RemoteLocation::timeSelectionExcludePatterns
+(
+    bool includeProcessorDirectories,
+    const TimeDirectorySelection& ts
+) const
+{
+  CurrentExceptionContext ex("determining time directories to exclude from transfer");
+  assertValid();
+
+  std::vector<std::string> excl;
+
+  if (ts.mode==TimeDirectorySelection::AllTimes && ts.fields.empty())
+    return excl;
+
+  // collect time directories of reconstructed and decomposed case
+  std::map<double, std::string> timeDirs;
+  std::set<std::string> decomposedOnly;
+  auto addNumeric = [&](const std::vector<bfs_path>& files, bool decomposed)
+  {
     for (const auto& f: files)
     {
-      excl.push_back(f.string());
+      try
+      {
+        double t=toNumber<double>(f.string());
+        if (timeDirs.insert({t, f.string()}).second && decomposed)
+          decomposedOnly.insert(f.string());
+      }
+      catch (...) {}
+    }
+  };
+
+  auto files = remoteLS();
+  addNumeric(files, false);
+  bool hasProc0 = std::find(files.begin(), files.end(), bfs_path("processor0"))!=files.end();
+  if (includeProcessorDirectories && hasProc0)
+  {
+    addNumeric( serverInstance_->listRemoteDirectory(remoteDir_/"processor0"), true );
+  }
+
+  if (timeDirs.empty())
+    return excl;
+
+  double latestTime = timeDirs.rbegin()->first;
+
+  // anchored at the transfer root, so that e.g. time-named
+  // directories below postProcessing are not matched.
+  // Processor directories are either below the root
+  // or transferred separately with themselves as root.
+  auto addExclude = [&](const std::string& rp)
+  {
+    excl.push_back("/"+rp);
+    if (includeProcessorDirectories)
+      excl.push_back("/processor*/"+rp);
+  };
+
+  std::vector<std::string> selected;
+  for (const auto& td: timeDirs)
+  {
+    if (ts.isSelected(td.first, latestTime))
+      selected.push_back(td.second);
+    else
+      addExclude(td.second);
+  }
+
+  if (!ts.fields.empty() && !selected.empty())
+  {
+    // determine the unselected fields from the last selected time directory
+    auto ref = remoteDir_/selected.back();
+    if (decomposedOnly.count(selected.back()))
+      ref = remoteDir_/"processor0"/selected.back();
+
+    for (const auto& f: serverInstance_->listRemoteDirectory(ref))
+    {
+      auto fn=f.string();
+      if ( fn!="uniform" && fn!="polyMesh"
+           && std::find(ts.fields.begin(), ts.fields.end(), fn)==ts.fields.end() )
+      {
+        for (const auto& s: selected)
+        {
+          addExclude(s+"/"+fn);
+        }
+      }
     }
   }
 
+  insight::dbg()<<"transferring time directories: "<<boost::join(selected, " ")<<std::endl;
+
+  return excl;
+}
+
+
+
+
+void RemoteLocation::syncToLocal
+(
+    const boost::filesystem::path& localDir,
+    bool includeProcessorDirectories,
+    const TimeDirectorySelection& timeSelection,
+    const std::vector<std::string>& exclude_pattern,
+    std::function<void(int,const std::string&)> pf
+)
+{
+  CurrentExceptionContext ex("download remote files to local directory");
+  assertValid();
+
+  std::vector<std::string> excl = exclude_pattern;
+
+  auto tse = timeSelectionExcludePatterns(
+        includeProcessorDirectories, timeSelection );
+  excl.insert(excl.end(), tse.begin(), tse.end());
+
   server()->syncToLocal(
               localDir, remoteDir_,
               includeProcessorDirectories,
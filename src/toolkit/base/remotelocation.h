@@ -179,6 +179,65 @@ public:
                             std::function<void(int,const std::string&)>()
     );
 
+    /**
+     * @brief The TimeDirectorySelection struct
+     * selects the time directories and fields, which are downloaded
+     */
+    struct TimeDirectorySelection
+    {
+        enum Mode { AllTimes, NoTimes, LatestTime, ListedTimes, TimeRange };
+
+        Mode mode;
+        /**
+         * @brief times
+         * times to download, if mode is ListedTimes
+         */
+        std::vector<double> times;
+        /**
+         * @brief fromTime, toTime
+         * bounds of the time interval to download, if mode is TimeRange
+         */
+        double fromTime, toTime;
+        /**
+         * @brief fields
+         * fields, which are downloaded from the selected time directories.
+         * All, if empty.
+         */
+        std::vector<std::string> fields;
+
+        explicit TimeDirectorySelection(Mode m = AllTimes);
+
+        bool isSelected(double t, double latestTime) const;
+    };
+
+    /**
+     * @brief syncToLocal
+     * download only selected time directories.
+     * Processor directories are transferred in parallel,
+     * if the server supports it.
+     */
+    virtual void syncToLocal
+    (
+        const boost::filesystem::path& localDir,
+        bool includeProcessorDirectories,
+        const TimeDirectorySelection& timeSelection,
+        const std::vector<std::string>& exclude_pattern = std::vector<std::string>(),
+        std::function<void(int progress,const std::string& status_text)> progress_callback =
+                            std::function<void(int,const std::string&)>()
+    );
+
+    /**
+     * @brief timeSelectionExcludePatterns
+     * @return
+     * rsync exclude patterns for all time directories
+     * and fields, which are not selected
+     */
+    std::vector<std::string> timeSelectionExcludePatterns
+    (
+        bool includeProcessorDirectories,
+        const TimeDirectorySelection& timeSelection
+    ) const;
+
 
     // ====================================================================================
     // ======== queue commands
@@ -252,6 +252,22 @@ public:
    */
   virtual int transferBandWidthLimit() const;
 
+  /**
+   * @brief setTransferParallelism
+   * set the number of concurrent streams, over which
+   * a sync transfer may be distributed
+   * @param nStreams
+   * number of streams, 1 means a single transfer
+   */
+  virtual void setTransferParallelism(int nStreams);
+
+  /**
+   * @brief transferParallelism
+   * return the number of concurrent sync transfer streams
+   * @return
+   */
+  virtual int transferParallelism() const;
+
   virtual void syncToRemote
   (
       const boost::filesystem::path& localDir,
@@ -1,6 +1,8 @@
 #include "resultelement.h"
 #include "base/hierarchicalelement.h"
 #include "base/rapidxml.h"
+#include "base/filecontainer.h"
+
 
 
 using namespace std;
@@ -83,6 +85,17 @@ void ResultElement::exportDataToFile ( const std::string& , const boost::filesys
 }
 
 
+
+
+std::string ResultElement::contentHash() const
+{
+    std::string content;
+    saveToString(content);
+
+    return hexDigest(*calcBufferHash(content));
+}
+
+
 rapidxml::xml_node< char >*
 ResultElement::appendToNode
 (
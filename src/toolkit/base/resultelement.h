@@ -65,6 +65,13 @@ public:
 
   virtual void exportDataToFile ( const std::string& name, const boost::filesystem::path& outputdirectory ) const;
 
+  /**
+   * @brief contentHash
+   * MD5 hash (hexadecimal) of the serialized element.
+   * Used to skip the regeneration of unchanged report files (charts, images).
+   */
+  std::string contentHash() const;
+
     /**
      * append the contents of this element to the given xml node
      */
@@ -2,6 +2,7 @@
 
 #include "base/resultelements/resultsection.h"
 #include "base/resultelements/numericalresult.h"
+#include "base/tools.h"
 
 using namespace std;
 using namespace boost;
@@ -81,14 +82,28 @@ std::string ResultElementCollection::latexRepresentation(
           }
     );
 
-    std::ostringstream f;
-    for ( auto& re: items )
-    {
-        if (!fsi.elementFilter.matches(*re.second))
+    items.erase(
+        std::remove_if(
+            items.begin(), items.end(),
+            [&fsi](const decltype(items)::value_type& re)
+            { return fsi.elementFilter.matches(*re.second); } ),
+        items.end() );
+
+    // the elements (and the additional files like chart images)
+    // are independent and can be created in parallel.
+    // Remaining threads are handed down to the sections.
+    auto childFsi = fsi;
+    childFsi.nThreads = std::max<int>(1, fsi.nThreads/std::max<size_t>(1, items.size()));
+
+    std::vector<std::string> parts(items.size());
+    parallelFor(
+        items.size(),
+        [&](size_t i)
         {
+            const auto& re = items[i];
             const ResultElement* r = & ( *re.second );
 
-            //         std::cout<<re.first<<" order="<<re.second->order() <<std::endl;
+            std::ostringstream f;
 
             std::string subelemname=re.first;
             if ( name!="" ) {
@@ -98,7 +113,7 @@ std::string ResultElementCollection::latexRepresentation(
 
             if ( const ResultSection* se=dynamic_cast<const ResultSection*> ( r ) )
             {
-                f << se->latexRepresentation ( subelemname, documentHierarchyLevel+1, fsi );
+                f << se->latexRepresentation ( subelemname, documentHierarchyLevel+1, childFsi );
             }
             else
             {
@@ -110,13 +125,20 @@ std::string ResultElementCollection::latexRepresentation(
 
                 f << r->shortDescription().toLaTeX() << "\n\n";
 
-                //     re.second->writeLatexCode(f, re.first, level+1, outputfilepath);
-                f << r->latexRepresentation ( subelemname, documentHierarchyLevel+2, fsi );
+                f << r->latexRepresentation ( subelemname, documentHierarchyLevel+2, childFsi );
 
                 f << "\n\n" << r->longDescription().toLaTeX() << "\n\n";
                 f << endl;
             }
-        }
+
+            parts[i]=f.str();
+        },
+        fsi.nThreads );
+
+    std::ostringstream f;
+    for (const auto& p: parts)
+    {
+        f << p;
     }
     return f.str();
 }
@@ -278,7 +278,16 @@ std::string Chart::latexRepresentation (
     auto chart_file =
         (addf.directory/filename).string();
 
-    generatePlotImage ( chart_file );
+    // the renderer selection changes the image as well
+    auto hash=contentHash();
+    if (const auto* rv=getenv("INSIGHT_CHARTRENDERER"))
+        hash+=std::string(" ")+rv;
+
+    if (!generatedFileIsUpToDate(chart_file, hash))
+    {
+        generatePlotImage ( chart_file );
+        markGeneratedFile(chart_file, hash);
+    }
 
     std::ostringstream f;
     f<<
@@ -196,7 +196,13 @@ std::string PolarContourChart::latexRepresentation(
 {
     auto chart_file=cleanLatexImageFileName ( name+".png" );
 
-    generatePlotImage ( fsi.additionalFiles->directory/chart_file );
+    auto chart_path = fsi.additionalFiles->directory/chart_file;
+    auto hash=contentHash();
+    if (!generatedFileIsUpToDate(chart_path, hash))
+    {
+        generatePlotImage ( chart_path );
+        markGeneratedFile(chart_path, hash);
+    }
 
     //f<< "\\includegraphics[keepaspectratio,width=\\textwidth]{" << cleanSymbols(imagePath_.c_str()) << "}\n";
     std::ostringstream f;
@@ -64,7 +64,13 @@ std::string Image::latexRepresentation (
     int documentHierarchyLevel,
     const FileStorageInfo& fsi ) const
 {
-  copyTo(fsi.additionalFiles->directory/fileName(), true);
+  auto image_path = fsi.additionalFiles->directory/fileName();
+  auto hash=contentHash();
+  if (!generatedFileIsUpToDate(image_path, hash))
+  {
+    copyTo(image_path, true);
+    markGeneratedFile(image_path, hash);
+  }
 
   std::ostringstream f;
   f<<
@@ -32,7 +32,9 @@
 #include <fstream>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <ctime>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -241,6 +243,18 @@ ResultSet::reportDataPath(const boost::filesystem::path &outFileName)
 
 
 
+boost::filesystem::path
+ResultSet::reportBuildPath(const boost::filesystem::path &outFileName)
+{
+    return
+        outFileName.parent_path() /
+        ( "."+outFileName.stem().string()+".build" )
+        ;
+}
+
+
+
+
 void ResultSet::exportDataToFile (
     const std::string& name,
     const boost::filesystem::path& outputdirectory ) const
@@ -326,9 +340,19 @@ void ResultSet::writeLatexFile (
 
     auto reportData = reportDataPath(filepath);
     create_directory ( reportData );
+    auto startTime = std::time(nullptr);
 
     FileStorageInfo fsi(filepath.parent_path(), reportData);
     fsi.elementFilter=outProps.filter;
+    // serial by default: latexRepresentation() and exportDataToFile()
+    // of the elements have not been audited for concurrent use.
+    // The gnuplot chart renderers convert their output with poppler,
+    // which does not guarantee thread safety, and ResultElement
+    // may be subclassed by add-on libraries.
+    if (const char* nt = getenv("INSIGHT_REPORT_THREADS"))
+    {
+        fsi.nThreads=std::max(1, toNumber<int>(nt));
+    }
     content << latexRepresentation (
         "", 0, fsi );
 
@@ -354,15 +378,32 @@ void ResultSet::writeLatexFile (
     reportInput->write(filepath);
     reportTemplate.writeAdditionalFiles(filepath.parent_path());
 
+    std::vector<const ResultElement*> elements;
     for ( auto& i: static_cast<const ResultElement&>(*this) )
     {
         if (auto *re=dynamic_cast<const ResultElement*>(&i))
         {
-            if (ap) ap->stepUp(boost::str(boost::format("Adding %s to report")%re->name()));
-            re->exportDataToFile ( re->name(), reportData );
+            elements.push_back(re);
         }
     }
 
+    std::mutex apMtx;
+    parallelFor(
+        elements.size(),
+        [&](size_t i)
+        {
+            elements[i]->exportDataToFile ( elements[i]->name(), reportData );
+            if (ap)
+            {
+                std::lock_guard<std::mutex> l(apMtx);
+                ap->stepUp(boost::str(boost::format("Added %s to report")%elements[i]->name()));
+            }
+        },
+        fsi.nThreads );
+
+    // data of elements, which were removed since the last run
+    removeStaleFiles(reportData, startTime);
+
     if (ap) ap->stepUp("Finished");
 
 }
@@ -375,58 +416,72 @@ void ResultSet::generatePDF (
     ActionProgress* ap,
     const OutputProperties& outProps ) const
 {
-    if (ap) ap->setNSteps(4);
+  if (ap) ap->setNSteps(4);
   std::string stem = file.filename().stem().string();
 
   boost::filesystem::path report_src = (stem+".tex");
 
-  {
-      CaseDirectory tmp(false);
-
-      auto report_src_out = tmp/report_src;
-      auto dataDir = reportDataPath(report_src_out);
+  // The build directory is kept, so that unchanged charts and images
+  // are not regenerated and the LaTeX auxiliary files are reused.
+  auto buildDir = reportBuildPath(boost::filesystem::absolute(file));
 
-      if (ap) ap->stepUp("Creating temporary directory");
-      create_directory ( dataDir );
-      for ( auto& i: static_cast<const ResultElement&>(*this) )
-      {
-          if (auto *re=dynamic_cast<const ResultElement*>(&i))
-            re->exportDataToFile ( re->name(), dataDir );
-      }
+  if (ap) ap->stepUp("Preparing build directory");
+  if (!exists(buildDir))
+  {
+      create_directories(buildDir);
+  }
 
-     if (ap) ap->stepUp("Creating LaTeX file");
-      writeLatexFile(
-          report_src_out,
-          ap?ap->forkNewAction(99, "Write LaTeX file").get():nullptr,
-          outProps );
+  auto report_src_out = buildDir/report_src;
+  auto dataDir = reportDataPath(report_src_out);
 
-      auto outputFileName = report_src_out;
-      outputFileName.replace_extension(".pdf");
+  if (ap) ap->stepUp("Creating LaTeX file");
+  writeLatexFile(
+      report_src_out,
+      ap?ap->forkNewAction(99, "Write LaTeX file").get():nullptr,
+      outProps );
 
-      if (ap) ap->stepUp("Running PDF compiler");
-      bool success=LatexRunner(report_src_out).build();
+  auto outputFileName = report_src_out;
+  outputFileName.replace_extension(".pdf");
 
-      insight::assertion(
-          boost::filesystem::exists(outputFileName),
-          "pdflatex failed to create output file" );
+  if (ap) ap->stepUp("Running PDF compiler");
+  bool success=LatexRunner(report_src_out).build();
 
-      if (ap) ap->stepUp("Copy data to selected location");
-      boost::filesystem::copy_file(
-          outputFileName,
-          file, copy_option::overwrite_if_exists );
+  insight::assertion(
+      boost::filesystem::exists(outputFileName),
+      "pdflatex failed to create output file" );
 
-      copyDirectoryRecursively( dataDir, file.parent_path()/dataDir.filename(), false );
+  if (ap) ap->stepUp("Copy data to selected location");
+  boost::filesystem::copy_file(
+      outputFileName,
+      file, copy_option::overwrite_if_exists );
 
-      if (!success)
-        throw insight::Exception(
-              "TeX input file was written but could not execute pdflatex successfully.");
+  auto targetDataDir = file.parent_path()/dataDir.filename();
+  copyDirectoryRecursively(
+      dataDir, targetDataDir,
+      false, true );
 
-      if (ap) ap->stepUp("Finished");
+  // remove files, which are no longer part of the report
+  {
+    std::vector<boost::filesystem::path> obsolete;
+    for (recursive_directory_iterator i(targetDataDir), end; i!=end; ++i)
+    {
+      auto rel = make_relative(targetDataDir, i->path());
+      if (is_regular_file(i->path()) && !exists(dataDir/rel))
+      {
+        obsolete.push_back(i->path());
+      }
+    }
+    for (const auto& f: obsolete)
+    {
+      remove(f);
+    }
   }
 
+  if (!success)
+    throw insight::Exception(
+          "TeX input file was written but could not execute pdflatex successfully.");
 
-
-
+  if (ap) ap->stepUp("Finished");
 }
 
 
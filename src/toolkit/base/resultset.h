@@ -140,14 +140,36 @@ public:
     static boost::filesystem::path
     reportDataPath(const boost::filesystem::path& outFileName);
 
+    /**
+     * @brief reportBuildPath
+     * @return
+     * the persistent build directory of generatePDF() for the given output file
+     */
+    static boost::filesystem::path
+    reportBuildPath(const boost::filesystem::path& outFileName);
+
     void exportDataToFile ( const std::string& name, const boost::filesystem::path& outputdirectory ) const override;
 
+    /**
+     * @brief writeLatexFile
+     * write the report and its data directory (see reportDataPath()).
+     * Files in the data directory, which were not produced or reused
+     * in this call, are removed.
+     * The elements are processed in INSIGHT_REPORT_THREADS threads (default: 1,
+     * since not all element implementations are safe for concurrent use).
+     */
     void writeLatexFile(
         const boost::filesystem::path& file,
         ActionProgress* ap=nullptr,
         const OutputProperties& outProps =
             insight::hierarchicalData::Element::OutputProperties() ) const;
 
+    /**
+     * @brief generatePDF
+     * create the report in a build directory next to the output file
+     * (see reportBuildPath()). The build directory is kept, so that
+     * later calls only regenerate changed charts and images.
+     */
     void generatePDF(
         const boost::filesystem::path& file,
         ActionProgress* ap=nullptr,
@@ -2,11 +2,14 @@
 
 #include <cstdlib>
 #include <regex>
+#include <atomic>
+#include <mutex>
 
 #include "base/exception.h"
 #include "base/rapidxml.h"
 #include "base/tools.h"
 #include "boost/format/format_fwd.hpp"
+#include "boost/algorithm/string/predicate.hpp"
 #include "openfoam/openfoamcase.h"
 
 #include "rapidxml/rapidxml_print.hpp"
@@ -170,6 +173,8 @@ void SSHLinuxServer::runRsync
 
   std::vector<std::string> args(uargs);
   args.insert(args.begin(), "--info=progress2");
+  // reuse the multiplexed ssh connection
+  args.insert(args.begin(), "--rsh="+SSHCommand::remoteShellCommand());
 
   RSyncOutputAnalyzer rpa(pf);
   auto job = std::make_shared<Job>("rsync", args);
@@ -181,9 +186,98 @@ void SSHLinuxServer::runRsync
 
 
 
+void SSHLinuxServer::runShardedRsync
+(
+    const std::vector<std::string>& baseOptions,
+    const std::vector<std::string>& options,
+    const std::vector<SourceAndDestination>& shards,
+    std::function<void(int,const std::string&)> pf
+)
+{
+  if (shards.empty()) return;
+
+  std::mutex mtx;
+  std::vector<int> progress(shards.size(), 0);
+  std::atomic<int> nFinished(0);
+
+  auto runShard = [&](size_t i)
+  {
+    auto args = (i==0 ? baseOptions : options);
+    args.push_back(shards[i].first);
+    args.push_back(shards[i].second);
+
+    runRsync(args,
+      [&,i](int p, const std::string& status)
+      {
+        if (pf)
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          progress[i]=p;
+          int total=0;
+          for (auto pi: progress) total+=pi;
+          pf( total/int(progress.size()),
+              str(format("%d/%d finished, %s")
+                  % int(nFinished) % progress.size() % status ) );
+        }
+      }
+    );
+
+    std::lock_guard<std::mutex> lock(mtx);
+    progress[i]=100;
+    ++nFinished;
+  };
+
+  // the first shard creates the target directory
+  runShard(0);
+
+  insight::parallelFor(
+      shards.size()-1,
+      [&](size_t i) { runShard(i+1); },
+      std::max(1, nStreams_) );
+}
+
+
+
+
+std::vector<std::string> SSHLinuxServer::rsyncOptions
+(
+    const std::vector<std::string>& defaultExcludes,
+    const std::vector<std::string>& exclude_pattern,
+    int nStreams
+) const
+{
+  std::vector<std::string> args;
+
+  for (const auto& ex: defaultExcludes)
+  {
+    args.push_back("--exclude");
+    args.push_back(ex);
+  }
+
+  for (const auto& ex: exclude_pattern)
+  {
+    args.push_back("--exclude");
+    args.push_back(ex);
+  }
+
+  if (bwlimit_>0)
+  {
+    // share the bandwidth limit among the streams
+    args.push_back(
+                str(format("--bwlimit=%d")
+                    % std::max(1, bwlimit_/std::max(1, nStreams)) ));
+  }
+
+  return args;
+}
+
+
+
+
 SSHLinuxServer::SSHLinuxServer(const Config& serverConfig)
     : serverConfig_(serverConfig),
-    bwlimit_(-1)
+    bwlimit_(-1),
+    nStreams_(4)
 {
     if (
         !serverConfig_.creationCommand_.empty()
@@ -223,6 +317,10 @@ void SSHLinuxServer::destroyIfPossible()
                 "failed to deallocate execution server"
                 );
         }
+
+        // the master connection may be shared with other servers
+        // on the same host, only close it, when the host is gone
+        SSHCommand::closeSharedConnection(hostName());
     }
 }
 
@@ -339,6 +437,32 @@ int SSHLinuxServer::transferBandWidthLimit() const
     return bwlimit_;
 }
 
+void SSHLinuxServer::setTransferParallelism(int nStreams)
+{
+    nStreams_=std::max(1, nStreams);
+}
+
+int SSHLinuxServer::transferParallelism() const
+{
+    return nStreams_;
+}
+
+
+
+
+namespace
+{
+
+bool isProcessorDirectoryName(const std::string& n)
+{
+  return boost::starts_with(n, "processor");
+}
+
+}
+
+
+
+
 void SSHLinuxServer::syncToRemote
 (
     const boost::filesystem::path& localDir,
@@ -351,42 +475,71 @@ void SSHLinuxServer::syncToRemote
   CurrentExceptionContext ex("upload local directory "+localDir.string()+" to remote location");
   assertRunning();
 
-    std::vector<std::string> args=
-        {
-         "-az",
-         "--delete",
-
-         "--exclude", "*.foam",
-         "--exclude", "postProcessing",
-         "--exclude", "*.socket",
-         "--exclude", "backup",
-         "--exclude", "archive",
-         "--exclude", "mnt_remote"
-        };
+  std::vector<std::string> excl =
+      {
+       "*.foam",
+       "postProcessing",
+       "*.socket",
+       "backup",
+       "archive",
+       "mnt_remote"
+      };
 
-    if (!includeProcessorDirectories)
+  std::vector<std::string> procDirs;
+  if (includeProcessorDirectories && nStreams_>1)
+  {
+    for (const auto& de: boost::filesystem::directory_iterator(localDir))
     {
-        args.push_back("--exclude");
-        args.push_back("processor*");
+      auto n=de.path().filename().string();
+      if (boost::filesystem::is_directory(de.path()) && isProcessorDirectoryName(n))
+        procDirs.push_back(n);
     }
+  }
 
-    for (const auto& ex: exclude_pattern)
+  if (procDirs.size()>1)
+  {
+    // one stream for the case without processor directories
+    // and one per processor directory
+    std::vector<SourceAndDestination> shards;
+    shards.push_back({
+        localDir.string()+"/",
+        hostName()+":"+toUnixPath(remoteDir) });
+    for (const auto& pd: procDirs)
     {
-      args.push_back("--exclude");
-      args.push_back(ex);
+      shards.push_back({
+          (localDir/pd).string()+"/",
+          hostName()+":"+toUnixPath(remoteDir/pd) });
     }
 
-    if (bwlimit_>0)
+    // only the separately transferred processor directories are excluded
+    // from the case stream: stale remote processor directories are deleted
+    auto baseExcl=excl;
+    for (const auto& pd: procDirs)
+      baseExcl.push_back("/"+pd);
+
+    auto baseOpts=rsyncOptions(baseExcl, exclude_pattern, 1);
+    baseOpts.insert(baseOpts.begin(), { "-az", "--delete" });
+
+    auto opts=rsyncOptions(excl, exclude_pattern, nStreams_);
+    opts.insert(opts.begin(), { "-az", "--delete" });
+
+    runShardedRsync(baseOpts, opts, shards, pf);
+  }
+  else
+  {
+    if (!includeProcessorDirectories)
     {
-        args.push_back(
-                    str(format("--bwlimit=%d")
-                        % bwlimit_ ));
+      excl.push_back("/processor*");
     }
 
+    auto args=rsyncOptions(excl, exclude_pattern, 1);
+    args.insert(args.begin(), { "-az", "--delete" });
+
     args.push_back(localDir.string()+"/");
     args.push_back(hostName()+":"+toUnixPath(remoteDir));
 
     runRsync(args, pf);
+  }
 }
 
 
@@ -404,42 +557,65 @@ void SSHLinuxServer::syncToLocal
   CurrentExceptionContext ex("download remote files to local directory");
   assertRunning();
 
-  std::vector<std::string> args;
-
-    args =
+  std::vector<std::string> excl =
     {
-      "-az",
-      //"--exclude", "processor*",
-      "--exclude", "*.foam",
-      "--exclude", "*.socket",
-      "--exclude", "backup",
-      "--exclude", "archive",
-      "--exclude", "mnt_remote"
+      "*.foam",
+      "*.socket",
+      "backup",
+      "archive",
+      "mnt_remote"
     };
 
-    if (!includeProcessorDirectories)
+  std::vector<std::string> procDirs;
+  if (includeProcessorDirectories && nStreams_>1)
+  {
+    for (const auto& sd: listRemoteSubdirectories(remoteDir))
     {
-        args.push_back("--exclude");
-        args.push_back("processor*");
+      if (isProcessorDirectoryName(sd.string()))
+        procDirs.push_back(sd.string());
     }
+  }
 
-    for (const auto& ex: exclude_pattern)
+  if (procDirs.size()>1)
+  {
+    std::vector<SourceAndDestination> shards;
+    shards.push_back({
+        hostName()+":"+toUnixPath(remoteDir)+"/",
+        localDir.string() });
+    for (const auto& pd: procDirs)
     {
-      args.push_back("--exclude");
-      args.push_back(ex);
+      shards.push_back({
+          hostName()+":"+toUnixPath(remoteDir/pd)+"/",
+          (localDir/pd).string() });
     }
 
-    if (bwlimit_>0)
+    auto baseExcl=excl;
+    for (const auto& pd: procDirs)
+      baseExcl.push_back("/"+pd);
+
+    auto baseOpts=rsyncOptions(baseExcl, exclude_pattern, 1);
+    baseOpts.insert(baseOpts.begin(), "-az");
+
+    auto opts=rsyncOptions(excl, exclude_pattern, nStreams_);
+    opts.insert(opts.begin(), "-az");
+
+    runShardedRsync(baseOpts, opts, shards, pf);
+  }
+  else
+  {
+    if (!includeProcessorDirectories)
     {
-        args.push_back(
-                    str(format("--bwlimit=%d")
-                        % bwlimit_ ));
+      excl.push_back("/processor*");
     }
 
+    auto args=rsyncOptions(excl, exclude_pattern, 1);
+    args.insert(args.begin(), "-az");
+
     args.push_back(hostName()+":"+toUnixPath(remoteDir)+"/");
     args.push_back(localDir.string());
 
     runRsync(args, pf);
+  }
 }
 
 
@@ -494,7 +670,9 @@ SSHLinuxServer::SSHTunnelPortMapping::SSHTunnelPortMapping(
 
 //  args.push_back( server() );
 
-  SSHCommand sc(cfg.hostName_, args);
+  // the tunnel process must not become or use the shared master connection:
+  // forwardings would otherwise outlive the tunnel process
+  SSHCommand sc(cfg.hostName_, args, false);
   tunnelProcess_=
       boost::process::child
       (
@@ -55,6 +55,7 @@ public:
 protected:
   Config serverConfig_;
   int bwlimit_;
+  int nStreams_;
 
   void runRsync
   (
@@ -62,6 +63,29 @@ protected:
       std::function<void(int,const std::string&)> pf
   );
 
+  typedef std::pair<std::string, std::string> SourceAndDestination;
+
+  /**
+   * @brief runShardedRsync
+   * transfer the first source/destination pair using baseOptions,
+   * then the remaining pairs over up to nStreams_ concurrent rsync streams.
+   * Progress is reported as the average over all pairs.
+   */
+  void runShardedRsync
+  (
+      const std::vector<std::string>& baseOptions,
+      const std::vector<std::string>& options,
+      const std::vector<SourceAndDestination>& shards,
+      std::function<void(int,const std::string&)> pf
+  );
+
+  std::vector<std::string> rsyncOptions
+  (
+      const std::vector<std::string>& defaultExcludes,
+      const std::vector<std::string>& exclude_pattern,
+      int nStreams
+  ) const;
+
 
 public:
   SSHLinuxServer(const Config& serverConfig);
@@ -98,6 +122,9 @@ public:
   void setTransferBandWidthLimit(int kBPerSecond) override;
   int transferBandWidthLimit() const override;
 
+  void setTransferParallelism(int nStreams) override;
+  int transferParallelism() const override;
+
   void syncToRemote
   (
       const boost::filesystem::path& localDir,
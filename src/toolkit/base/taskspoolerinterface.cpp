@@ -53,6 +53,7 @@ TaskSpoolerInterface::TaskSpoolerInterface(const boost::filesystem::path& socket
 TaskSpoolerInterface::~TaskSpoolerInterface()
 {
   stopTail();
+  unsubscribeJobEvents();
 
   auto jl=jobs();
   if (! (jl.hasRunningJobs() || jl.hasQueuedJobs()) )
@@ -376,6 +377,149 @@ void TaskSpoolerInterface::stopTail()
 }
 
 
+bool TaskSpoolerInterface::parseJobEvent(const std::string& line, Job& j)
+{
+  // <id> <event> <errorlevel> <wait> <run> <len>:<output> <command>
+  // the output file name is length-prefixed, the command is the rest of the line,
+  // both may contain spaces
+  static const boost::regex re_e(
+        "^([0-9]+) ([^ ]+) (-?[0-9]+) ([^ ]+) ([^ ]+) ([0-9]+):" );
+
+  boost::smatch m;
+  if (!boost::regex_search(line, m, re_e, boost::match_continuous))
+    return false;
+
+  auto outputBegin = size_t(m.length(0));
+  auto outputLength = boost::lexical_cast<size_t>(m[6]);
+  if ( (outputBegin+outputLength >= line.size())
+       || (line[outputBegin+outputLength]!=' ') )
+    return false;
+
+  j.id=boost::lexical_cast<int>(m[1]);
+
+  if (m[2]=="running")
+    j.state=Running;
+  else if (m[2]=="queued")
+    j.state=Queued;
+  else if (m[2]=="finished" || m[2]=="skipped")
+    j.state=Finished;
+  else if (m[2]=="removed")
+    j.state=Removed;
+  else
+    j.state=Unknown;
+
+  j.elevel=boost::lexical_cast<int>(m[3]);
+  j.waitTime=toNumber<double>(m[4]);
+  j.runTime=toNumber<double>(m[5]);
+  j.output = boost::filesystem::path(line.substr(outputBegin, outputLength));
+  j.commandLine=line.substr(outputBegin+outputLength+1);
+
+  return true;
+}
+
+
+void TaskSpoolerInterface::subscribeJobEvents(JobEventCallback callback)
+{
+  unsubscribeJobEvents();
+
+  events_out_.reset(new boost::process::ipstream);
+  try
+  {
+    if (server_)
+    {
+      // print the remote pid first: terminating the local ssh
+      // does not stop the remote process
+      std::ostringstream cmd;
+      cmd << "echo $$; TS_SOCKET="<<socket_.string()<<" exec tsp -M";
+
+      events_c_ = server_->launchCommand(
+            cmd.str(),
+            boost::process::std_out > *events_out_,
+            boost::process::std_in < boost::process::null
+            );
+    }
+    else
+    {
+      events_c_.reset(new boost::process::child(
+                        boost::process::search_path("tsp"),
+                        boost::process::args("-M"),
+                        env_,
+                        boost::process::std_out > *events_out_,
+                        boost::process::std_in < boost::process::null
+                        ));
+    }
+  }
+  catch (const boost::process::process_error& e)
+  {
+    throw insight::Exception(std::string("Could not set up task spooler subprocess!\nMessage: ")+e.what());
+  }
+
+  if (!events_c_->running())
+    throw insight::Exception("Could not execute task spooler executable!");
+
+  if (server_)
+  {
+    std::string pidLine;
+    if (!std::getline(*events_out_, pidLine))
+      throw insight::Exception("Could not start task spooler event subscription on remote server!");
+    events_remote_pid_ = toNumber<int>(pidLine);
+  }
+
+  events_thread_.reset(new std::thread(
+    [this,callback]()
+    {
+      std::string line;
+      while (std::getline(*events_out_, line))
+      {
+        Job j;
+        if (parseJobEvent(line, j))
+        {
+          callback(j);
+        }
+        else
+        {
+          insight::dbg()<<"unexpected task spooler event: "<<line<<std::endl;
+        }
+      }
+    }
+  ));
+}
+
+
+bool TaskSpoolerInterface::isSubscribed() const
+{
+  return events_c_ && events_c_->valid() && events_c_->running();
+}
+
+
+void TaskSpoolerInterface::unsubscribeJobEvents()
+{
+  if (server_ && events_remote_pid_>0)
+  {
+    server_->executeCommand(
+          "kill "+std::to_string(events_remote_pid_), false );
+    events_remote_pid_ = -1;
+  }
+
+  if (isSubscribed())
+  {
+    events_c_->terminate();
+  }
+
+  if (events_thread_)
+  {
+    if (events_thread_->joinable())
+    {
+      events_thread_->join();
+    }
+    events_thread_.reset();
+  }
+
+  events_c_.reset();
+  events_out_.reset();
+}
+
+
 int TaskSpoolerInterface::startJob(const std::vector<std::string>& commandline)
 {
   if (server_)
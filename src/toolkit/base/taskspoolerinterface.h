@@ -6,6 +6,10 @@
 #include "boost/process.hpp"
 #include "boost/asio/io_service.hpp"
 
+#include <functional>
+#include <memory>
+#include <thread>
+
 
 namespace insight
 {
@@ -32,7 +36,7 @@ class TaskSpoolerInterface
   void read_complete(const boost::system::error_code& error, size_t bytes_transferred);
 
 public:
-  enum JobState { Running, Queued, Finished, Unknown };
+  enum JobState { Running, Queued, Finished, Unknown, Removed };
 
   struct Job
   {
@@ -41,8 +45,12 @@ public:
     boost::filesystem::path output;
     int elevel;
     std::string commandLine;
+    /** time waited in queue and run time in seconds, only set in job events */
+    double waitTime = 0., runTime = 0.;
   };
 
+  typedef std::function<void(const Job&)> JobEventCallback;
+
   struct JobList
   : public std::vector<Job>
   {
@@ -51,6 +59,13 @@ public:
     bool hasFailedJobs() const;
   };
 
+private:
+  std::unique_ptr<boost::process::ipstream> events_out_;
+  std::unique_ptr<boost::process::child> events_c_;
+  std::unique_ptr<std::thread> events_thread_;
+  /** pid of the remote tsp -M process, if subscribed to a remote queue */
+  int events_remote_pid_ = -1;
+
 public:
   TaskSpoolerInterface(const boost::filesystem::path& socket, RemoteServerPtr server = RemoteServerPtr() );
   ~TaskSpoolerInterface();
@@ -66,6 +81,22 @@ public:
   bool isTailRunning() const;
   void stopTail();
 
+  // =============================
+  // job state notifications
+
+  /**
+   * @brief subscribeJobEvents
+   * receive the state of all jobs and then every job state transition
+   * (queued, running, finished, removed) pushed by the spooler server.
+   * This keeps a single connection open instead of polling jobs().
+   * The callback is invoked from a background thread.
+   */
+  void subscribeJobEvents(JobEventCallback callback);
+  bool isSubscribed() const;
+  void unsubscribeJobEvents();
+
+  static bool parseJobEvent(const std::string& line, Job& job);
+
   // =============================
   // jobs
   int startJob(const std::vector<std::string>& commandline);
@@ -18,9 +18,16 @@
  */
 
 #include "tools.h"
+#include <atomic>
 #include <fstream>
 #include <cstdlib>
+#include <mutex>
+#include <thread>
 #include <dlfcn.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
 
 #include "base/boost_include.h"
 #include "boost/thread.hpp"
@@ -467,8 +474,12 @@ const boost::filesystem::path& TemporaryFile::path() const
 
 
 
-SSHCommand::SSHCommand(const std::string& hostName, const std::vector<std::string>& arguments)
-  : hostName_(hostName), args_(arguments)
+SSHCommand::SSHCommand(
+    const std::string& hostName,
+    const std::vector<std::string>& arguments,
+    bool shareConnection )
+  : hostName_(hostName), args_(arguments),
+    shareConnection_(shareConnection)
 {
 }
 
@@ -488,10 +499,122 @@ std::vector<std::string> SSHCommand::arguments() const
   a.insert(a.begin(), { "-load", hostName_, "-no-antispoof", "-batch" });
 #else
   a.insert(a.begin(), { hostName_ });
+  if (shareConnection_)
+  {
+    auto so = connectionSharingOptions();
+    a.insert(a.begin(), so.begin(), so.end());
+  }
 #endif
   return a;
 }
 
+std::vector<std::string> SSHCommand::connectionSharingOptions()
+{
+#if defined(WIN32)
+  return {};
+#else
+  if (getenv("INSIGHT_SSH_NO_MULTIPLEXING"))
+    return {};
+
+  static std::vector<std::string> opts = []()
+  {
+    std::vector<std::string> o;
+    try
+    {
+      auto sd = boost::filesystem::temp_directory_path()
+                / str(format("insight-ssh-%d") % getuid());
+
+      if (!boost::filesystem::exists(sd))
+      {
+        boost::filesystem::create_directories(sd);
+        boost::filesystem::permissions(sd, boost::filesystem::owner_all);
+      }
+
+      // the directory is in a world-writable location:
+      // only use it, if it is private to the current user
+      struct stat st;
+      if ( ::lstat(sd.string().c_str(), &st)!=0
+           || !S_ISDIR(st.st_mode)
+           || st.st_uid!=::getuid()
+           || (st.st_mode & 0777)!=0700 )
+      {
+        insight::Warning(
+              "directory for SSH control sockets is not owned by the current user"
+              " or not private, connection multiplexing disabled: %s",
+              sd.string().c_str() );
+        return o;
+      }
+
+      // %C: hash of local host, remote host, port and user
+      auto cp = (sd/"%C").string();
+
+      // unix socket path length is limited to 108 chars incl. hash
+      if (cp.size()+40 < 100)
+      {
+        o = {
+          "-o", "ControlMaster=auto",
+          "-o", "ControlPath="+cp,
+          "-o", "ControlPersist=600"
+        };
+      }
+      else
+      {
+        insight::Warning(
+              "path for SSH control sockets too long, connection multiplexing disabled: %s",
+              sd.string().c_str() );
+      }
+    }
+    catch (const std::exception& e)
+    {
+      insight::Warning(
+            "could not set up directory for SSH control sockets, connection multiplexing disabled: %s",
+            e.what() );
+    }
+    return o;
+  }();
+
+  return opts;
+#endif
+}
+
+std::string SSHCommand::remoteShellCommand()
+{
+  // rsync splits the command at spaces, quotes preserve them
+  auto quote = [](const std::string& a)
+  {
+    if (a.find('"')==std::string::npos)
+      return "\""+a+"\"";
+    insight::assertion(
+          a.find('\'')==std::string::npos,
+          "cannot quote argument for remote shell command: %s", a.c_str() );
+    return "'"+a+"'";
+  };
+
+  std::string cmd = quote(ExternalPrograms::path("ssh").string());
+  for (const auto& o: connectionSharingOptions())
+  {
+    cmd += " "+quote(o);
+  }
+  return cmd;
+}
+
+void SSHCommand::closeSharedConnection(const std::string& hostName)
+{
+#if !defined(WIN32)
+  auto so = connectionSharingOptions();
+  if (!so.empty())
+  {
+    so.insert(so.end(), { "-O", "exit", hostName });
+    boost::process::system(
+          ExternalPrograms::path("ssh"), boost::process::args(so),
+          boost::process::std_out > boost::process::null,
+          boost::process::std_err > boost::process::null,
+          boost::process::std_in < boost::process::null
+          );
+  }
+#endif
+}
+
 
 
 
@@ -698,7 +821,8 @@ ExecTimer::~ExecTimer()
 void copyDirectoryRecursively(
     const path& sourceDir,
     const path& destinationDir,
-    bool failIfTargetExists )
+    bool failIfTargetExists,
+    bool skipUnchanged )
 {
     if (!exists(sourceDir) || !is_directory(sourceDir))
     {
@@ -733,10 +857,17 @@ void copyDirectoryRecursively(
             copy_symlink(from, to);
         else if (is_directory(s))
         {
-            copyDirectoryRecursively(from, to, failIfTargetExists);
+            copyDirectoryRecursively(from, to, failIfTargetExists, skipUnchanged);
         }
         else if (is_regular_file(s))
         {
+            if ( skipUnchanged && exists(to)
+                 && file_size(to)==file_size(from)
+                 && last_write_time(to)>=last_write_time(from) )
+            {
+                continue;
+            }
+
             copy_file(from, to,
                       failIfTargetExists ? copy_option::fail_if_exists
                                          : copy_option::overwrite_if_exists);
@@ -745,6 +876,59 @@ void copyDirectoryRecursively(
 }
 
 
+
+
+void parallelFor(
+    size_t n,
+    const std::function<void(size_t)>& f,
+    int nThreads )
+{
+    if (nThreads<=0)
+    {
+        nThreads=std::max(1u, std::thread::hardware_concurrency());
+    }
+    nThreads=std::min<size_t>(nThreads, n);
+
+    if (nThreads<=1)
+    {
+        for (size_t i=0; i<n; ++i)
+            f(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr firstError;
+    std::mutex errorMtx;
+
+    auto worker = [&]()
+    {
+        for (size_t i=next++; i<n; i=next++)
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> l(errorMtx);
+                if (!firstError)
+                    firstError=std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i=1; i<nThreads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t: threads)
+        t.join();
+
+    if (firstError)
+        std::rethrow_exception(firstError);
+}
+
+
 void LineMesh_to_OrderedPointTable::calcConnectionInfo(vtkCellArray* lines)
 {
     pointCells_.clear();
@@ -327,17 +327,50 @@ public:
 /**
  * @brief The SSHCommand class
  * wraps SSH command with unique interface in Linux and Windows
+ *
+ * On Linux, OpenSSH connection multiplexing is used by default:
+ * all commands to the same host share one persistent master connection,
+ * which is kept open for some time after the last command finished.
+ * Only the first command pays for the handshake and authentication.
+ * Set INSIGHT_SSH_NO_MULTIPLEXING to disable.
  */
 class SSHCommand
 {
   std::string hostName_;
   std::vector<std::string> args_;
+  bool shareConnection_;
 
 public:
-  SSHCommand(const std::string& hostName, const std::vector<std::string>& arguments);
+  SSHCommand(
+      const std::string& hostName,
+      const std::vector<std::string>& arguments,
+      bool shareConnection = true );
 
   boost::filesystem::path command() const;
   std::vector<std::string> arguments() const;
+
+  /**
+   * @brief connectionSharingOptions
+   * @return
+   * ssh options for connection multiplexing,
+   * empty, if multiplexing is disabled or unavailable
+   */
+  static std::vector<std::string> connectionSharingOptions();
+
+  /**
+   * @brief remoteShellCommand
+   * @return
+   * command line of the ssh command without host and arguments,
+   * with quoted arguments, suitable for rsync's --rsh option
+   */
+  static std::string remoteShellCommand();
+
+  /**
+   * @brief closeSharedConnection
+   * terminate the master connection to the given host, if there is one.
+   * This affects all users of the connection.
+   */
+  static void closeSharedConnection(const std::string& hostName);
 };
 
 
@@ -400,10 +433,30 @@ public:
 
 
 
+/**
+ * @brief copyDirectoryRecursively
+ * @param skipUnchanged
+ * do not copy files, which exist in the destination with the same size
+ * and which are not older than the source
+ */
 void copyDirectoryRecursively(
     const boost::filesystem::path& sourceDir,
     const boost::filesystem::path& destinationDir,
-    bool failIfTargetExists = true );
+    bool failIfTargetExists = true,
+    bool skipUnchanged = false );
+
+
+
+
+/**
+ * @brief parallelFor
+ * call f(i) for i=0..n-1 on nThreads threads (all hardware threads, if <=0).
+ * The first exception, which is thrown in f, is rethrown after all threads finished.
+ */
+void parallelFor(
+    size_t n,
+    const std::function<void(size_t)>& f,
+    int nThreads = 0 );
 
 
 
@@ -1,13 +1,18 @@
 #include "vtkrendering.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
+#include <mutex>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkAppendPolyData.h>
 #include <vtkTransform.h>
 
 #include "boost/concept_check.hpp"
 #include "boost/range/adaptor/indexed.hpp"
+#include "boost/lexical_cast.hpp"
+#include "boost/algorithm/string/predicate.hpp"
 #include "vtkSmartPointer.h"
 #include "vtkOpenFOAMReader.h"
 #include "vtkArrowSource.h"
@@ -70,6 +75,9 @@
 #include "vtkCellSizeFilter.h"
 #include "vtkPolyDataNormals.h"
 #include "vtkCellCenters.h"
+#include "vtkTrivialProducer.h"
+#include "vtkMapper.h"
+#include "vtkScalarsToColors.h"
 
 #include "base/exception.h"
 #include "base/spatialtransformation.h"
@@ -1449,8 +1457,17 @@ std::set<int> MultiBlockDataSetExtractor::flatIndices(const std::vector<std::str
 boost::mutex VTKlock;
 
 VTKOffscreenScene::VTKOffscreenScene()
-    : boost::mutex::scoped_lock(VTKlock)
+    : VTKOffscreenScene(true)
+{}
+
+
+VTKOffscreenScene::VTKOffscreenScene(bool lockVTK)
+    : boost::mutex::scoped_lock(VTKlock, boost::defer_lock)
 {
+  if (lockVTK)
+  {
+    lock();
+  }
 
   vtkRenderingOpenGL2_AutoInit_Construct();
   vtkRenderingFreeType_AutoInit_Construct();
@@ -1654,6 +1671,321 @@ void VTKOffscreenScene::setParallelScale(
   }
 }
 
+VTKOffscreenScene::RenderJob::RenderJob(
+    const insight::View& v,
+    const boost::filesystem::path& f )
+  : view(v),
+    imageFile(f)
+{}
+
+
+
+
+void VTKOffscreenScene::setRenderTime(double)
+{
+  throw insight::Exception(
+      "this scene has no time information!" );
+}
+
+
+
+
+namespace
+{
+
+
+/**
+ * independent copies of the actors of a scene, taken at one time step.
+ * The datasets are shallow copies, which are not modified afterwards.
+ */
+struct SceneSnapshot
+{
+  struct ActorCopy
+  {
+    vtkSmartPointer<vtkActor> actor;
+    vtkSmartPointer<vtkMapper> mapper;
+    vtkSmartPointer<vtkDataObject> input;
+  };
+
+  std::vector<ActorCopy> actors;
+  std::vector<vtkSmartPointer<vtkActor2D> > actors2D;
+
+  SceneSnapshot(vtkRenderer* renderer)
+  {
+    if (renderer->GetVolumes()->GetNumberOfItems()>0)
+    {
+      insight::Warning("volumes are not supported in batch rendering and will be omitted.");
+    }
+
+    auto aa = renderer->GetActors();
+    aa->InitTraversal();
+    for (vtkActor* a = aa->GetNextItem(); a!=nullptr; a = aa->GetNextItem())
+    {
+      auto *m = a->GetMapper();
+      if (!m) continue;
+
+      m->Update();
+      auto *in = m->GetInputDataObject(0, 0);
+      if (!in) continue;
+
+      ActorCopy ac;
+      ac.input = vtkSmartPointer<vtkDataObject>::Take(in->NewInstance());
+      vtkShallowCopy(ac.input, in);
+      if (auto *ds = vtkDataSet::SafeDownCast(ac.input))
+      {
+        ds->ComputeBounds();
+      }
+
+      ac.mapper = vtkSmartPointer<vtkMapper>::Take(m->NewInstance());
+      ac.mapper->ShallowCopy(m);
+      if (auto *lut = m->GetLookupTable())
+      {
+        auto lc = vtkSmartPointer<vtkScalarsToColors>::Take(lut->NewInstance());
+        lc->DeepCopy(lut);
+        ac.mapper->SetLookupTable(lc);
+      }
+
+      ac.actor = vtkSmartPointer<vtkActor>::Take(a->NewInstance());
+      ac.actor->ShallowCopy(a);
+      auto p = vtkSmartPointer<vtkProperty>::New();
+      p->DeepCopy(a->GetProperty());
+      ac.actor->SetProperty(p);
+
+      actors.push_back(ac);
+    }
+
+    auto a2 = renderer->GetActors2D();
+    a2->InitTraversal();
+    for (vtkActor2D* a = a2->GetNextItem(); a!=nullptr; a = a2->GetNextItem())
+    {
+      auto ac = vtkSmartPointer<vtkActor2D>::Take(a->NewInstance());
+      ac->ShallowCopy(a);
+      if (auto *sb = vtkScalarBarActor::SafeDownCast(ac))
+      {
+        if (auto *lut = sb->GetLookupTable())
+        {
+          auto lc = vtkSmartPointer<vtkScalarsToColors>::Take(lut->NewInstance());
+          lc->DeepCopy(lut);
+          sb->SetLookupTable(lc);
+        }
+      }
+      actors2D.push_back(ac);
+    }
+  }
+};
+
+
+/**
+ * one render window of a batch
+ */
+class BatchRenderScene
+    : public VTKOffscreenScene
+{
+public:
+  BatchRenderScene(vtkRenderWindow* master, vtkRenderer* masterRenderer)
+    : VTKOffscreenScene(false)
+  {
+    renderWindow_->SetSize(master->GetSize());
+    renderWindow_->SetMultiSamples(master->GetMultiSamples());
+    renderer_->SetBackground(masterRenderer->GetBackground());
+  }
+
+  void render(const SceneSnapshot& sn, const RenderJob& job)
+  {
+    clearScene();
+
+    for (const auto& ac: sn.actors)
+    {
+      auto m = vtkSmartPointer<vtkMapper>::Take(ac.mapper->NewInstance());
+      m->ShallowCopy(ac.mapper);
+      m->SetInputDataObject(0, ac.input);
+
+      auto a = vtkSmartPointer<vtkActor>::Take(ac.actor->NewInstance());
+      a->ShallowCopy(ac.actor);
+      a->SetMapper(m);
+      auto p = vtkSmartPointer<vtkProperty>::New();
+      p->DeepCopy(ac.actor->GetProperty());
+      if (job.representation)
+      {
+        p->SetRepresentation(*job.representation);
+      }
+      a->SetProperty(p);
+
+      renderer_->AddActor(a);
+    }
+
+    for (const auto& ac: sn.actors2D)
+    {
+      auto a = vtkSmartPointer<vtkActor2D>::Take(ac->NewInstance());
+      a->ShallowCopy(ac);
+      renderer_->AddActor2D(a);
+    }
+
+    setupActiveCamera(job.view);
+    if (job.parallelScale)
+      setParallelScale(*job.parallelScale);
+    else
+      fitAll();
+
+    exportImage(job.imageFile);
+  }
+};
+
+
+}
+
+
+
+
+void VTKOffscreenScene::renderBatch(const std::vector<RenderJob>& jobs, int nThreads)
+{
+  CurrentExceptionContext ex("rendering a batch of %d images", int(jobs.size()));
+
+  if (jobs.empty()) return;
+
+  if (nThreads<1)
+  {
+    if (const char* nt = getenv("INSIGHT_VTK_RENDER_THREADS"))
+    {
+      nThreads = boost::lexical_cast<int>(nt);
+    }
+    else
+    {
+      // parallel rendering is opt-in
+      nThreads = 1;
+    }
+  }
+  nThreads = std::max(1, std::min(nThreads, int(jobs.size())));
+
+  // group jobs by time, keep order of first appearance
+  std::vector<std::pair<boost::optional<double>, std::vector<const RenderJob*> > > groups;
+  for (const auto& j: jobs)
+  {
+    auto g = std::find_if(
+        groups.begin(), groups.end(),
+        [&j](const decltype(groups)::value_type& g) { return g.first==j.time; } );
+    if (g==groups.end())
+    {
+      groups.push_back({j.time, {}});
+      g=groups.end()-1;
+    }
+    g->second.push_back(&j);
+  }
+
+  if (nThreads==1)
+  {
+    // render sequentially in this thread,
+    // no thread-safe OpenGL implementation required
+    BatchRenderScene w(renderWindow_, renderer_);
+    for (const auto& g: groups)
+    {
+      if (g.first)
+      {
+        setRenderTime(*g.first);
+      }
+      SceneSnapshot sn(renderer_);
+      for (const auto* j: g.second)
+      {
+        w.render(sn, *j);
+      }
+    }
+    return;
+  }
+
+  // render windows are created in this thread
+  std::vector<std::unique_ptr<BatchRenderScene> > windows;
+  for (int i=0; i<nThreads; ++i)
+  {
+    windows.emplace_back(new BatchRenderScene(renderWindow_, renderer_));
+  }
+
+  typedef std::pair<std::shared_ptr<SceneSnapshot>, const RenderJob*> Pending;
+  std::deque<Pending> queue;
+  bool allQueued=false;
+  std::mutex m;
+  std::condition_variable cv;
+  std::exception_ptr error;
+
+  auto worker = [&](BatchRenderScene& w)
+  {
+    for (;;)
+    {
+      Pending p;
+      {
+        std::unique_lock<std::mutex> l(m);
+        cv.wait(l, [&]() { return !queue.empty() || allQueued; });
+        if (queue.empty()) return;
+        p=queue.front();
+        queue.pop_front();
+      }
+      cv.notify_all();
+
+      try
+      {
+        w.render(*p.first, *p.second);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> l(m);
+        if (!error) error=std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (auto& w: windows)
+  {
+    threads.emplace_back(worker, std::ref(*w));
+  }
+
+  try
+  {
+    for (const auto& g: groups)
+    {
+      // read the next time step, while the previous one is still rendered
+      if (g.first)
+      {
+        setRenderTime(*g.first);
+      }
+      auto sn = std::make_shared<SceneSnapshot>(renderer_);
+
+      std::unique_lock<std::mutex> l(m);
+      // keep at most two snapshots alive
+      cv.wait(l, [&]() { return queue.empty(); });
+      for (const auto* j: g.second)
+      {
+        queue.push_back({sn, j});
+      }
+      l.unlock();
+      cv.notify_all();
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> l(m);
+    queue.clear();
+    if (!error) error=std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> l(m);
+    allQueued=true;
+  }
+  cv.notify_all();
+  for (auto& t: threads)
+  {
+    t.join();
+  }
+
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+
+
+
 void VTKOffscreenScene::fitAll(double mult)
 {
   double bnds[6] = {DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX};
@@ -1783,24 +2115,29 @@ void VTKOffscreenScene::addDiagonalViews(
         baseCS,
         cameraDistance );
 
-    hierarchicalData::Ordering o;
-
+    std::vector<std::unique_ptr<TemporaryFile> > images;
+    std::vector<RenderJob> jobs;
     for (const auto& lv: views)
     {
-        setupActiveCamera(lv.second);
+        images.emplace_back(new TemporaryFile("exportedImage-%%%%%%.png"));
+        jobs.emplace_back(lv.second, images.back()->path());
+        jobs.back().parallelScale = parallelScale;
+    }
 
-        if (!parallelScale)
-            fitAll();
-        else
-            setParallelScale(*parallelScale);
+    renderBatch(jobs);
 
+    hierarchicalData::Ordering o;
+
+    auto img = images.begin();
+    for (const auto& lv: views)
+    {
         std::string name=
             basefilename.filename().stem().string()+"_"+lv.first,
             fname=name+".png";
 
         results.insert<Image> (
                    name,
-                   FileContainer(*exportImage(), fname),
+                   FileContainer(**(img++), fname),
                    viewDescription+" ("+lv.second.title+")", ""
                    ).setOrder(o.next());
     }
@@ -1831,11 +2168,176 @@ void VTKOffscreenScene::addDiagonalViews(
 
 //vtkStandardNewMacro(ModifiedPOpenFOAMReader);
 
+namespace
+{
+
+
+/**
+ * the case directory from the path, which was given to the reader
+ * (either the case directory itself or a file inside it or inside "system")
+ */
+boost::filesystem::path openFOAMCaseDirectory(const boost::filesystem::path& casepath)
+{
+  auto dir = boost::filesystem::is_directory(casepath) ? casepath : casepath.parent_path();
+  if (dir.filename()=="system")
+  {
+    dir=dir.parent_path();
+  }
+  return dir;
+}
+
+
+double latestTimeDirectory(const boost::filesystem::path& dir)
+{
+  double latest = -std::numeric_limits<double>::max();
+  if (boost::filesystem::is_directory(dir))
+  {
+    for (boost::filesystem::directory_iterator i(dir), end; i!=end; ++i)
+    {
+      if (boost::filesystem::is_directory(i->status()))
+      {
+        try
+        {
+          latest = std::max(
+              latest,
+              boost::lexical_cast<double>(i->path().filename().string()) );
+        }
+        catch (const boost::bad_lexical_cast&)
+        {}
+      }
+    }
+  }
+  return latest;
+}
+
+
+std::vector<boost::filesystem::path> processorDirectories(const boost::filesystem::path& caseDir)
+{
+  std::vector<boost::filesystem::path> res;
+  for (int i=0; ; ++i)
+  {
+    auto pd = caseDir / str(format("processor%d")%i);
+    if (!boost::filesystem::is_directory(pd))
+      break;
+    res.push_back(pd);
+  }
+  return res;
+}
+
+
+/**
+ * merge the outputs of the processor readers.
+ * Blocks are matched by name, since the processors have
+ * different processor boundary patches. Those are omitted.
+ */
+vtkSmartPointer<vtkDataObject> mergeProcessorPieces(
+    const std::vector<vtkDataObject*>& pieces )
+{
+  if (pieces.empty())
+    return nullptr;
+
+  if (vtkMultiBlockDataSet::SafeDownCast(pieces.front()))
+  {
+    std::vector<std::string> names;
+    std::map<std::string, std::vector<vtkDataObject*> > blocks;
+    for (auto* p: pieces)
+    {
+      auto *mb = vtkMultiBlockDataSet::SafeDownCast(p);
+      insight::assertion(
+          mb!=nullptr,
+          "inconsistent block structure in processor directories" );
+
+      for (unsigned int i=0; i<mb->GetNumberOfBlocks(); ++i)
+      {
+        std::string name = str(format("block%d")%i);
+        if (mb->HasMetaData(i) && mb->GetMetaData(i)->Has(vtkCompositeDataSet::NAME()))
+        {
+          name = mb->GetMetaData(i)->Get(vtkCompositeDataSet::NAME());
+        }
+        if (boost::starts_with(name, "procBoundary"))
+          continue;
+
+        if (!blocks.count(name))
+          names.push_back(name);
+        auto& bl = blocks[name];
+        if (auto *b = mb->GetBlock(i))
+          bl.push_back(b);
+      }
+    }
+
+    auto merged = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    merged->SetNumberOfBlocks(names.size());
+    for (unsigned int i=0; i<names.size(); ++i)
+    {
+      auto& bl = blocks[names[i]];
+      if (!bl.empty())
+      {
+        merged->SetBlock(i, mergeProcessorPieces(bl));
+      }
+      merged->GetMetaData(i)->Set(vtkCompositeDataSet::NAME(), names[i].c_str());
+    }
+    return merged;
+  }
+
+  // omit empty pieces: the append filters only keep the arrays,
+  // which are present in all inputs
+  std::vector<vtkDataSet*> nonEmpty;
+  bool allPolyData=true;
+  for (auto* p: pieces)
+  {
+    if (auto *ds = vtkDataSet::SafeDownCast(p))
+    {
+      if (ds->GetNumberOfCells()>0)
+      {
+        nonEmpty.push_back(ds);
+        allPolyData = allPolyData && vtkPolyData::SafeDownCast(ds);
+      }
+    }
+  }
+
+  if (nonEmpty.size()<2)
+  {
+    auto *src = nonEmpty.empty() ? pieces.front() : nonEmpty.front();
+    auto copy = vtkSmartPointer<vtkDataObject>::Take(src->NewInstance());
+    copy->ShallowCopy(src);
+    return copy;
+  }
+  else if (allPolyData)
+  {
+    auto app = vtkSmartPointer<vtkAppendPolyData>::New();
+    for (auto* ds: nonEmpty)
+    {
+      app->AddInputData(vtkPolyData::SafeDownCast(ds));
+    }
+    app->Update();
+    return app->GetOutput();
+  }
+  else
+  {
+    auto app = vtkSmartPointer<vtkAppendFilter>::New();
+    app->MergePointsOn();
+    for (auto* ds: nonEmpty)
+    {
+      app->AddInputData(ds);
+    }
+    app->Update();
+    return app->GetOutput();
+  }
+}
+
+
+}
+
+
+
+
 OpenFOAMCaseScene::OpenFOAMCaseScene(
     const boost::filesystem::path& casepath,
     bool readZones,
     int np)
-  : VTKOffscreenScene()
+  : VTKOffscreenScene(),
+    currentTime_(std::numeric_limits<double>::quiet_NaN()),
+    maxCacheSize_(1024*1024)
 {
 #if VTK_MODULE_ENABLE_VTK_ParallelMPI
     auto controller =vtkSmartPointer<vtkMPIController>::New();
@@ -1845,41 +2347,67 @@ OpenFOAMCaseScene::OpenFOAMCaseScene(
   vtkMultiProcessController::SetGlobalController(controller);
 #endif
 
-  ofcase_ = vtkSmartPointer<vtkOpenFOAMReader>::New();
-  ofcase_->SetFileName( casepath.string().c_str() );
-  ofcase_->Update();
+  auto setupReader = [readZones](vtkOpenFOAMReader* r, const boost::filesystem::path& fn)
+  {
+    r->SetFileName( fn.string().c_str() );
+    r->UpdateInformation();
 
-  //ofcase_->SetSkipZeroTime(false);
-//  ofcase_->SetCaseType(
-//      np > 1 ?
-//          vtkPOpenFOAMReader::DECOMPOSED_CASE :
-//          vtkPOpenFOAMReader::RECONSTRUCTED_CASE );
+    //r->SetSkipZeroTime(false);
 
-  ofcase_->SetUse64BitLabels(false);
-  ofcase_->SetUse64BitFloats(true);
+    r->SetUse64BitLabels(false);
+    r->SetUse64BitFloats(true);
 
-  ofcase_->CreateCellToPointOn();
-  ofcase_->AddDimensionsToArrayNamesOff();
+    r->CreateCellToPointOn();
+    r->AddDimensionsToArrayNamesOff();
 
-  ofcase_->EnableAllPatchArrays();
-  ofcase_->EnableAllCellArrays();
-  ofcase_->EnableAllPointArrays();
-  ofcase_->EnableAllLagrangianArrays();
+    r->EnableAllPatchArrays();
+    r->EnableAllCellArrays();
+    r->EnableAllPointArrays();
+    r->EnableAllLagrangianArrays();
 
-  ofcase_->CacheMeshOn();
-  ofcase_->DecomposePolyhedraOn();
-  ofcase_->ListTimeStepsByControlDictOff();
-  if (readZones)
+    r->CacheMeshOn();
+    r->DecomposePolyhedraOn();
+    r->ListTimeStepsByControlDictOff();
+    if (readZones)
+    {
+        r->ReadZonesOn();
+    }
+    else
+    {
+        r->ReadZonesOff();
+    }
+
+    r->UpdateInformation();
+  };
+
+  auto caseDir = openFOAMCaseDirectory(casepath);
+  auto procDirs = processorDirectories(caseDir);
+  if ( !procDirs.empty()
+       && ( np>1
+           || latestTimeDirectory(procDirs.front()) > latestTimeDirectory(caseDir) ) )
   {
-      ofcase_->ReadZonesOn();
+    cout<<"VTK OpenFOAM Reader: reading "<<procDirs.size()<<" processor directories"<<endl;
+
+    for (size_t i=0; i<procDirs.size(); ++i)
+    {
+      processorReaders_.push_back(vtkSmartPointer<vtkOpenFOAMReader>::New());
+    }
+    parallelFor(
+        procDirs.size(),
+        [&](size_t i)
+        {
+          setupReader(processorReaders_[i], procDirs[i]/"system"/"controlDict");
+        } );
+
+    ofcase_ = processorReaders_.front();
+    decomposedOutput_ = vtkSmartPointer<vtkTrivialProducer>::New();
   }
   else
   {
-      ofcase_->ReadZonesOff();
+    ofcase_ = vtkSmartPointer<vtkOpenFOAMReader>::New();
+    setupReader(ofcase_, casepath);
   }
 
-  ofcase_->Update();
-
   auto execInfo = ofcase_->GetExecutive()->GetOutputInformation(0);
   int nt = execInfo->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
 //  times_ = ofcase_->GetTimeValues();
@@ -1895,22 +2423,160 @@ OpenFOAMCaseScene::OpenFOAMCaseScene(
 
   setTimeValue( times_.back() );
 
-  for (int i=0; i<ofcase_->GetNumberOfPatchArrays(); i++)
+  if (isDecomposed())
+  {
+    // block indices in the merged dataset
+    auto oo=GetOutput();
+    for (unsigned int i=0; i<oo->GetNumberOfBlocks(); i++)
+    {
+      auto pm = vtkMultiBlockDataSet::SafeDownCast(oo->GetBlock(i));
+      if ( pm && std::string(oo->GetMetaData(i)->Get(vtkCompositeDataSet::NAME()))=="Patches" )
+      {
+        MultiBlockDataSetExtractor mbe(oo);
+        for (unsigned int j=0; j<pm->GetNumberOfBlocks(); j++)
+        {
+          std::string pn(pm->GetMetaData(j)->Get(vtkCompositeDataSet::NAME()));
+          auto idx = mbe.flatIndices({"Patches", pn});
+          if (idx.size()==1)
+          {
+            patches_[pn]=*idx.begin();
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    for (int i=0; i<ofcase_->GetNumberOfPatchArrays(); i++)
+    {
+      patches_[ofcase_->GetPatchArrayName(i)]=i;
+    }
+  }
+}
+
+
+bool OpenFOAMCaseScene::isDecomposed() const
+{
+  return !processorReaders_.empty();
+}
+
+
+void OpenFOAMCaseScene::setMaxCacheSize(unsigned long maxKiB)
+{
+  maxCacheSize_=maxKiB;
+  trimCache();
+}
+
+
+void OpenFOAMCaseScene::trimCache() const
+{
+  unsigned long total=0;
+  for (auto i=cache_.begin(); i!=cache_.end(); )
+  {
+    total += i->size;
+    if (total>maxCacheSize_)
+    {
+      total -= i->size;
+      i = cache_.erase(i);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+
+vtkSmartPointer<vtkDataObject> OpenFOAMCaseScene::cached(
+    const std::string& selection,
+    std::function<vtkSmartPointer<vtkDataObject>()> create ) const
+{
+  CacheKey key(currentTime_, selection);
+
+  for (auto i=cache_.begin(); i!=cache_.end(); ++i)
+  {
+    if (i->key==key)
+    {
+      // move to front, least recently used entries are at the back
+      cache_.splice(cache_.begin(), cache_, i);
+      return cache_.front().data;
+    }
+  }
+
+  auto d = create();
+  if (maxCacheSize_>0)
   {
-    patches_[ofcase_->GetPatchArrayName(i)]=i;
+    cache_.push_front({key, d, d->GetActualMemorySize()});
+    trimCache();
   }
+  return d;
+}
+
+
+vtkAlgorithmOutput* OpenFOAMCaseScene::outputPort() const
+{
+  if (isDecomposed())
+    return decomposedOutput_->GetOutputPort();
+  else
+    return ofcase_->GetOutputPort();
+}
+
+
+vtkMultiBlockDataSet* OpenFOAMCaseScene::GetOutput() const
+{
+  if (isDecomposed())
+    return vtkMultiBlockDataSet::SafeDownCast(
+        decomposedOutput_->GetOutputDataObject(0) );
+  else
+    return ofcase_->GetOutput();
 }
 
-vtkMultiBlockDataSet* OpenFOAMCaseScene::GetOutput()
+void OpenFOAMCaseScene::setRenderTime(double t)
 {
-  return ofcase_->GetOutput();
+  setTimeValue(t);
 }
 
+
 const std::vector<double>& OpenFOAMCaseScene::times() const
 {
   return times_;
 }
 
+
+void OpenFOAMCaseScene::setDecomposedTimeValue(double t)
+{
+  // empty selection: the complete merged dataset
+  auto merged = cached(
+      "",
+      [this,t]() -> vtkSmartPointer<vtkDataObject>
+      {
+        std::vector<vtkSmartPointer<vtkMultiBlockDataSet> > outputs(
+            processorReaders_.size() );
+
+        parallelFor(
+            processorReaders_.size(),
+            [&](size_t i)
+            {
+              auto& r = processorReaders_[i];
+              r->UpdateTimeStep(t);
+              outputs[i] = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+              outputs[i]->ShallowCopy(r->GetOutput());
+            } );
+
+        std::vector<vtkDataObject*> pieces;
+        for (auto& o: outputs)
+        {
+          pieces.push_back(o);
+        }
+        return mergeProcessorPieces(pieces);
+      } );
+
+  auto tp = vtkTrivialProducer::SafeDownCast(decomposedOutput_);
+  tp->SetOutput(merged);
+  tp->Modified();
+}
+
+
 double OpenFOAMCaseScene::setTimeValue(double t)
 {
   auto ti = std::lower_bound(times_.begin(), times_.end(), t);
@@ -1918,8 +2584,20 @@ double OpenFOAMCaseScene::setTimeValue(double t)
       ti!=times_.end(),
       _("no lower bound found for t=%g!"), t );
 
-  auto execInfos = ofcase_->GetExecutive()->GetOutputInformation();
   double tact = *ti;
+  if (tact==currentTime_)
+  {
+    return tact;
+  }
+  currentTime_ = tact;
+
+  if (isDecomposed())
+  {
+    setDecomposedTimeValue(tact);
+    return tact;
+  }
+
+  auto execInfos = ofcase_->GetExecutive()->GetOutputInformation();
   std::cerr<<"tact="<<tact<<std::endl;
   ofcase_->UpdateInformation();
   for (int i=0; i<execInfos->GetNumberOfInformationObjects(); ++i)
@@ -1947,7 +2625,7 @@ void OpenFOAMCaseScene::setTimeIndex(vtkIdType timeId)
 vtkSmartPointer<vtkUnstructuredGridAlgorithm> OpenFOAMCaseScene::internalMeshFilter() const
 {
   auto internal = extractBlocks(
-      MultiBlockDataSetExtractor(ofcase_->GetOutput()).flatIndices(
+      MultiBlockDataSetExtractor(GetOutput()).flatIndices(
           {"internalMesh"} ));
 
   auto af = vtkSmartPointer<vtkCompositeDataToUnstructuredGridFilter>::New();
@@ -1959,9 +2637,18 @@ vtkSmartPointer<vtkUnstructuredGridAlgorithm> OpenFOAMCaseScene::internalMeshFil
 
 vtkSmartPointer<vtkUnstructuredGrid> OpenFOAMCaseScene::internalMesh() const
 {
-  auto af = internalMeshFilter();
-  af->Update();
-  return af->GetOutput();
+  auto c = vtkUnstructuredGrid::SafeDownCast(
+      cached(
+          "internalMesh",
+          [this]() -> vtkSmartPointer<vtkDataObject>
+          {
+            auto af = internalMeshFilter();
+            af->Update();
+            return af->GetOutput();
+          } ) );
+  auto res = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  res->ShallowCopy(c);
+  return res;
 }
 
 
@@ -1984,7 +2671,7 @@ std::vector<std::string> OpenFOAMCaseScene::matchingPatchNames(const std::string
 
 vtkPolyData* OpenFOAMCaseScene::patch(const std::string& name) const
 {
-  auto oo=ofcase_->GetOutput();
+  auto oo=GetOutput();
   for (vtkIdType i=0; i<oo->GetNumberOfBlocks(); i++)
   {
     auto md=oo->GetMetaData(i);
@@ -2009,7 +2696,7 @@ vtkSmartPointer<vtkUnstructuredGridAlgorithm> OpenFOAMCaseScene::patchesFilter(
     const std::string& namePattern) const
 {
   auto patches = extractBlock(
-      MultiBlockDataSetExtractor(ofcase_->GetOutput()).flatIndices(
+      MultiBlockDataSetExtractor(GetOutput()).flatIndices(
           { "Patches", namePattern } ));
 
   auto pf = vtkSmartPointer<vtkCompositeDataToUnstructuredGridFilter>::New();
@@ -2020,9 +2707,18 @@ vtkSmartPointer<vtkUnstructuredGridAlgorithm> OpenFOAMCaseScene::patchesFilter(
 
 vtkSmartPointer<vtkUnstructuredGrid> OpenFOAMCaseScene::patches(const std::string& namePattern) const
 {
-  auto pf = patchesFilter(namePattern);
-  pf->Update();
-  return pf->GetOutput();
+  auto c = vtkUnstructuredGrid::SafeDownCast(
+      cached(
+          "Patches/"+namePattern,
+          [this,&namePattern]() -> vtkSmartPointer<vtkDataObject>
+          {
+            auto pf = patchesFilter(namePattern);
+            pf->Update();
+            return pf->GetOutput();
+          } ) );
+  auto res = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  res->ShallowCopy(c);
+  return res;
 }
 
 vtkSmartPointer<vtkOpenFOAMReader> OpenFOAMCaseScene::ofcase() const
@@ -2065,7 +2761,7 @@ vtkSmartPointer<vtkMultiBlockDataSetAlgorithm> OpenFOAMCaseScene::extractBlocks(
       "no block indices to extract were provided!" );
 
   auto eb = vtkSmartPointer<vtkExtractBlock>::New();
-  eb->SetInputConnection(ofcase_->GetOutputPort());
+  eb->SetInputConnection(outputPort());
   for (int i: blockIdxs)
   {
     eb->AddIndex( i );
@@ -5,6 +5,8 @@
 #include <string>
 #include <map>
 #include <limits>
+#include <list>
+#include <functional>
 #include <thread>
 
 #include <boost/filesystem.hpp>
@@ -306,9 +308,18 @@ protected:
 
   mutable std::string currentViewTitle_;
 
+  /**
+   * @brief VTKOffscreenScene
+   * @param lockVTK
+   * if false, the global VTK lock is not acquired.
+   * Only for the additional render windows of a batch,
+   * which is run by a scene holding the lock.
+   */
+  VTKOffscreenScene(bool lockVTK);
+
 public:
   VTKOffscreenScene();
-  ~VTKOffscreenScene();
+  virtual ~VTKOffscreenScene();
 
   template<class Mapper, class Input>
   vtkActor* addAlgo(
@@ -456,6 +467,59 @@ public:
       ParallelScale scaleOrSize
       );
 
+  /**
+   * @brief The RenderJob struct
+   * a single image in a batch, see renderBatch()
+   */
+  struct RenderJob
+  {
+    insight::View view;
+    boost::filesystem::path imageFile;
+
+    /**
+     * time step, only for scenes with time information
+     * (see setRenderTime())
+     */
+    boost::optional<double> time;
+
+    /**
+     * if unset, the view is fitted to the scene
+     */
+    boost::optional<ParallelScale> parallelScale;
+
+    /**
+     * if set, overrides the representation of all actors
+     */
+    boost::optional<DatasetRepresentation> representation;
+
+    RenderJob(
+        const insight::View& view,
+        const boost::filesystem::path& imageFile );
+  };
+
+  /**
+   * @brief setRenderTime
+   * make the data of the given time step current.
+   * The base implementation throws, scenes with time information override it.
+   */
+  virtual void setRenderTime(double t);
+
+  /**
+   * @brief renderBatch
+   * Render a list of images concurrently on a pool of independent
+   * offscreen render windows. The datasets of the current actors are shared
+   * read-only between the windows. Jobs are grouped by time. While one time
+   * step is rendered, the data of the next one is already read.
+   * Volumes are not supported.
+   *
+   * Concurrent rendering requires a thread-safe OpenGL implementation
+   * (OSMesa or EGL) and is therefore opt-in.
+   * @param nThreads
+   * number of render windows. If <1, the value of INSIGHT_VTK_RENDER_THREADS
+   * is used, or a single window, if it is not set.
+   */
+  void renderBatch(const std::vector<RenderJob>& jobs, int nThreads=0);
+
   void fitAll(double mult=1.05);
 
   void clearScene();
@@ -505,6 +569,20 @@ public:
 
 
 
+/**
+ * @brief The OpenFOAMCaseScene class
+ * Scene with the data of an OpenFOAM case.
+ *
+ * If the case is decomposed (np>1 or the processor directories contain later
+ * times than the case directory), the processor directories are read
+ * concurrently, one reader per directory, and merged into a single dataset
+ * with the same block structure as for a reconstructed case.
+ * The processor boundary patches are omitted.
+ *
+ * The datasets of the time steps (decomposed case only) and the results of
+ * internalMesh() and patches() are kept in a bounded cache, so that
+ * repeated queries for different images don't re-read from disk.
+ */
 class OpenFOAMCaseScene
   : public VTKOffscreenScene
 {
@@ -512,10 +590,49 @@ class OpenFOAMCaseScene
   std::map<std::string,int> patches_;
   std::vector<double> times_;
 
+  /**
+   * readers of the processor directories, empty for a reconstructed case.
+   * ofcase_ is then the reader of processor0.
+   */
+  std::vector<vtkSmartPointer<vtkOpenFOAMReader> > processorReaders_;
+  vtkSmartPointer<vtkAlgorithm> decomposedOutput_;
+
+  double currentTime_;
+
+  typedef std::pair<double, std::string> CacheKey;
+  struct CacheEntry
+  {
+    CacheKey key;
+    vtkSmartPointer<vtkDataObject> data;
+    unsigned long size; // KiB
+  };
+  unsigned long maxCacheSize_; // KiB
+  mutable std::list<CacheEntry> cache_;
+
+  void trimCache() const;
+
+  vtkSmartPointer<vtkDataObject> cached(
+      const std::string& selection,
+      std::function<vtkSmartPointer<vtkDataObject>()> create ) const;
+
+  void setDecomposedTimeValue(double t);
+  vtkAlgorithmOutput* outputPort() const;
+
 public:
   OpenFOAMCaseScene(const boost::filesystem::path& casepath, bool readZones=false, int np=1);
 
-  vtkMultiBlockDataSet* GetOutput();
+  bool isDecomposed() const;
+
+  /**
+   * @brief setMaxCacheSize
+   * set the maximum memory size of the datasets in the cache
+   * in kibibytes (default: 1 GiB). Zero disables caching.
+   */
+  void setMaxCacheSize(unsigned long maxKiB);
+
+  vtkMultiBlockDataSet* GetOutput() const;
+
+  void setRenderTime(double t) override;
 
   const std::vector<double>& times() const;
 
@@ -532,6 +649,10 @@ public:
 
   vtkSmartPointer<vtkOpenFOAMReader> ofcase() const;
   vtkSmartPointer<vtkUnstructuredGridAlgorithm> internalMeshFilter() const;
+  /**
+   * internalMesh() and patches() return shallow copies of cached datasets:
+   * arrays may be added or removed, but their values must not be modified.
+   */
   vtkSmartPointer<vtkUnstructuredGrid> internalMesh() const;
 
   std::vector<std::string> matchingPatchNames(const std::string& patchNamePattern) const;
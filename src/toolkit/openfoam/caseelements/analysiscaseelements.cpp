@@ -1484,6 +1484,14 @@ OFDictData::dict extendedForces::functionObjectDict() const
       fod["maskField"]=p().maskField;
       fod["maskThreshold"]=p().maskThreshold;
   }
+
+  if (p().nForceBins>0)
+  {
+      OFDictData::dict bd;
+      bd["nBin"]=p().nForceBins;
+      bd["direction"]=OFDictData::vector3(p().binDirection);
+      fod["forceBins"]=bd;
+  }
   
   fod["CofR"]=OFDictData::vector3(p().CofR);
   return fod;
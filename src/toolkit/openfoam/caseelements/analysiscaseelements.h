@@ -534,6 +534,9 @@ inherits insight::forces::Parameters
 maskField = string "" "Optional: name of field which masks the force evaluation. The local force density is multiplied by this field."
 maskThreshold = double 0.5 "Threshold value for masking"
 
+nForceBins = int 0 "Optional: number of bins for the force distribution along binDirection. Written into postProcessing/<name>_bins. Disabled, if zero."
+binDirection = vector (1 0 0) "Direction of the force distribution bins"
+
 createGetter
 <<<PARAMETERSET
 */
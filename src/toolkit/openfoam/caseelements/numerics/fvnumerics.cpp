@@ -125,6 +125,14 @@ void FVNumerics::addIntoDictionaries(OFdicts& dictionaries) const
       rw["type"]="restartWrite";
       rw["clockTimeInterval"]=rwp->clockTimeInterval;
       rw["nKeep"]=rwp->nKeep;
+      if (rwp->asynchronous)
+      {
+          rw["asynchronous"]=true;
+          if (!rwp->localDirectory.empty())
+          {
+              rw["localDirectory"]="\""+rwp->localDirectory+"\"";
+          }
+      }
       controlDict.subDict("functions")["restartWrite"]=rw;
       controlDict.getList("libs").insertNoDuplicate( "\"librestartWrite.so\"" );
   }
@@ -60,6 +60,14 @@ The output is intended for restart only and can at a different interval than the
 the next oldest is deleted, if it does not match a regular output time directory.
 It is recommended to keep more than one, because the last output might get corrupted,
 if the solver is killed during writing."
+  asynchronous = bool false
+"If set, the fields are copied into memory and written by a background thread, while the solver continues.
+At most one restart output is in progress at a time.
+Only volume and surface fields and the time information are contained: point fields, lagrangian data
+and the state of function objects in uniform/ are missing. For moving or changing meshes, the regular synchronous output is used instead."
+  localDirectory = string ""
+"Optional: directory (e.g. on node-local storage) into which the asynchronous restart output is written first.
+It is copied into the case directory afterwards. Environment variables are expanded."
  }
 
 }} clockTime "Whether to write additional, regular output for restart."
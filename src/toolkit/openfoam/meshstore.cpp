@@ -0,0 +1,263 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "meshstore.h"
+
+#include "base/exception.h"
+#include "base/parameters/subsetparameter.h"
+#include "base/parameters/selectablesubsetparameter.h"
+#include "base/parameters/pathparameter.h"
+#include "openfoam/openfoamtools.h"
+#include "base/filecontainer.h"
+
+#include <openssl/md5.h>
+
+#ifndef WIN32
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+using namespace std;
+using namespace boost::filesystem;
+
+
+namespace insight {
+
+
+
+
+namespace
+{
+
+void updateHash(MD5_CTX& ctx, const std::string& s)
+{
+  MD5_Update(&ctx, s.data(), s.size());
+  MD5_Update(&ctx, "\n", 1);
+}
+
+
+void hashElement(
+    MD5_CTX& ctx,
+    const hierarchicalData::Element& e,
+    const std::set<std::string>& excludedParameterPaths )
+{
+  auto p = e.path();
+  if (excludedParameterPaths.count(p))
+    return;
+
+  if (auto *pp = dynamic_cast<const PathParameter*>(&e))
+  {
+    // the file name does not matter, only the extension and the content
+    updateHash(ctx, p+" = *"+pp->fileExtension());
+
+    if (pp->isValid()
+        && ( pp->hasFileContent()
+             || exists(pp->expandedFilePath(true)) ) )
+    {
+      auto is = pp->stream();
+      char buf[65536];
+      while (is->read(buf, sizeof(buf)) || is->gcount()>0)
+      {
+        MD5_Update(&ctx, buf, is->gcount());
+      }
+    }
+    else
+    {
+      updateHash(ctx, pp->filePath().generic_string());
+    }
+  }
+  else if (e.nChildren()>0
+           || dynamic_cast<const ParameterSet*>(&e)
+           || dynamic_cast<const SelectableSubsetParameter*>(&e) )
+  {
+    if (auto *ssp = dynamic_cast<const SelectableSubsetParameter*>(&e))
+    {
+      updateHash(ctx, p+" selected "+ssp->selection());
+    }
+    else
+    {
+      updateHash(ctx, p+" : "+e.type()+" "+std::to_string(e.nChildren()));
+    }
+
+    for (int i=0; i<e.nChildren(); ++i)
+    {
+      hashElement(ctx, e.childElement(i), excludedParameterPaths);
+    }
+  }
+  else
+  {
+    updateHash(ctx, p+" = "+e.plainTextRepresentation(0));
+  }
+}
+
+}
+
+
+
+
+MeshStore::Lock::Lock(const boost::filesystem::path& lockFile)
+  : fd_(-1)
+{
+#ifndef WIN32
+  fd_ = ::open(lockFile.string().c_str(), O_RDWR|O_CREAT, 0666);
+  if (fd_<0)
+  {
+    throw insight::Exception(
+          "could not open lock file %s", lockFile.string().c_str() );
+  }
+  if (::flock(fd_, LOCK_EX)!=0)
+  {
+    ::close(fd_);
+    throw insight::Exception(
+          "could not acquire lock on file %s", lockFile.string().c_str() );
+  }
+#endif
+}
+
+
+MeshStore::Lock::~Lock()
+{
+#ifndef WIN32
+  if (fd_>=0)
+  {
+    ::flock(fd_, LOCK_UN);
+    ::close(fd_);
+  }
+#endif
+}
+
+
+
+
+MeshStore::MeshStore(const boost::filesystem::path& storeDirectory)
+  : storeDirectory_(absolute(storeDirectory))
+{
+  if (!exists(storeDirectory_))
+    create_directories(storeDirectory_);
+}
+
+
+
+
+std::string MeshStore::computeKey(
+    const std::string& analysisType,
+    const ParameterSet& ps,
+    const std::vector<std::string>& relevantParameterPaths,
+    const std::set<std::string>& excludedParameterPaths )
+{
+  CurrentExceptionContext ex("computing mesh store key");
+
+  MD5_CTX ctx;
+  MD5_Init(&ctx);
+
+  updateHash(ctx, analysisType);
+
+  for (const auto& rp: relevantParameterPaths)
+  {
+    if (ps.hasPath(rp))
+    {
+      hashElement(ctx, ps.get<Parameter>(rp), excludedParameterPaths);
+    }
+  }
+
+  MD5Hash digest;
+  MD5_Final(digest.data(), &ctx);
+
+  return hexDigest(digest);
+}
+
+
+
+
+const boost::filesystem::path& MeshStore::storeDirectory() const
+{
+  return storeDirectory_;
+}
+
+
+
+
+boost::filesystem::path MeshStore::entryDirectory(const std::string& key) const
+{
+  return storeDirectory_/key;
+}
+
+
+
+
+bool MeshStore::contains(const std::string& key) const
+{
+  return exists(entryDirectory(key)/"constant"/"polyMesh");
+}
+
+
+
+
+std::unique_ptr<MeshStore::Lock> MeshStore::lock(const std::string& key) const
+{
+  return std::make_unique<Lock>(storeDirectory_/(key+".lock"));
+}
+
+
+
+
+bool MeshStore::publish(
+    const std::string& key,
+    const boost::filesystem::path& caseDirectory ) const
+{
+  CurrentExceptionContext ex(
+        "publishing mesh of case %s in mesh store %s under key %s",
+        caseDirectory.string().c_str(),
+        storeDirectory_.string().c_str(),
+        key.c_str() );
+
+  auto source = caseDirectory/"constant";
+  for (const std::string fname: {"boundary", "faces", "neighbour", "owner", "points"})
+  {
+    if ( !exists(source/"polyMesh"/fname)
+         && !exists(source/"polyMesh"/(fname+".gz")) )
+    {
+      return false; // e.g. mesh only present in processor directories
+    }
+  }
+
+  if (contains(key))
+    return true;
+
+  auto tmp = storeDirectory_ / unique_path(key+".tmp-%%%%%%%%");
+  try
+  {
+    copyPolyMesh(source, tmp/"constant", true, true, true);
+    rename(tmp, entryDirectory(key));
+  }
+  catch (...)
+  {
+    remove_all(tmp);
+    throw;
+  }
+  return true;
+}
+
+
+
+
+}
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Insight CAE, a workbench for Computer-Aided Engineering
+ * Copyright (C) 2014  Hannes Kroeger <hannes@kroegeronline.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef INSIGHT_MESHSTORE_H
+#define INSIGHT_MESHSTORE_H
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace insight {
+
+class ParameterSet;
+namespace hierarchicalData { class Element; }
+
+
+
+
+/**
+ * @brief The MeshStore class
+ * A directory with OpenFOAM meshes, which are addressed by a key.
+ * The key is computed from the parameters, which determine the mesh,
+ * and the contents of the referenced geometry files.
+ * Analyses with identical key can reuse a mesh instead of creating it again.
+ *
+ * Layout: <store>/<key>/constant/polyMesh.
+ * An entry is copied into a temporary directory first and then renamed,
+ * so that an existing entry directory is always complete.
+ */
+class MeshStore
+{
+  boost::filesystem::path storeDirectory_;
+
+public:
+  /**
+   * @brief The Lock class
+   * exclusive lock on a single key, released on destruction.
+   * Used to prevent, that concurrent analyses create the same mesh twice.
+   */
+  class Lock
+  {
+    int fd_;
+  public:
+    Lock(const boost::filesystem::path& lockFile);
+    ~Lock();
+  };
+
+  MeshStore(const boost::filesystem::path& storeDirectory);
+
+  /**
+   * @brief computeKey
+   * compute the hash over the analysis type and the given parameters
+   * @param analysisType
+   * type name of the analysis: different analyses may use
+   * identical parameter paths for different meshes
+   * @param ps
+   * the parameter set
+   * @param relevantParameterPaths
+   * the paths of the parameters, which determine the mesh.
+   * Nonexisting paths are skipped.
+   * @param excludedParameterPaths
+   * paths of (sub-)parameters, which shall not be considered.
+   * @return
+   * the hash as hexadecimal string
+   */
+  static std::string computeKey(
+      const std::string& analysisType,
+      const ParameterSet& ps,
+      const std::vector<std::string>& relevantParameterPaths,
+      const std::set<std::string>& excludedParameterPaths = {} );
+
+  const boost::filesystem::path& storeDirectory() const;
+
+  /**
+   * @brief entryDirectory
+   * @return
+   * the case directory of the entry with the given key.
+   * The mesh is located in the "constant" subdirectory.
+   */
+  boost::filesystem::path entryDirectory(const std::string& key) const;
+
+  bool contains(const std::string& key) const;
+
+  /**
+   * @brief lock
+   * acquire the lock for the given key. Blocks, until it is available.
+   */
+  std::unique_ptr<Lock> lock(const std::string& key) const;
+
+  /**
+   * @brief publish
+   * copy the mesh from the case directory into the store.
+   * The caller should hold the lock for the key.
+   * @return
+   * false, if no complete mesh was found in the case directory
+   */
+  bool publish(
+      const std::string& key,
+      const boost::filesystem::path& caseDirectory ) const;
+};
+
+
+
+
+}
+
+#endif // INSIGHT_MESHSTORE_H
@@ -42,6 +42,7 @@
 #include "openfoam/caseelements/basic/rasmodel.h"
 
 #include "openfoamtools.h"
+#include "openfoam/meshstore.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
@@ -88,6 +89,7 @@ run = set
 mesh = set
 {
  linkmesh 	= 	path 	"" 	"If not empty, the mesh will not be generated, but a symbolic link to the polyMesh folder of the specified OpenFOAM case will be created." *hidden
+ meshstore 	= 	path 	"" 	"If not empty, generated meshes are stored in this directory under a key, which is computed from the mesh-relevant parameters and the contents of the geometry files. Analyses with identical key link the stored mesh instead of creating it again." *hidden
 } "Properties of the computational mesh"
 
 eval = set
@@ -294,6 +296,67 @@ public:
 
 
 
+    /**
+     * @brief meshRelevantParameters
+     * paths of the parameters, which determine the mesh.
+     * They are used to compute the key in the mesh store.
+     * Analyses, whose mesh depends on further parameters (e.g. a
+     * first layer thickness derived from the flow velocity) have to add them.
+     */
+    virtual std::vector<std::string> meshRelevantParameters() const
+    {
+        return { "run/OFEname", "geometry", "mesh" };
+    }
+
+
+    /**
+     * @brief createOrLinkStoredMesh
+     * link the mesh from the mesh store, if an entry for the current
+     * parameters exists. Otherwise create the mesh and publish it.
+     * Concurrent analyses with the same key wait for each other.
+     */
+    void createOrLinkStoredMesh(
+        OpenFOAMCase& meshCase,
+        const OFEnvironment& ofe,
+        ProgressDisplayer& parentProgress )
+#ifdef SWIG
+;
+#else
+    {
+        auto dir = this->executionPath();
+
+        MeshStore store(p().mesh.meshstore->expandedFilePath());
+        auto key = MeshStore::computeKey(
+            this->type(),
+            this->parameters(),
+            meshRelevantParameters(),
+            { "mesh/linkmesh", "mesh/meshstore" } );
+
+        auto lock = store.lock(key);
+        if (store.contains(key))
+        {
+            parentProgress.logMessage(
+                str(boost::format(
+                        _("Linking the mesh %s from mesh store %s.")
+                        ) % key % store.storeDirectory().string() ) );
+            linkPolyMesh(store.entryDirectory(key)/"constant", dir/"constant", &ofe);
+        }
+        else
+        {
+            parentProgress.logMessage(_("Creating the mesh."));
+            createMesh(meshCase, parentProgress);
+
+            if (!store.publish(key, dir))
+            {
+                insight::Warning(
+                    _("no complete mesh found in \"%s\", it was not added to the mesh store."),
+                    (dir/"constant").string().c_str() );
+            }
+        }
+    }
+#endif
+
+
     /**
      * integrate all steps before the actual run
      */
@@ -338,6 +401,10 @@ public:
                                 ) % dir.string() ) );
                     linkPolyMesh(p().mesh.linkmesh->expandedFilePath()/"constant", dir/"constant", &ofe);
                 }
+                else if (p().mesh.meshstore->isValid())
+                {
+                    createOrLinkStoredMesh(*meshCase, ofe, parentProgress);
+                }
                 else
                 {
                     parentProgress.logMessage(_("Creating the mesh."));
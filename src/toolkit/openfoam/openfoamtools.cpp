@@ -33,6 +33,7 @@
 #include "openfoam/solveroutputanalyzer.h"
 #include "openfoam/caseelements/numerics/meshingnumerics.h"
 #include "openfoam/createpatch.h"
+#include "openfoam/pvbatchpool.h"
 
 #include "boost/regex.hpp"
 #include "boost/iostreams/filtering_stream.hpp"
@@ -753,6 +754,25 @@ void runPvPython
   bool keepScript
 )
 {
+  if (PvBatchPool::enabled())
+  {
+    // scripts are executed concurrently by the persistent workers
+    std::string script("from Insight.Paraview import *\n");
+    for (const std::string& cmd: pvpython_commands)
+    {
+      script += cmd;
+    }
+    if (keepScript)
+    {
+      std::ofstream tf( absolute(unique_path("%%%%%%%%%.py")).c_str() );
+      tf << script;
+    }
+
+    auto r = PvBatchPool::global(ofc).run(location, script);
+    std::cout << r.output;
+    return;
+  }
+
   boost::mutex::scoped_lock lock(runPvPython_mtx);
   
 //  redi::opstream proc;
@@ -1024,6 +1044,36 @@ patchArea::patchArea(
 
 
 
+bool parseTextFileLine(std::string line, std::vector<double>& vals)
+{
+  vals.clear();
+
+  algorithm::trim_left(line);
+  char fc; istringstream(line) >> fc; // get first char
+  if ( (line.size()==0) || (fc=='#') )
+  {
+    return false; // comment
+  }
+
+  erase_all ( line, "(" );
+  erase_all ( line, ")" );
+  replace_all ( line, ",", " " );
+  replace_all ( line, "\t", " " );
+  while (line.find("  ")!=std::string::npos)
+  {
+    replace_all ( line, "  ", " " );
+  }
+
+  std::vector<std::string> strs;
+  boost::split(strs, line, is_any_of(" "));
+
+  transform(strs.begin(), strs.end(), std::back_inserter(vals),
+            [](const std::string& s) { return insight::toNumber<double>(s); });
+
+  return true;
+}
+
+
 arma::mat readTextFile(std::istream& f)
 {
   CurrentExceptionContext ex("reading tabular data from input stream");
@@ -1038,32 +1088,9 @@ arma::mat readTextFile(std::istream& f)
     iline++;
     CurrentExceptionContext ex(insight::VerbosityLevel::Loops, str(format("reading line %d (containing \"%s\")")%iline%line), false);
 
-    algorithm::trim_left(line);
-    char fc; istringstream(line) >> fc; // get first char
-    if ( (line.size()==0) || (fc=='#') )
+    std::vector<double> vals;
+    if (parseTextFileLine(line, vals))
     {
-      // comment
-    }
-    else
-    {
-      erase_all ( line, "(" );
-      erase_all ( line, ")" );
-      replace_all ( line, ",", " " );
-      replace_all ( line, "\t", " " );
-      while (line.find("  ")!=std::string::npos)
-      {
-        replace_all ( line, "  ", " " );
-      }
-
-      std::vector<std::string> strs;
-      boost::split(strs, line, is_any_of(" "));
-
-//      for (const auto& s: strs) std::cout<<s<<" >> "; std::cout<<std::endl;
-
-      std::vector<double> vals;
-      transform(strs.begin(), strs.end(), std::back_inserter(vals),
-                [](const std::string& s) { return insight::toNumber<double>(s); });
-
       fd.push_back(vals);
     }
   }
@@ -186,6 +186,17 @@ public:
   arma::mat ctr_;
 };
 
+/**
+ * @brief parseTextFileLine
+ * parse a single line of tabular data, as written by OpenFOAM function objects
+ * @param line
+ * @param vals
+ * values in line
+ * @return
+ * false, if the line is empty or a comment
+ */
+bool parseTextFileLine(std::string line, std::vector<double>& vals);
+
 arma::mat readTextFile(std::istream& is);
 
 arma::mat readParaviewCSV(const boost::filesystem::path& file, std::map<std::string, int>* headers);
@@ -0,0 +1,593 @@
+#include "openfoam/pvbatchpool.h"
+#include "openfoam/openfoamcase.h"
+
+#include "base/exception.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "boost/format.hpp"
+#include "boost/property_tree/ptree.hpp"
+#include "boost/property_tree/json_parser.hpp"
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace boost;
+
+namespace insight
+{
+
+
+
+
+namespace
+{
+
+
+/**
+ * server, which is executed by each pvbatch worker.
+ * Messages in both directions are JSON, preceded by their length (8 bytes, big endian).
+ */
+const char* pvbatchServerScript = R"PY(
+import os, sys, io, json, socket, struct, traceback, contextlib, collections
+from paraview.simple import *
+
+socketPath = sys.argv[1]
+maxCachedCases = int(sys.argv[2])
+
+# cached OpenFOAM readers: case directory => (signature, (reader, blockIndices), initial reader properties)
+readers = collections.OrderedDict()
+
+def isTimeName(n):
+    try:
+        float(n)
+        return True
+    except ValueError:
+        return False
+
+def caseSignature(caseDir):
+    # names and modification times of the mesh and field files
+    sig = []
+    for d in [caseDir, os.path.join(caseDir, 'processor0')]:
+        if not os.path.isdir(d):
+            continue
+        for e in sorted(os.listdir(d)):
+            p = os.path.join(d, e)
+            if os.path.isdir(p) and (e == 'constant' or isTimeName(e)):
+                for root, dirs, files in os.walk(p):
+                    dirs.sort()
+                    for f in sorted(files):
+                        fp = os.path.join(root, f)
+                        sig.append((fp, os.path.getmtime(fp)))
+            else:
+                sig.append((p, None))
+    return sig
+
+def readerProperties(r):
+    props = {}
+    for n in r.ListProperties():
+        try:
+            props[n] = r.GetPropertyValue(n)
+        except Exception:
+            pass
+    return props
+
+def restoreReaderProperties(r, props):
+    # undo modifications of the previous scripts (MeshRegions, CellArrays etc.)
+    for n, v in props.items():
+        try:
+            if r.GetPropertyValue(n) != v:
+                setattr(r, n, v)
+        except Exception:
+            pass
+
+try:
+    import Insight.Paraview as ipv
+    _loadOFCase = ipv.loadOFCase
+
+    def loadOFCase(caseDir):
+        key = os.path.realpath(caseDir)
+        sig = caseSignature(key)
+        e = readers.pop(key, None)
+        if e is not None:
+            if e[0] == sig:
+                case = e[1][0]
+                restoreReaderProperties(case, e[2])
+                view = GetActiveView()
+                if not view:
+                    view = CreateRenderView()
+                vs = case.TimestepValues
+                try:
+                    view.ViewTime = vs[-1]
+                except TypeError:
+                    view.ViewTime = vs
+                view.Background = [1,1,1]
+                view.ViewSize = [3840, 2160]
+                SetActiveSource(case)
+                readers[key] = e
+                return e[1]
+            Delete(e[1][0])
+        r = _loadOFCase(key)
+        readers[key] = (sig, r, readerProperties(r[0]))
+        while len(readers) > maxCachedCases:
+            k, old = readers.popitem(last=False)
+            Delete(old[1][0])
+        return r
+
+    ipv.loadOFCase = loadOFCase
+except ImportError:
+    pass
+
+def isCachedReader(s):
+    for e in readers.values():
+        if s == e[1][0]:
+            return True
+    return False
+
+def cleanup():
+    # delete consumers before their inputs
+    srcs = sorted(GetSources().items(), key=lambda kv: int(kv[0][1]), reverse=True)
+    for k, s in srcs:
+        if not isCachedReader(s):
+            Delete(s)
+    # views (with camera and representations), color maps and layouts
+    # are not reused by the next script
+    for v in GetRenderViews():
+        Delete(v)
+    pxm = servermanager.ProxyManager()
+    for group in ['lookup_tables', 'piecewise_functions', 'layouts']:
+        for n, px in list(pxm.GetProxiesInGroup(group).items()):
+            try:
+                Delete(px)
+            except Exception:
+                pass
+
+def listFiles():
+    return dict( (f, os.path.getmtime(f)) for f in os.listdir('.') if os.path.isfile(f) )
+
+def handle(req):
+    wd = req['wd']
+    os.chdir(wd)
+    before = listFiles()
+    out = io.StringIO()
+    ok = True
+    err = ''
+    with contextlib.redirect_stdout(out), contextlib.redirect_stderr(out):
+        try:
+            exec(compile(req['script'], 'pvbatch-job', 'exec'), {'__name__': '__main__'})
+        except BaseException:
+            ok = False
+            err = traceback.format_exc()
+        try:
+            cleanup()
+        except Exception:
+            err += traceback.format_exc()
+    after = listFiles()
+    files = [ os.path.join(wd, f) for f, t in after.items()
+              if (not f in before) or before[f] != t ]
+    return { 'ok': ok, 'output': out.getvalue(), 'error': err, 'files': files }
+
+def recvAll(conn, n):
+    buf = b''
+    while len(buf) < n:
+        d = conn.recv(n - len(buf))
+        if not d:
+            return None
+        buf += d
+    return buf
+
+sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+sock.bind(socketPath)
+sock.listen(1)
+conn, addr = sock.accept()
+while True:
+    hdr = recvAll(conn, 8)
+    if hdr is None:
+        break
+    msg = recvAll(conn, struct.unpack('!Q', hdr)[0])
+    if msg is None:
+        break
+    req = json.loads(msg.decode('utf-8'))
+    if 'quit' in req:
+        break
+    data = json.dumps(handle(req)).encode('utf-8')
+    conn.sendall(struct.pack('!Q', len(data)) + data)
+conn.close()
+os.remove(socketPath)
+)PY";
+
+
+#ifndef WIN32
+
+void sendMessage(int fd, const std::string& msg)
+{
+  unsigned char hdr[8];
+  uint64_t n = msg.size();
+  for (int i=7; i>=0; --i)
+  {
+    hdr[i] = n & 0xff;
+    n >>= 8;
+  }
+
+  auto writeAll = [fd](const char* buf, size_t len)
+  {
+    while (len>0)
+    {
+      auto w = ::write(fd, buf, len);
+      if (w<=0)
+        throw insight::Exception("lost connection to pvbatch worker");
+      buf+=w;
+      len-=w;
+    }
+  };
+
+  writeAll(reinterpret_cast<const char*>(hdr), 8);
+  writeAll(msg.data(), msg.size());
+}
+
+
+std::string recvMessage(int fd)
+{
+  auto readAll = [fd](char* buf, size_t len)
+  {
+    while (len>0)
+    {
+      auto r = ::read(fd, buf, len);
+      if (r<=0)
+        throw insight::Exception("lost connection to pvbatch worker");
+      buf+=r;
+      len-=r;
+    }
+  };
+
+  unsigned char hdr[8];
+  readAll(reinterpret_cast<char*>(hdr), 8);
+  uint64_t n=0;
+  for (int i=0; i<8; ++i)
+  {
+    n = (n<<8) | hdr[i];
+  }
+
+  std::string msg(n, '\0');
+  readAll(&msg[0], n);
+  return msg;
+}
+
+#endif
+
+
+}
+
+
+
+
+PvBatchPool::PvBatchPool(const OpenFOAMCase& ofc, int nWorkers, int maxCachedCases)
+  : ofc_(std::make_unique<OpenFOAMCase>(ofc.ofe())),
+    maxCachedCases_(maxCachedCases)
+{
+  insight::assertion(
+      nWorkers>0,
+      "the number of pvbatch workers has to be positive" );
+
+  serverScript_ = std::make_unique<TemporaryFile>(
+      "pvbatch-server-%%%%.py", GlobalTemporaryDirectory::path() );
+  serverScript_->stream() << pvbatchServerScript;
+  serverScript_->closeStream();
+
+  for (int i=0; i<nWorkers; ++i)
+  {
+    workers_.emplace_back(new Worker);
+  }
+}
+
+
+
+
+PvBatchPool::~PvBatchPool()
+{
+  for (auto& w: workers_)
+  {
+    try
+    {
+      stop(*w);
+    }
+    catch (...)
+    {}
+  }
+}
+
+
+
+
+void PvBatchPool::start(Worker& w, int i)
+{
+#ifdef WIN32
+  throw insight::Exception("the pvbatch worker pool is not available on this platform");
+#else
+  CurrentExceptionContext ex("starting pvbatch worker %d", i);
+
+  w.socketPath = GlobalTemporaryDirectory::path()
+                 / str(format("pvbatch-%d-%d.sock") % ::getpid() % i);
+  if (filesystem::exists(w.socketPath))
+    filesystem::remove(w.socketPath);
+
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  insight::assertion(
+      w.socketPath.string().size() < sizeof(addr.sun_path),
+      "socket path %s is too long", w.socketPath.string().c_str() );
+  strncpy(addr.sun_path, w.socketPath.string().c_str(), sizeof(addr.sun_path)-1);
+
+  std::vector<std::string> args = {
+    "--force-offscreen-rendering",
+    serverScript_->path().string(),
+    w.socketPath.string(),
+    std::to_string(maxCachedCases_)
+  };
+
+  // output goes into a log file, nobody reads the pipes of the job
+  auto logFile = w.socketPath.parent_path() / (w.socketPath.stem().string()+".log");
+  std::string machine=""; // execute always on local machine
+  w.process = ofc_->forkCommand(
+      GlobalTemporaryDirectory::path(),
+      "exec >\""+logFile.string()+"\" 2>&1; exec pvbatch-offscreen",
+      args, &machine );
+  w.openCases.clear();
+
+  // wait until the server listens
+  for (int attempt=0; ; ++attempt)
+  {
+    if (!w.process->isRunning())
+    {
+      throw insight::Exception(
+          "pvbatch worker terminated during startup, see %s",
+          logFile.string().c_str() );
+    }
+    if (attempt>1200)
+    {
+      throw insight::Exception("pvbatch worker did not start listening in time");
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd<0)
+    {
+      throw insight::Exception("could not create socket");
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))==0)
+    {
+      w.fd = fd;
+      break;
+    }
+    ::close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+#endif
+}
+
+
+
+
+void PvBatchPool::stop(Worker& w)
+{
+#ifndef WIN32
+  if (w.fd>=0)
+  {
+    try
+    {
+      sendMessage(w.fd, "{\"quit\": \"\"}");
+    }
+    catch (...)
+    {}
+    ::close(w.fd);
+    w.fd = -1;
+  }
+
+  if (w.process)
+  {
+    for (int i=0; i<100 && w.process->isRunning(); ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (w.process->isRunning())
+    {
+      w.process->terminate();
+    }
+    w.process->wait();
+    w.process.reset();
+  }
+
+  w.openCases.clear();
+#endif
+}
+
+
+
+
+PvBatchPool::Worker& PvBatchPool::acquire(const std::string& caseKey)
+{
+  std::unique_lock<std::mutex> l(mtx_);
+
+  Worker* sel = nullptr;
+  workerReleased_.wait(
+      l,
+      [&]()
+      {
+        sel = nullptr;
+        for (auto& w: workers_)
+        {
+          if (!w->busy)
+          {
+            if (std::find(w->openCases.begin(), w->openCases.end(), caseKey)
+                != w->openCases.end())
+            {
+              sel = w.get();
+              break;
+            }
+            if (!sel) sel = w.get();
+          }
+        }
+        return sel!=nullptr;
+      } );
+
+  sel->busy = true;
+
+  // mirror the reader cache of the worker
+  sel->openCases.remove(caseKey);
+  sel->openCases.push_front(caseKey);
+  while (sel->openCases.size()>size_t(maxCachedCases_))
+  {
+    sel->openCases.pop_back();
+  }
+
+  return *sel;
+}
+
+
+
+
+void PvBatchPool::release(Worker& w)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    w.busy = false;
+  }
+  workerReleased_.notify_all();
+}
+
+
+
+
+PvBatchPool::Result PvBatchPool::run(
+    const boost::filesystem::path& workDir,
+    const std::string& script,
+    const boost::filesystem::path& caseDirectory,
+    bool loadImages )
+{
+#ifdef WIN32
+  throw insight::Exception("the pvbatch worker pool is not available on this platform");
+#else
+  auto wd = filesystem::absolute(workDir);
+  auto cd = caseDirectory.empty() ? wd : filesystem::absolute(caseDirectory);
+
+  CurrentExceptionContext ex("executing ParaView script in %s", wd.string().c_str());
+
+  Worker& w = acquire(cd.string());
+
+  std::string response;
+  try
+  {
+    if (!w.process || !w.process->isRunning() || w.fd<0)
+    {
+      stop(w);
+      int i=0;
+      while (workers_[i].get()!=&w) ++i;
+      start(w, i);
+    }
+
+    property_tree::ptree req;
+    req.put("wd", wd.string());
+    req.put("script", script);
+    std::ostringstream os;
+    property_tree::write_json(os, req, false);
+
+    sendMessage(w.fd, os.str());
+    response = recvMessage(w.fd);
+  }
+  catch (...)
+  {
+    stop(w);
+    release(w);
+    throw;
+  }
+  release(w);
+
+  property_tree::ptree resp;
+  {
+    std::istringstream is(response);
+    property_tree::read_json(is, resp);
+  }
+
+  Result res;
+  res.output = resp.get<std::string>("output", "");
+  for (const auto& f: resp.get_child("files"))
+  {
+    res.files.push_back(f.second.get_value<std::string>());
+  }
+
+  if (resp.get<std::string>("ok")!="true")
+  {
+    throw insight::Exception(
+        "ParaView script failed:\n%s\n%s",
+        res.output.c_str(),
+        resp.get<std::string>("error", "").c_str() );
+  }
+
+  if (loadImages)
+  {
+    for (const auto& f: res.files)
+    {
+      if (f.extension()==".png")
+      {
+        std::ifstream is(f.string(), std::ios::binary);
+        res.images[f] = std::make_shared<std::string>(
+            std::istreambuf_iterator<char>(is),
+            std::istreambuf_iterator<char>() );
+        is.close();
+        filesystem::remove(f);
+      }
+    }
+  }
+
+  return res;
+#endif
+}
+
+
+
+
+bool PvBatchPool::enabled()
+{
+  if (const char* nw = getenv("INSIGHT_PVBATCH_WORKERS"))
+  {
+    return atoi(nw)>0;
+  }
+  return false;
+}
+
+
+
+
+PvBatchPool& PvBatchPool::global(const OpenFOAMCase& ofc)
+{
+  static std::mutex m;
+  static std::map<std::string, std::unique_ptr<PvBatchPool> > pools;
+
+  // one pool per OpenFOAM installation
+  std::string key = ofc.ofe().bashrc().string();
+
+  std::lock_guard<std::mutex> l(m);
+  auto& pool = pools[key];
+  if (!pool)
+  {
+    int n = 1;
+    if (const char* nw = getenv("INSIGHT_PVBATCH_WORKERS"))
+    {
+      n = std::max(1, atoi(nw));
+    }
+    pool = std::make_unique<PvBatchPool>(ofc, n);
+  }
+  return *pool;
+}
+
+
+
+
+}
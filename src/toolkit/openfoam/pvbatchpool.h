@@ -0,0 +1,132 @@
+#ifndef INSIGHT_PVBATCHPOOL_H
+#define INSIGHT_PVBATCHPOOL_H
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "base/tools.h"
+#include "base/externalprocess.h"
+
+namespace insight
+{
+
+
+class OpenFOAMCase;
+
+
+
+/**
+ * @brief The PvBatchPool class
+ * Pool of long-lived pvbatch processes, which execute ParaView python scripts.
+ *
+ * Each worker listens on a local socket for scripts. The OpenFOAM readers,
+ * which are created by loadOFCase() from the Insight.Paraview module, are
+ * kept open between scripts (up to a limit per worker) and are reused, as long
+ * as the mesh and field files of the case are unchanged. Their properties are
+ * reset to the initial values for each script. All other sources, the views
+ * and the color maps are deleted after each script.
+ *
+ * The workers are started in the OpenFOAM environment of the pool.
+ *
+ * run() may be called from several threads: the scripts are then executed
+ * concurrently on different workers. Scripts for the same case are preferably
+ * dispatched to a worker, which has the case already open.
+ */
+class PvBatchPool
+{
+public:
+  struct Result
+  {
+    /**
+     * python output (stdout and stderr) of the script
+     */
+    std::string output;
+
+    /**
+     * files in the working directory, which were created or modified
+     */
+    std::vector<boost::filesystem::path> files;
+
+    /**
+     * content of the created images (*.png), if requested
+     */
+    std::map<boost::filesystem::path, std::shared_ptr<std::string> > images;
+  };
+
+private:
+  struct Worker
+  {
+    JobPtr process;
+    boost::filesystem::path socketPath;
+    int fd = -1;
+    bool busy = false;
+    std::list<std::string> openCases;
+  };
+
+  std::unique_ptr<OpenFOAMCase> ofc_;
+  int maxCachedCases_;
+  std::unique_ptr<TemporaryFile> serverScript_;
+
+  std::mutex mtx_;
+  std::condition_variable workerReleased_;
+  std::vector<std::unique_ptr<Worker> > workers_;
+
+  void start(Worker& w, int i);
+  void stop(Worker& w);
+
+  Worker& acquire(const std::string& caseKey);
+  void release(Worker& w);
+
+public:
+  PvBatchPool(const OpenFOAMCase& ofc, int nWorkers, int maxCachedCases = 4);
+  ~PvBatchPool();
+
+  /**
+   * @brief run
+   * execute a python script in one of the workers. Blocks until it is finished.
+   * Throws, if the script raised an exception.
+   * @param workDir
+   * working directory of the script
+   * @param script
+   * the script. Should import Insight.Paraview to benefit from the reader cache.
+   * @param caseDirectory
+   * the case, which is read by the script. Defaults to the working directory.
+   * @param loadImages
+   * if set, the created images are returned in memory and removed from disk.
+   */
+  Result run(
+      const boost::filesystem::path& workDir,
+      const std::string& script,
+      const boost::filesystem::path& caseDirectory = boost::filesystem::path(),
+      bool loadImages = false );
+
+  /**
+   * @brief enabled
+   * @return
+   * true, if a global pool is configured by
+   * the environment variable INSIGHT_PVBATCH_WORKERS (number of workers)
+   */
+  static bool enabled();
+
+  /**
+   * @brief global
+   * @return
+   * the pool of the OpenFOAM installation of ofc.
+   * It is created on first use.
+   */
+  static PvBatchPool& global(const OpenFOAMCase& ofc);
+};
+
+
+
+
+}
+
+#endif // INSIGHT_PVBATCHPOOL_H
@@ -23,6 +23,7 @@
 #include "base/boost_include.h"
 #include "base/linearalgebra.h"
 #include "openfoam/openfoamtools.h"
+#include "base/tools.h"
 #include "base/exception.h"
 
 #include "openfoam/snappyhexmeshoutputanalyzer.h"
@@ -30,6 +31,8 @@
 #include "cadfeatures/importsolidmodel.h"
 #include "vtkLine.h"
 
+#include <fstream>
+
 
 using namespace std;
 using namespace boost;
@@ -46,10 +49,24 @@ namespace insight
 cad::FeaturePtr surfaceFeatureExtract
     (
         cad::FeaturePtr f,
+        double featureAngle,
+        double abstol
+        )
+{
+    return surfaceFeatureExtract(
+        f->exportTriangulation(abstol), featureAngle );
+}
+
+
+
+
+cad::FeaturePtr surfaceFeatureExtract
+    (
+        const TopoDS_Shape& triangulatedShape,
         double featureAngle
         )
 {
-    auto inp=f->triangulationToVTK();
+    auto inp=cad::Feature::triangulatedShapeToVTK(triangulatedShape);
     auto fe=vtkSmartPointer<vtkFeatureEdges>::New();
     fe->SetInputData(inp);
     fe->SetFeatureAngle(featureAngle);
@@ -103,6 +120,43 @@ cad::FeaturePtr surfaceFeatureExtract
 enum trimmedMesher {sHM, cfM};
 
 
+
+
+namespace
+{
+
+template<class Features>
+void modifyFeatureFiles(
+    const Features& features,
+    const OpenFOAMCase& ofc,
+    const boost::filesystem::path& location )
+{
+    std::vector<const snappyHexMeshFeats::Feature*> concurrent;
+
+    for (const auto& feat: features)
+    {
+        feat->prepareFiles();
+        if (feat->modifyFilesConcurrently())
+            concurrent.push_back(feat.get());
+    }
+
+    parallelFor(
+        concurrent.size(),
+        [&](size_t i)
+        {
+            concurrent[i]->modifyFiles(ofc, location);
+        } );
+
+    for (const auto& feat: features)
+    {
+        if (!feat->modifyFilesConcurrently())
+            feat->modifyFiles(ofc, location);
+    }
+}
+
+}
+
+
   
   
 namespace snappyHexMeshFeats
@@ -111,6 +165,44 @@ namespace snappyHexMeshFeats
 
 
 
+const double surfaceTolerance = 1e-2;
+
+
+
+
+void writeTriangulatedSurface(
+    size_t geometryHash,
+    const std::function<TopoDS_Shape()>& triangulation,
+    const boost::filesystem::path& fn,
+    double abstol )
+{
+    std::string stamp = str(format("%d %g") % geometryHash % abstol);
+    auto stampFile = fn.parent_path() / ("."+fn.filename().string()+".hash");
+
+    if (exists(fn) && exists(stampFile))
+    {
+        std::ifstream sf(stampFile.string());
+        std::string existingStamp;
+        std::getline(sf, existingStamp);
+        if (existingStamp==stamp)
+        {
+            std::cout << "geometry in " << fn << " is up to date" << std::endl;
+            return;
+        }
+    }
+
+    if (exists(stampFile))
+        boost::filesystem::remove(stampFile);
+
+    cad::Feature::exportSTL(triangulation(), fn, abstol, fn.extension()==".stlb");
+
+    std::ofstream sf(stampFile.string());
+    sf << stamp << std::endl;
+}
+
+
+
+
 boost::filesystem::path
 geometryDir(const OFEnvironment& ofe, const boost::filesystem::path& caseDir)
 {
@@ -171,6 +263,20 @@ void Feature::modifyFiles
 
 
 
+void Feature::prepareFiles() const
+{}
+
+
+
+
+bool Feature::modifyFilesConcurrently() const
+{
+  return false;
+}
+
+
+
+
 bool Feature::producesPrismLayers() const
 {
   return false;
@@ -204,7 +310,7 @@ std::string Geometry::fileName() const
 
 void Geometry::writeTo(cad::FeaturePtr f, const boost::filesystem::path &fn) const
 {
-    f->saveAs(fn);
+    writeTriangulationTo(f, fn);
 }
 
 
@@ -482,7 +588,7 @@ void RefinementGeometry::writeTo(
     cad::FeaturePtr f,
     const boost::filesystem::path &fn ) const
 {
-    f->saveAs(fn);
+    writeTriangulationTo(f, fn);
 }
 
 
@@ -828,10 +934,7 @@ void snappyHexMeshConfiguration::addIntoDictionaries(OFdicts& dictionaries) cons
 void snappyHexMeshConfiguration::modifyCaseOnDisk (
     const OpenFOAMCase& cm, const boost::filesystem::path& location ) const
 {
-  for (auto& feat: p().features)
-  {
-      feat->modifyFiles(cm, location);
-  }
+  modifyFeatureFiles(p().features, cm, location);
 }
 
 
@@ -955,9 +1058,10 @@ void snappyHexMesh
     setNoQualityCtrls(qualityCtrls);
   }
 
+  modifyFeatureFiles(p.features, ofc, location);
+
   for (const snappyHexMeshConfiguration::Parameters::features_default_type& feat: p.features)
   {
-      feat->modifyFiles(ofc, location);
       feat->addIntoDictionary(sHMDict);
   }
   
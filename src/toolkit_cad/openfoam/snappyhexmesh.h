@@ -21,6 +21,8 @@
 #ifndef INSIGHT_SNAPPYHEXMESH_H
 #define INSIGHT_SNAPPYHEXMESH_H
 
+#include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -51,6 +53,18 @@ namespace insight {
 cad::FeaturePtr surfaceFeatureExtract
     (
         cad::FeaturePtr f,
+        double featureAngle = 60.,
+        double abstol = 1e-3
+        );
+
+/**
+ * @brief surfaceFeatureExtract
+ * extract the feature edges from an existing triangulation,
+ * e.g. ExternalGeometryFile::triangulation()
+ */
+cad::FeaturePtr surfaceFeatureExtract
+    (
+        const TopoDS_Shape& triangulatedShape,
         double featureAngle = 60.
         );
 
@@ -76,6 +90,24 @@ geometryDir(const OpenFOAMCase& cm, const boost::filesystem::path& caseDir);
  */
 std::string cleanedName(const std::string& fn);
 
+/**
+ * tolerance of the triangulated geometry files
+ */
+extern const double surfaceTolerance;
+
+/**
+ * @brief writeTriangulatedSurface
+ * write a triangulation into an STL file.
+ * The file is not written again, if it exists and was
+ * created from the same geometry (same hash) and tolerance before.
+ * Then, the triangulation is not requested at all.
+ */
+void writeTriangulatedSurface(
+    size_t geometryHash,
+    const std::function<TopoDS_Shape()>& triangulation,
+    const boost::filesystem::path& fn,
+    double abstol = surfaceTolerance );
+
 }
 
 
@@ -138,12 +170,119 @@ public:
   
   virtual void writeTo(cad::FeaturePtr f, const boost::filesystem::path& fn) const =0;
 
+private:
+  /**
+   * transformed geometry, built sequentially in prepareFiles():
+   * the creation of cad features goes through the global (unsynchronized) feature cache
+   */
+  mutable cad::FeaturePtr preparedGeometry_;
+
+  /**
+   * last triangulation of the transformed geometry
+   * and the geometry hash and tolerance, it was created for
+   */
+  mutable std::mutex triangulationMtx_;
+  mutable TopoDS_Shape triangulation_;
+  mutable size_t triangulationHash_ = 0;
+  mutable double triangulationTolerance_ = -1.;
+
+protected:
+  /**
+   * @brief triangulation
+   * @return
+   * the triangulation of the given geometry.
+   * It is created only once per geometry hash and tolerance
+   * and shared e.g. between the STL export and the feature edge extraction.
+   */
+  TopoDS_Shape triangulation(cad::FeaturePtr f, double abstol) const
+  {
+      size_t h = f->hash();
+      std::lock_guard<std::mutex> lock(triangulationMtx_);
+      if (triangulation_.IsNull()
+          || h!=triangulationHash_
+          || abstol!=triangulationTolerance_ )
+      {
+          triangulation_ = f->exportTriangulation(abstol);
+          triangulationHash_ = h;
+          triangulationTolerance_ = abstol;
+      }
+      return triangulation_;
+  }
+
+  /**
+   * @brief writeTriangulationTo
+   * write the (shared) triangulation of f into an STL file
+   */
+  void writeTriangulationTo(cad::FeaturePtr f, const boost::filesystem::path& fn) const
+  {
+      snappyHexMeshFeats::writeTriangulatedSurface(
+          f->hash(),
+          [&]() { return triangulation(f, snappyHexMeshFeats::surfaceTolerance); },
+          fn );
+  }
+
+public:
+  /**
+   * @brief transformedGeometry
+   * @return
+   * the geometry after application of the scaling and transformation parameters
+   */
+  cad::FeaturePtr transformedGeometry() const
+  {
+      insight::SpatialTransformation trsf(
+          p().translate, p().rollPitchYaw, p().scalefactor );
+
+      cad::FeaturePtr geo= cad::Transform::create(
+          p().geometry->geometry(),
+          cad::is_gp_Trsf(trsf)
+      );
+
+      arma::mat as=p().inhomscale;
+      if ( arma::norm( as-vec3One(), 2 ) > SMALL )
+      {
+          geo=cad::InhomScale::create(geo, cad::matconst(as));
+      }
+
+      return geo;
+  }
+
+  /**
+   * @brief triangulation
+   * @return
+   * the triangulation of the transformed geometry, which is written
+   * into the geometry file
+   */
+  TopoDS_Shape triangulation() const
+  {
+      return triangulation(
+          preparedGeometry_ ? preparedGeometry_ : transformedGeometry(),
+          snappyHexMeshFeats::surfaceTolerance );
+  }
+
+  /**
+   * neither the file import nor the feature creation is thread safe,
+   * do both in advance
+   */
+  void prepareFiles() const override
+  {
+      preparedGeometry_ = transformedGeometry();
+      preparedGeometry_->checkForBuildDuringAccess();
+  }
+
+  /**
+   * the triangulation and export of the transformed geometry
+   * does not interfere with other features
+   */
+  bool modifyFilesConcurrently() const override
+  {
+      return true;
+  }
+
   virtual void putIntoConstantTrisurface(
       const OpenFOAMCase& ofc,
       const boost::filesystem::path& location
       ) const
     {
-        // boost::filesystem::path from( p().fileName->localFilePath() );
         boost::filesystem::path to(
             snappyHexMeshFeats::geometryDir(ofc, location)
             /fileName() );
@@ -151,35 +290,15 @@ public:
         if (!exists(to.parent_path()))
             create_directories(to.parent_path());
 
-
-        insight::SpatialTransformation trsf(
-            p().translate, p().rollPitchYaw, p().scalefactor );
-
         std::cout
             << "transforming " << this->name()
-            << " by " << trsf
             << " to " << to
             << std::endl;
 
-        cad::FeaturePtr geo= cad::Transform::create(
-            p().geometry->geometry(),
-            cad::is_gp_Trsf(trsf)
-        );
-
-        arma::mat as=p().inhomscale;
-        if ( arma::norm( as-vec3One(), 2 ) > SMALL )
-        {
-            geo=cad::InhomScale::create(geo, cad::matconst(as));
-        }
-
         writeTo(
-            geo,
+            preparedGeometry_ ? preparedGeometry_ : transformedGeometry(),
             to
         );
-
-        // writeSTL(
-        //     readSTL(from, {&trsf}),
-        //     to );
     }
 
 
@@ -223,6 +342,20 @@ public:
       const OpenFOAMCase& ofc,
       const boost::filesystem::path& location ) const;
 
+  /**
+   * @brief prepareFiles
+   * work, which has to be done before modifyFiles() is called
+   * concurrently (e.g. non-thread-safe imports). Called sequentially.
+   */
+  virtual void prepareFiles() const;
+
+  /**
+   * @brief modifyFilesConcurrently
+   * @return
+   * true, if modifyFiles() may run in parallel to the modifyFiles() of other features
+   */
+  virtual bool modifyFilesConcurrently() const;
+
   virtual bool producesPrismLayers() const;
 
   virtual std::string name() const;
@@ -34,6 +34,7 @@ IQGraphProgressChart::IQGraphProgressChart(
 
     maxCnt_(8000),
     needsRedraw_(true),
+    updatingAxes_(false),
     logscale_(logscale)
 {
     auto *graphLayout = new QVBoxLayout;
@@ -62,6 +63,16 @@ IQGraphProgressChart::IQGraphProgressChart(
     toplayout->addWidget(fromx);
     toplayout->addWidget(new QLabel(_("to:")));
     toplayout->addWidget(tox);
+    for (auto* le: {fromx, tox})
+    {
+        connect(le, &QLineEdit::textChanged, this,
+                [this]()
+                {
+                    mutex_.lock();
+                    needsRedraw_=true;
+                    mutex_.unlock();
+                } );
+    }
     toplayout->addItem(
         new QSpacerItem(
             10,10,
@@ -74,6 +85,7 @@ IQGraphProgressChart::IQGraphProgressChart(
     setLayout(graphLayout);
 
     chartView_->setChart(chartData_);
+    chartView_->setRubberBand(QtCharts::QChartView::HorizontalRubberBand);
 
     chartView_->setBackgroundBrush( Qt::white );
 
@@ -87,7 +99,20 @@ IQGraphProgressChart::IQGraphProgressChart(
     {
         chartData_->addAxis(new QtCharts::QValueAxis, Qt::AlignLeft);
     }
-    chartData_->addAxis(new QtCharts::QValueAxis, Qt::AlignBottom);
+    auto *lx = new QtCharts::QValueAxis;
+    chartData_->addAxis(lx, Qt::AlignBottom);
+    // zooming by rubber band: take over the new range into the range fields,
+    // so that the series get re-extracted at the new resolution
+    connect(lx, &QtCharts::QValueAxis::rangeChanged, this,
+            [this](qreal min, qreal max)
+            {
+                if (!updatingAxes_)
+                {
+                    fromx->setText(QString::number(min));
+                    tox->setText(QString::number(max));
+                }
+            }
+    );
     chartData_->legend()->hide();
 
     auto hax=chartData_->axes(Qt::Horizontal);
@@ -198,8 +223,6 @@ void IQGraphProgressChart::checkForUpdate()
         ChartBounds b;
         for (auto& sd: curve_)
         {
-            sd.second->updateLineSeries(width());
-
             if (sd.second->isVisible())
             {
                 b.update(sd.second->bounds());
@@ -236,12 +259,23 @@ void IQGraphProgressChart::checkForUpdate()
             }
         }
 
+        // extract only the points needed for the visible range and resolution
+        int pixelWidth = std::max<int>(1, chartData_->plotArea().width());
+        for (auto& sd: curve_)
+        {
+            sd.second->updateLineSeries(pixelWidth, b.xmin, b.xmax);
+        }
+
+        updatingAxes_=true;
+
         auto hax=chartData_->axes(Qt::Horizontal);
         hax[0]->setRange(b.xmin, b.xmax);
 
         auto vax=chartData_->axes(Qt::Vertical);
         vax[0]->setRange(b.ymin, b.ymax);
 
+        updatingAxes_=false;
+
         repaint();
     }
 
@@ -269,9 +303,9 @@ bool IQLineSeriesData::isVisible() const
 
 void IQLineSeriesData::exportToCSV(std::ostream &os) const
 {
-    for (int i=0; i<crv->count(); ++i)
+    for (size_t i=0; i<values_.size(); ++i)
     {
-        os<<crv->at(i).x()<<" "<<crv->at(i).y()<<"\n";
+        os<<values_.x(i)<<" "<<values_.y(i)<<"\n";
     }
 }
 
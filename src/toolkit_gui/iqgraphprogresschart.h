@@ -31,6 +31,7 @@ protected:
 
     CurveList curve_;
     bool needsRedraw_;
+    bool updatingAxes_;
     QMutex mutex_;
     bool logscale_;
 
@@ -1,6 +1,8 @@
 #include "iqlineseriesdata.h"
 
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
 
 #include <QRandomGenerator>
 #include <QToolTip>
@@ -42,6 +44,219 @@ void ChartBounds::update(const ChartBounds &o)
 
 
 
+MinMaxPyramidSeries::MinMaxPyramidSeries()
+    : xMonotonic_(true)
+{}
+
+
+
+
+size_t MinMaxPyramidSeries::blockSize(size_t level) const
+{
+    size_t s=leafSize;
+    for (size_t l=0; l<level; ++l) s*=fanOut;
+    return s;
+}
+
+
+
+
+void MinMaxPyramidSeries::addToBlock(Block &b, size_t i) const
+{
+    if (y_[i]<y_[b.iMin]) b.iMin=i;
+    if (y_[i]>y_[b.iMax]) b.iMax=i;
+}
+
+
+
+
+void MinMaxPyramidSeries::append(double x, double y)
+{
+    if (!x_.empty() && x<x_.back())
+        xMonotonic_=false;
+
+    size_t i=x_.size();
+    x_.push_back(x);
+    y_.push_back(y);
+
+    if (levels_.empty())
+        levels_.push_back({});
+
+    for (size_t l=0; l<levels_.size(); ++l)
+    {
+        auto& lv=levels_[l];
+        size_t bi=i/blockSize(l);
+        if (bi==lv.size())
+            lv.push_back({i, i});
+        else
+            addToBlock(lv[bi], i);
+    }
+
+    // add a coarser level, once the top level has more than one block
+    while (levels_.back().size()>1)
+    {
+        std::vector<Block> nl;
+        const auto& top=levels_.back();
+        for (size_t bi=0; bi<top.size(); ++bi)
+        {
+            if (bi%fanOut==0)
+                nl.push_back(top[bi]);
+            else
+            {
+                addToBlock(nl.back(), top[bi].iMin);
+                addToBlock(nl.back(), top[bi].iMax);
+            }
+        }
+        levels_.push_back(nl);
+    }
+}
+
+
+
+
+void MinMaxPyramidSeries::clear()
+{
+    x_.clear();
+    y_.clear();
+    levels_.clear();
+    xMonotonic_=true;
+}
+
+
+
+
+void MinMaxPyramidSeries::truncate(size_t n)
+{
+    if (n>=size()) return;
+    if (n==0)
+    {
+        clear();
+        return;
+    }
+
+    x_.resize(n);
+    y_.resize(n);
+
+    // finer levels first: they are used to recompute the partial blocks
+    for (size_t l=0; l<levels_.size(); ++l)
+    {
+        auto& lv=levels_[l];
+        size_t bs=blockSize(l);
+        size_t nb=(n+bs-1)/bs;
+        lv.resize(nb);
+
+        size_t i0=(nb-1)*bs;
+        if (n-i0<bs)
+        {
+            auto& b=lv.back();
+            minMax(i0, n, b.iMin, b.iMax);
+        }
+    }
+}
+
+
+
+
+void MinMaxPyramidSeries::minMax(size_t i0, size_t i1, size_t &iMin, size_t &iMax) const
+{
+    iMin=iMax=i0;
+    size_t i=i0;
+    while (i<i1)
+    {
+        // use the coarsest complete block starting at i, which fits into the range
+        int l=int(levels_.size())-1;
+        for (; l>=0; --l)
+        {
+            size_t bs=blockSize(l);
+            if ( (i%bs==0) && (i+bs<=i1) )
+                break;
+        }
+
+        if (l<0)
+        {
+            if (y_[i]<y_[iMin]) iMin=i;
+            if (y_[i]>y_[iMax]) iMax=i;
+            ++i;
+        }
+        else
+        {
+            size_t bs=blockSize(l);
+            const auto& b=levels_[l][i/bs];
+            if (y_[b.iMin]<y_[iMin]) iMin=b.iMin;
+            if (y_[b.iMax]>y_[iMax]) iMax=b.iMax;
+            i+=bs;
+        }
+    }
+}
+
+
+
+
+std::vector<MinMaxPyramidSeries::Point>
+MinMaxPyramidSeries::extract(double xmin, double xmax, int nColumns) const
+{
+    std::vector<Point> pts;
+
+    size_t n=size();
+    if (n==0) return pts;
+
+    // index range of displayed samples, including one neighbour on each side
+    size_t i0=0, i1=n;
+    if (xMonotonic_)
+    {
+        i0=std::lower_bound(x_.begin(), x_.end(), xmin)-x_.begin();
+        i1=std::upper_bound(x_.begin(), x_.end(), xmax)-x_.begin();
+        if (i0>0) --i0;
+        if (i1<n) ++i1;
+    }
+    if (i1<=i0) return pts;
+
+    nColumns=std::max(1, nColumns);
+
+    if ( (i1-i0) <= 4*size_t(nColumns) )
+    {
+        for (size_t i=i0; i<i1; ++i)
+            pts.push_back({x_[i], y_[i]});
+        return pts;
+    }
+
+    pts.reserve(4*nColumns);
+
+    double x0=x_[i0], dx=(x_[i1-1]-x_[i0])/double(nColumns);
+
+    size_t ja=i0;
+    for (int c=0; c<nColumns && ja<i1; ++c)
+    {
+        size_t jb;
+        if (c==nColumns-1)
+            jb=i1;
+        else if (xMonotonic_ && dx>0.)
+            jb=std::lower_bound(x_.begin()+ja, x_.begin()+i1, x0+double(c+1)*dx)-x_.begin();
+        else
+            jb=i0+(i1-i0)*size_t(c+1)/size_t(nColumns);
+
+        if (jb>ja)
+        {
+            size_t iMin, iMax;
+            minMax(ja, jb, iMin, iMax);
+
+            size_t idx[]={ ja, std::min(iMin, iMax), std::max(iMin, iMax), jb-1 };
+            for (int k=0; k<4; ++k)
+            {
+                if (k==0 || idx[k]!=idx[k-1])
+                    pts.push_back({x_[idx[k]], y_[idx[k]]});
+            }
+        }
+
+        ja=jb;
+    }
+
+    return pts;
+}
+
+
+
+
 IQLineSeriesData::IQLineSeriesData(
     const QString& name,
     QtCharts::QChart* chart,
@@ -87,28 +302,21 @@ IQLineSeriesData::IQLineSeriesData(
 
 void IQLineSeriesData::append(double x, double y)
 {
-    values.append(QPointF(x,y));
+    values_.append(x, y);
     b_.update(x, y);
 }
 
 
 
 
-void IQLineSeriesData::updateLineSeries(int maxResolution)
+void IQLineSeriesData::updateLineSeries(int pixelWidth, double xmin, double xmax)
 {
-    QList<QPointF> ptDisplay;
+    auto pts = values_.extract(xmin, xmax, pixelWidth);
 
-    int nv=values.size();
-    int i=0;
-    if (nv>maxRecent)
-    {
-        int nx = nv-1-maxRecent;
-        int spc = std::max<int>(1, floor(double(nx)/double(maxResolution-maxRecent)));
-        for (;i<nx;i+=spc)
-            ptDisplay.append(values.at(i));
-    }
-    for(;i<nv;++i)
-        ptDisplay.append(values.at(i));
+    QList<QPointF> ptDisplay;
+    ptDisplay.reserve(pts.size());
+    for (const auto& p: pts)
+        ptDisplay.append(QPointF(p.first, p.second));
 
     crv->replace(ptDisplay);
 }
@@ -6,6 +6,8 @@
 #include <QtCharts/QChart>
 #include <QtCharts/QLineSeries>
 
+#include <vector>
+
 struct ChartBounds
 {
     double xmin, ymin, xmax, ymax;
@@ -19,16 +21,84 @@ struct ChartBounds
 
 
 
+/**
+ * @brief The MinMaxPyramidSeries class
+ * Append-only storage of a data series with a hierarchical min/max summary.
+ *
+ * Level l of the summary holds, for consecutive blocks of leafSize*fanOut^l
+ * samples, the indices of the minimum and maximum y value. Appending updates
+ * one block per level.
+ *
+ * For display, the points needed to draw the series into a given number
+ * of pixel columns are extracted without losing any extrema (M4 decimation:
+ * first, min, max and last sample of each column).
+ */
+class MinMaxPyramidSeries
+{
+public:
+    static const size_t leafSize=16, fanOut=4;
+
+    typedef std::pair<double,double> Point;
+
+private:
+    struct Block
+    {
+        size_t iMin, iMax;
+    };
+
+    std::vector<double> x_, y_;
+    std::vector<std::vector<Block> > levels_;
+    bool xMonotonic_;
+
+    size_t blockSize(size_t level) const;
+    void addToBlock(Block& b, size_t i) const;
+    void minMax(size_t i0, size_t i1, size_t& iMin, size_t& iMax) const;
+
+public:
+    MinMaxPyramidSeries();
+
+    void append(double x, double y);
+    void clear();
+    /**
+     * @brief truncate
+     * keep only the first n samples.
+     * Only the last, partial block of each level is recomputed.
+     * The series stays marked as non-monotonic, once it was.
+     */
+    void truncate(size_t n);
+
+    inline size_t size() const { return x_.size(); }
+    inline double x(size_t i) const { return x_[i]; }
+    inline double y(size_t i) const { return y_[i]; }
+    inline bool xMonotonic() const { return xMonotonic_; }
+
+    /**
+     * @brief extract
+     * @param xmin
+     * @param xmax
+     * displayed x range
+     * @param nColumns
+     * number of pixel columns
+     * @return
+     * at most 4*nColumns points (plus the neighbours just outside the range)
+     * in ascending index order
+     */
+    std::vector<Point> extract(double xmin, double xmax, int nColumns) const;
+};
+
+
+
+
+
+
 class IQLineSeriesData
     : public QObject
 {
     Q_OBJECT
 
-    const int maxRecent=100;
-
     QtCharts::QLineSeries* crv;
 
-    QList<QPointF> values;
+    MinMaxPyramidSeries values_;
 
     IQChartInteractiveLegend *legend_;
 
@@ -41,7 +111,7 @@ public:
         IQChartInteractiveLegend *legend );
 
     void append(double x, double y);
-    void updateLineSeries(int maxResolution=1000);
+    void updateLineSeries(int pixelWidth, double xmin, double xmax);
 
     QColor color() const;
     bool isVisible() const;
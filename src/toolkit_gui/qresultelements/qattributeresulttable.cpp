@@ -39,6 +39,10 @@ class QAttributeTableView
     void updateContent()
     {
         auto width=viewport()->width();
+
+      // render all formulas at once
+      insight::SimpleLatex::prerenderFormulas(tab_->names());
+
       QStringList headers;
       headers
               << QString::fromStdString(tab_->labelColumnTitle().toHTML(width))
@@ -0,0 +1,88 @@
+#include "base/exception.h"
+
+#include "cadfeatures.h"
+#include "cadpostprocactions.h"
+#include "cadparameters/constantscalar.h"
+#include "cadparameters/constantvector.h"
+
+using namespace insight;
+using namespace insight::cad;
+
+int main(int, char*argv[])
+{
+    try
+    {
+        // box shaped hull: L=10, B=4, H=3, keel at z=0, centre plane y=0
+        const double L=10., B=4., H=3.;
+        auto hull = Box::create(
+            matconst(vec3(0, -0.5*B, 0)),
+            matconst(vec3(L, 0, 0)),
+            matconst(vec3(0, B, 0)),
+            matconst(vec3(0, 0, H)) );
+
+        HydrostaticCurves::ScalarList drafts = { scalarconst(1.), scalarconst(2.) };
+        HydrostaticCurves::ScalarList heels = { scalarconst(0.) };
+        HydrostaticCurves::ScalarList trims = { scalarconst(0.) };
+
+        auto hc = HydrostaticCurves::create(
+            hull, hull,
+            matconst(vec3(0, 0, 0)),
+            matconst(vec3(1, 0, 0)),
+            matconst(vec3(0, 0, 1)),
+            drafts, heels, trims );
+
+        const auto& cs = hc->conditions();
+        insight::assertion(cs.size()==2, "expected 2 conditions, got %d", int(cs.size()));
+
+        auto check = [](double v, double ref, const std::string& name)
+        {
+            insight::assertion(
+                std::fabs(v-ref) < 1e-6*std::max(1., std::fabs(ref)),
+                "wrong %s: %g, expected %g", name.c_str(), v, ref );
+        };
+
+        const double KG = 0.5*H; // homogeneous ship model: same box
+        for (const auto& c: cs)
+        {
+            double V = L*B*c.T;
+            check(c.V, V, "V");
+            check(c.Awp, L*B, "A_WP");
+            check(c.KB, 0.5*c.T, "KB");
+            check(c.BMT, L*B*B*B/12./V, "BM_T");
+            check(c.BML, B*L*L*L/12./V, "BM_L");
+            check(c.GMT, 0.5*c.T + L*B*B*B/12./V - KG, "GM_T");
+            check(c.LCB, 0.5*L, "LCB");
+            check(c.LCF, 0.5*L, "LCF");
+        }
+
+        // tabular result: one row per condition
+        // (T, heel, trim, V, KB, BM_T, BM_L, GM_T, GM_L, A_WP, LCB, LCF)
+        auto tab = hc->table();
+        const auto& rows = tab->rows();
+        insight::assertion(rows.size()==cs.size(), "expected one table row per condition");
+        insight::assertion(tab->headings().size()==12, "expected 12 table columns");
+        for (const auto& r: rows)
+        {
+            insight::assertion(r.size()==12, "expected 12 values per row");
+            double T=r[0], V=L*B*T;
+            check(r[1], 0., "heel in table");
+            check(r[2], 0., "trim in table");
+            check(r[3], V, "V in table");
+            check(r[4], 0.5*T, "KB in table");
+            check(r[5], L*B*B*B/12./V, "BM_T in table");
+            check(r[6], B*L*L*L/12./V, "BM_L in table");
+            check(r[7], 0.5*T + L*B*B*B/12./V - KG, "GM_T in table");
+            check(r[8], 0.5*T + B*L*L*L/12./V - KG, "GM_L in table");
+            check(r[9], L*B, "A_WP in table");
+            check(r[10], 0.5*L, "LCB in table");
+            check(r[11], 0.5*L, "LCF in table");
+        }
+        check(rows[1][0], 2., "T of second row");
+    }
+    catch (insight::Exception& e)
+    {
+        std::cerr<<e.what()<<std::endl;
+        return -1;
+    }
+    return 0;
+}
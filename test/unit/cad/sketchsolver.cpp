@@ -66,6 +66,18 @@ int main(int, char*argv[])
 
         csk->resolveConstraints();
 
+        for (const auto& g: *csk)
+        {
+            for (int i=0; i<g.second->nConstraints(); ++i)
+            {
+                double err=g.second->getConstraintError(i);
+                insight::assertion(
+                    fabs(err)<1e-8,
+                    "constraint %d of entity %d not satisfied (error %g)",
+                    i, g.first, err );
+            }
+        }
+
         std::cout<<"solution=\n======================\n"<<std::endl;
         for (const auto& g: *csk)
         {
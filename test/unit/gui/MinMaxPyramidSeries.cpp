@@ -0,0 +1,121 @@
+#include "iqlineseriesdata.h"
+#include "base/exception.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace insight;
+
+int main()
+{
+    try
+    {
+        MinMaxPyramidSeries s;
+        std::vector<double> y;
+
+        const int n=100000;
+        for (int i=0; i<n; ++i)
+        {
+            double yi = std::sin(1e-3*i);
+            if (i==12345) yi=10.;  // single spike
+            if (i==67890) yi=-10.;
+            s.append(0.5*i, yi);
+            y.push_back(yi);
+        }
+
+        // full range: spikes must survive decimation
+        {
+            auto pts = s.extract(0., 0.5*n, 500);
+            insight::assertion(
+                pts.size()<=4*500,
+                "too many points extracted: %d", int(pts.size()) );
+
+            double ymin=1e10, ymax=-1e10;
+            for (const auto& p: pts)
+            {
+                ymin=std::min(ymin, p.second);
+                ymax=std::max(ymax, p.second);
+            }
+            insight::assertion(ymax==10., "maximum lost in decimation");
+            insight::assertion(ymin==-10., "minimum lost in decimation");
+            std::cout<<"PASS  1: extrema preserved"<<std::endl;
+        }
+
+        // zoomed range: compare extrema with brute force
+        {
+            int i0=20000, i1=70000;
+            auto pts = s.extract(0.5*i0, 0.5*i1, 123);
+
+            double ymax=-1e10, ymaxRef=-1e10;
+            for (const auto& p: pts)
+            {
+                insight::assertion(
+                    p.first>=0.5*(i0-1) && p.first<=0.5*(i1+1),
+                    "point outside requested range" );
+                ymax=std::max(ymax, p.second);
+            }
+            for (int i=i0-1; i<=i1+1; ++i)
+                ymaxRef=std::max(ymaxRef, y[i]);
+
+            insight::assertion(ymax==ymaxRef, "wrong maximum in zoomed range");
+            std::cout<<"PASS  2: zoomed range"<<std::endl;
+        }
+
+        // small range: all raw samples returned
+        {
+            auto pts = s.extract(100., 110., 800);
+            insight::assertion(
+                pts.size()==23, // 21 samples inside, plus one neighbour each side
+                "expected raw samples, got %d", int(pts.size()) );
+            std::cout<<"PASS  3: raw samples at high zoom"<<std::endl;
+        }
+
+        // truncation before the negative spike, then append again
+        {
+            const int nt=50001;
+            s.truncate(nt);
+            y.resize(nt);
+            insight::assertion(s.size()==size_t(nt), "wrong size after truncation");
+
+            auto checkExtrema = [&](const char* stage)
+            {
+                auto pts = s.extract(0., 0.5*y.size(), 321);
+                double ymin=1e10, ymax=-1e10, yminRef=1e10, ymaxRef=-1e10;
+                for (const auto& p: pts)
+                {
+                    ymin=std::min(ymin, p.second);
+                    ymax=std::max(ymax, p.second);
+                }
+                for (double yi: y)
+                {
+                    yminRef=std::min(yminRef, yi);
+                    ymaxRef=std::max(ymaxRef, yi);
+                }
+                insight::assertion(
+                    ymin==yminRef && ymax==ymaxRef,
+                    "wrong extrema %s: %g/%g, expected %g/%g",
+                    stage, ymin, ymax, yminRef, ymaxRef );
+            };
+
+            checkExtrema("after truncation");
+
+            for (int i=nt; i<nt+777; ++i)
+            {
+                double yi = std::cos(1e-2*i);
+                if (i==nt+500) yi=-20.;
+                s.append(0.5*i, yi);
+                y.push_back(yi);
+            }
+            checkExtrema("after appending");
+
+            std::cout<<"PASS  4: truncation"<<std::endl;
+        }
+    }
+    catch (std::exception& ex)
+    {
+        std::cerr<<"Failed: "<<ex.what()<<std::endl;
+        return -1;
+    }
+    std::cout<<"Passed"<<std::endl;
+    return 0;
+}
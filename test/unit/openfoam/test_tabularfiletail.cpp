@@ -0,0 +1,92 @@
+#include "base/exception.h"
+#include "base/casedirectory.h"
+
+#include "tabularfiletail.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace insight;
+
+
+std::vector<std::vector<double> > columns(std::initializer_list<TabularFileTail::Row> rows)
+{
+    std::vector<std::vector<double> > data;
+    mergeRows(data, std::vector<TabularFileTail::Row>(rows), false);
+    return data;
+}
+
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // plain append
+        {
+            auto data = columns({ {0, 10}, {1, 11} });
+            size_t pos = mergeRows(data, { {2, 12}, {3, 13} }, true);
+            insight::assertion(pos==2, "expected append at 2, got %d", int(pos));
+            insight::assertion(
+                data[0]==std::vector<double>({0, 1, 2, 3})
+                && data[1]==std::vector<double>({10, 11, 12, 13}),
+                "wrong data after append" );
+            std::cout<<"PASS  1: append"<<std::endl;
+        }
+
+        // interleaved rows from several files: only the tail is rebuilt
+        {
+            auto data = columns({ {0, 10}, {2, 12}, {4, 14}, {6, 16} });
+            size_t pos = mergeRows(data, { {5, 15}, {3, 13}, {7, 17} }, true);
+            insight::assertion(pos==2, "expected first change at 2, got %d", int(pos));
+            insight::assertion(
+                data[0]==std::vector<double>({0, 2, 3, 4, 5, 6, 7})
+                && data[1]==std::vector<double>({10, 12, 13, 14, 15, 16, 17}),
+                "wrong data after merge" );
+            std::cout<<"PASS  2: interleave"<<std::endl;
+        }
+
+        // unsorted: always appended
+        {
+            auto data = columns({ {5, 15} });
+            size_t pos = mergeRows(data, { {1, 11} }, false);
+            insight::assertion(
+                pos==1 && data[0]==std::vector<double>({5, 1}),
+                "unsorted rows have to be appended" );
+            std::cout<<"PASS  3: unsorted"<<std::endl;
+        }
+
+        // incremental reading of a growing file
+        {
+            CaseDirectory d(false);
+            auto fn = d/"data.dat";
+
+            std::ofstream f(fn.string());
+            f<<"# t v\n0 1\n1 2\n2 3"<<std::flush; // last line incomplete
+
+            TabularFileTail t(fn);
+            insight::assertion(t.readNew(), "unexpected restart");
+            auto r1=t.takeNewRows();
+            insight::assertion(r1.size()==2, "expected 2 rows, got %d", int(r1.size()));
+
+            f<<"\n3 4\n"<<std::flush;
+            insight::assertion(t.readNew(), "unexpected restart");
+            auto r2=t.takeNewRows();
+            insight::assertion(
+                r2.size()==2 && r2[0][1]==3. && r2[1][0]==3.,
+                "expected the completed and the appended row" );
+
+            f.close();
+            std::ofstream(fn.string())<<"0 1\n";
+            insight::assertion(!t.readNew(), "truncation not detected");
+            insight::assertion(t.takeNewRows().size()==1, "expected re-read row");
+            std::cout<<"PASS  4: incremental reading"<<std::endl;
+        }
+    }
+    catch (std::exception& ex)
+    {
+        std::cerr<<"Failed: "<<ex.what()<<std::endl;
+        return -1;
+    }
+    std::cout<<"Passed"<<std::endl;
+    return 0;
+}
@@ -20,6 +20,10 @@
 
 #include "simple_analysis.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 
 namespace insight
 {
@@ -40,8 +44,23 @@ SimpleAnalysis::SimpleAnalysis(const std::shared_ptr<supplementedInputDataBase>&
 
 
 
+namespace {
+std::atomic<int> nRunning(0), maxRunning(0);
+}
+
+
+
 ResultSetPtr SimpleAnalysis::operator()(ProgressDisplayer& /*pd*/)
 {
+    int n = ++nRunning;
+    int m = maxRunning;
+    while ( n>m && !maxRunning.compare_exchange_weak(m, n) ) {}
+
+    std::this_thread::sleep_for(
+        std::chrono::duration<double>(p().duration) );
+
+    --nRunning;
+
     auto results = createResultSet();
     
     results->insert<ScalarResult>("y",
@@ -55,6 +74,13 @@ ResultSetPtr SimpleAnalysis::operator()(ProgressDisplayer& /*pd*/)
 
 
 
+int SimpleAnalysis::maxConcurrentInstances()
+{
+    return maxRunning;
+}
+
+
+
 RangeParameterList rpl_SimpleAnalysis = list_of<std::string>("x");
 
 class SimpleParameterStudy
@@ -73,6 +99,16 @@ public:
     {
         ResultSetPtr results = ParameterStudy::evaluateRuns();
 
+        int nc = SimpleAnalysis::maxConcurrentInstances();
+        std::cout<<"max. concurrent instances: "<<nc<<std::endl;
+        if ( parameters().getInt("run/numthread")>1
+             && parameters().getDouble("duration")>0. )
+        {
+            insight::assertion(
+                nc>1,
+                "the instances of the parameter study were not run concurrently" );
+        }
+
         std::string key="yTable";
         
         results->insert(key, table("", "", "x", 
@@ -18,6 +18,7 @@ public:
 /*
 PARAMETERSET>>> SimpleAnalysis Parameters
 x = double 0 "x value"
+duration = double 0 "time in seconds, which the analysis takes"
 <<<PARAMETERSET
 */
 
@@ -28,6 +29,11 @@ public:
     SimpleAnalysis(const std::shared_ptr<supplementedInputDataBase>& sp);
     ResultSetPtr operator()(ProgressDisplayer& p = consoleProgressDisplayer) override;
 
+    /**
+     * maximum number of instances, which were running at the same time
+     */
+    static int maxConcurrentInstances();
+
     static std::string category() { return "Test"; }
     static AnalysisDescription description() { return {"Test", ""}; }
 };
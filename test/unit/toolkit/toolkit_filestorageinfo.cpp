@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+
+#include "base/exception.h"
+#include "base/casedirectory.h"
+#include "base/filestorageinfo.h"
+
+#include "boost/filesystem/operations.hpp"
+
+using namespace insight;
+using namespace boost::filesystem;
+
+
+void write(const path& f, const std::string& content="x")
+{
+  std::ofstream o(f.string());
+  o<<content<<std::endl;
+}
+
+
+path stamp(const path& f)
+{
+  return f.parent_path() / ("."+f.filename().string()+".hash");
+}
+
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  try
+  {
+    CaseDirectory dir(false, temp_directory_path()/"filestorageinfo-test");
+
+    auto since = std::time(nullptr);
+    auto before = since-100;
+
+    // hash stamp: skip regeneration of unchanged files
+    {
+      auto img = dir/"chart.png";
+      insight::assertion(
+          !generatedFileIsUpToDate(img, "hash1"),
+          "missing file reported as up to date" );
+
+      write(img);
+      insight::assertion(
+          !generatedFileIsUpToDate(img, "hash1"),
+          "file without stamp reported as up to date" );
+
+      markGeneratedFile(img, "hash1");
+      insight::assertion(
+          exists(stamp(img)),
+          "no stamp file written" );
+      insight::assertion(
+          !generatedFileIsUpToDate(img, "hash2"),
+          "file with different hash reported as up to date" );
+
+      last_write_time(img, before);
+      last_write_time(stamp(img), before);
+      insight::assertion(
+          generatedFileIsUpToDate(img, "hash1"),
+          "unchanged file not reported as up to date" );
+      insight::assertion(
+          last_write_time(stamp(img))>=since,
+          "stamp file of up to date file was not touched" );
+      insight::assertion(
+          last_write_time(img)==before,
+          "up to date file was modified" );
+    }
+
+    // purge of files, which were not used since a given time
+    {
+      create_directories(dir/"sub");
+
+      auto written = dir/"written.dat";
+      write(written);
+
+      auto reused = dir/"reused.png";
+      write(reused);
+      markGeneratedFile(reused, "h");
+      last_write_time(reused, before);
+      last_write_time(stamp(reused), before);
+      insight::assertion(
+          generatedFileIsUpToDate(reused, "h"),
+          "unchanged file not reported as up to date" );
+
+      auto outdated = dir/"outdated.png";
+      write(outdated);
+      markGeneratedFile(outdated, "h");
+      last_write_time(outdated, before);
+      last_write_time(stamp(outdated), before);
+
+      auto removed = dir/"removed.dat";
+      write(removed);
+      last_write_time(removed, before);
+
+      auto removedSub = dir/"sub"/"removed.dat";
+      write(removedSub);
+      last_write_time(removedSub, before);
+
+      removeStaleFiles(dir, since);
+
+      insight::assertion(exists(written), "written file was removed");
+      insight::assertion(exists(reused), "reused file was removed");
+      insight::assertion(exists(stamp(reused)), "stamp of reused file was removed");
+      insight::assertion(!exists(outdated), "unused generated file was not removed");
+      insight::assertion(!exists(stamp(outdated)), "stamp of unused generated file was not removed");
+      insight::assertion(!exists(removed), "stale file was not removed");
+      insight::assertion(!exists(removedSub), "stale file in subdirectory was not removed");
+
+      removeStaleFiles(dir/"nonexisting", since);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr<<"Error occurred: "<<e.what()<<std::endl;
+    return -1;
+  }
+
+  return 0;
+}
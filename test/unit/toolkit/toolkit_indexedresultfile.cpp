@@ -0,0 +1,98 @@
+#include "base/resultset.h"
+#include "base/indexedresultfile.h"
+#include "base/casedirectory.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include "boost/filesystem/operations.hpp"
+#include "smiley_image.h"
+#include "test_pdl.h"
+
+using namespace std;
+using namespace insight;
+
+int main()
+{
+    try
+    {
+        auto result = std::make_shared<ResultSet>(
+            TestPDL::defaultParameters(),
+            "Title", "Subtitle"
+            );
+
+        result->insert<ScalarResult>("scalarresult",
+                42, "the answer on everything", "", "J");
+
+        result->insert<Image>(
+            "image",
+            FileContainer(smileyImageBase64, "smiley.jpeg"),
+            "a smiley", "" );
+
+        auto &sec=result->insert<ResultSection>(
+            "resultsection", "Subsection", "");
+        sec.insert<ScalarResult>("nested",
+                3.5, "a nested scalar", "", "m");
+        sec.insert<Chart>("someChart",
+            "$x$/m", "\\Psi",
+            PlotCurveList{
+                PlotCurve(std::vector<double>{0.,1.,2.}, {2.,4.,16.}, "crv1",
+                          "w l lc 1 t 'Curve 1'") },
+            "Some plot", "" );
+
+        CaseDirectory tmp(false);
+        auto fn = tmp/"result.isr";
+        result->saveToFile(fn);
+
+        for (int pass=0; pass<2; ++pass) // second pass: read stored index
+        {
+            IndexedResultFile rf(fn);
+
+            insight::assertion(
+                pass==0 || boost::filesystem::exists(IndexedResultFile::indexFilePath(fn)),
+                "expected index file to be written" );
+
+            std::vector<std::string> expectedPaths{
+                "image", "resultsection", "resultsection/nested",
+                "resultsection/someChart", "scalarresult" };
+            auto paths = rf.contents();
+            std::sort(paths.begin(), paths.end());
+            for (const auto& p: paths) std::cout<<p<<" ("<<rf.elementType(p)<<")"<<std::endl;
+            insight::assertion(
+                paths==expectedPaths,
+                "unexpected contents of indexed result file" );
+
+            insight::assertion(
+                rf.elementType("resultsection/someChart")=="Chart",
+                "unexpected element type" );
+
+            insight::assertion(
+                rf.getScalar("scalarresult")==42.,
+                "unexpected value of scalar result" );
+            insight::assertion(
+                rf.getScalar("resultsection/nested")==3.5,
+                "unexpected value of nested scalar result" );
+
+            const auto& c = rf.get<Chart>("resultsection/someChart");
+            insight::assertion(
+                c.isEqual(result->get<Chart>("resultsection/someChart")),
+                "expected equality of chart after indexed read" );
+
+            insight::assertion(
+                rf.get<ResultSection>("resultsection").isEqual(sec),
+                "expected equality of section after indexed read" );
+
+            insight::assertion(
+                rf.parameters().isEqual(result->parameters()),
+                "expected equality of parameters after indexed read" );
+        }
+
+        return 0;
+    }
+    catch (std::exception& e)
+    {
+        cerr<<e.what()<<endl;
+        return -1;
+    }
+}
@@ -0,0 +1,79 @@
+#include <functional>
+#include "base/linearalgebra.h"
+
+using namespace insight;
+
+
+
+int main(int /*argc*/, char*/*argv*/[])
+{
+  try
+  {
+      // root of a 2D system, with and without analytic jacobian
+      auto F = [](const arma::mat& x) -> arma::mat
+      {
+          return arma::mat{ x(0)*x(0)+x(1)*x(1)-4., x(0)-x(1) }.t();
+      };
+      auto J = [](const arma::mat& x) -> arma::sp_mat
+      {
+          arma::mat j{ {2.*x(0), 2.*x(1)}, {1., -1.} };
+          return arma::sp_mat(j);
+      };
+
+      arma::mat x1 = nonlinearSolveND(F, J, arma::mat{1., 0.5}.t(), 1e-10);
+      arma::mat x2 = nonlinearSolveND(F, JacobianFunction(), arma::mat{1., 0.5}.t(), 1e-10);
+      std::cout<<"x1="<<x1.t()<<"x2="<<x2.t()<<std::endl;
+
+      insight::assertion(
+          arma::norm(x1-sqrt(2.), 2)<1e-8,
+          "unexpected root with analytic jacobian" );
+      insight::assertion(
+          arma::norm(x2-sqrt(2.), 2)<1e-8,
+          "unexpected root with finite difference jacobian" );
+
+
+      // Rosenbrock function
+      auto R = [](const arma::mat& x)
+      {
+          double r=0.;
+          for (arma::uword i=0; i+1<x.n_elem; ++i)
+              r+=100.*pow(x(i+1)-x(i)*x(i), 2)+pow(1.-x(i), 2);
+          return r;
+      };
+
+      arma::mat xr = nonlinearMinimizeND(
+          R, GradientFunction(), arma::zeros(10), 1e-10, 10000 );
+      std::cout<<"xr="<<xr.t()<<std::endl;
+      insight::assertion(
+          arma::norm(xr-1., 2)<1e-4,
+          "unexpected minimum of Rosenbrock function" );
+
+
+      // least squares fit with more parameters than the simplex can handle
+      arma::mat t=arma::linspace(0., 1., 200);
+      arma::mat cexp=arma::linspace(0.1, 1., 20);
+      auto model = [&](const arma::mat& c) -> arma::mat
+      {
+          arma::mat y=arma::zeros(t.n_elem);
+          for (arma::uword k=0; k<c.n_elem; ++k)
+              y+=sinh(c(k))*arma::sin(double(k+1)*M_PI*t);
+          return y;
+      };
+      arma::mat y=model(cexp);
+      arma::mat cfit = nonlinearLeastSquaresND(
+          [&](const arma::mat& c) -> arma::mat { return model(c)-y; },
+          JacobianFunction(), arma::zeros(20), 1e-12 );
+      double res=arma::norm(model(cfit)-y, 2);
+      std::cout<<"residual="<<res<<std::endl;
+      insight::assertion(
+          res<1e-6,
+          "unexpected residual of least squares fit: %g", res );
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr<<e.what()<<std::endl;
+    return -1;
+  }
+
+  return 0;
+}
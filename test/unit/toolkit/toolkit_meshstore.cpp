@@ -0,0 +1,100 @@
+#include "base/exception.h"
+#include "base/parameterset.h"
+#include "base/casedirectory.h"
+#include "openfoam/meshstore.h"
+
+#include <fstream>
+#include <iostream>
+
+#include "boost/filesystem/operations.hpp"
+#include "test_pdl.h"
+
+using namespace std;
+using namespace insight;
+using namespace boost::filesystem;
+
+void writeFile(const path& fn, const std::string& content)
+{
+    create_directories(fn.parent_path());
+    std::ofstream f(fn.string());
+    f<<content;
+}
+
+int main()
+{
+    try
+    {
+        CaseDirectory wd(false, boost::filesystem::temp_directory_path()/"meshstore-test");
+
+        auto ps = TestPDL::defaultParameters();
+
+        // key depends on file content, not on file name
+        writeFile(wd/"a"/"inlet.stl", "solid inlet\nendsolid inlet\n");
+        writeFile(wd/"b"/"inlet.stl", "solid inlet\nendsolid inlet\n");
+        writeFile(wd/"c"/"inlet.stl", "solid other\nendsolid other\n");
+
+        auto& inlet = ps->get<PathParameter>("geometry/inlet");
+        inlet.setFilePath(wd/"a"/"inlet.stl");
+        auto ka = MeshStore::computeKey("testAnalysis", *ps, {"geometry"});
+        inlet.setFilePath(wd/"b"/"inlet.stl");
+        auto kb = MeshStore::computeKey("testAnalysis", *ps, {"geometry"});
+        inlet.setFilePath(wd/"c"/"inlet.stl");
+        auto kc = MeshStore::computeKey("testAnalysis", *ps, {"geometry"});
+        std::cout<<ka<<" "<<kb<<" "<<kc<<std::endl;
+
+        insight::assertion(ka==kb, "expected identical key for identical file content");
+        insight::assertion(ka!=kc, "expected different key for different file content");
+
+        // key depends on relevant parameters only
+        auto k1 = MeshStore::computeKey("testAnalysis", *ps, {"geometry", "run"});
+        auto k1x = MeshStore::computeKey("testAnalysis", *ps, {"geometry", "run"}, {"run/regime"});
+        ps->get<DoubleParameter>("run/regime/endTime").set(20.);
+        auto k2 = MeshStore::computeKey("testAnalysis", *ps, {"geometry", "run"});
+        auto k2x = MeshStore::computeKey("testAnalysis", *ps, {"geometry", "run"}, {"run/regime"});
+        insight::assertion(k1!=k2, "expected different key after parameter change");
+        insight::assertion(k1x==k2x, "expected identical key, if changed parameter is excluded");
+        insight::assertion(
+            MeshStore::computeKey("testAnalysis", *ps, {"geometry", "nonexisting"})==kc,
+            "expected nonexisting paths to be skipped" );
+
+        // key depends on the analysis type
+        insight::assertion(
+            MeshStore::computeKey("otherAnalysis", *ps, {"geometry"})!=kc,
+            "expected different key for different analysis type" );
+
+        // publish and lookup
+        MeshStore store(wd/"store");
+        insight::assertion(!store.contains(kc), "unexpected entry in empty store");
+
+        auto caseDir = wd/"case";
+        writeFile(caseDir/"constant"/"polyMesh"/"points", "");
+        {
+            auto lock = store.lock(kc);
+            insight::assertion(
+                !store.publish(kc, caseDir),
+                "incomplete mesh must not be published" );
+        }
+
+        for (const std::string f: {"boundary", "faces", "neighbour", "owner"})
+        {
+            writeFile(caseDir/"constant"/"polyMesh"/f, "");
+        }
+        {
+            auto lock = store.lock(kc);
+            insight::assertion(
+                store.publish(kc, caseDir),
+                "expected mesh to be published" );
+        }
+        insight::assertion(store.contains(kc), "expected entry in store");
+        insight::assertion(
+            exists(store.entryDirectory(kc)/"constant"/"polyMesh"/"owner"),
+            "expected mesh files in store entry" );
+    }
+    catch (const std::exception& e)
+    {
+        cerr<<e.what()<<endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "base/tools.h"
+#include "base/casedirectory.h"
+#include "base/externalprograms.h"
+
+#include "boost/filesystem/operations.hpp"
+#include "boost/process.hpp"
+#include "boost/format.hpp"
+
+using namespace insight;
+
+
+#ifndef WIN32
+
+/**
+ * stand-in for ssh, which logs its invocations.
+ * It mimics ControlMaster=auto: the first command to a host creates the
+ * control socket (a plain file here) and becomes the master, later commands
+ * reuse it. A stale socket is replaced by a new master, "-O exit" removes it.
+ */
+boost::filesystem::path writeFakeSSH(
+    const boost::filesystem::path& dir,
+    const boost::filesystem::path& log )
+{
+  auto exe = dir/"ssh";
+  {
+    std::ofstream f(exe.string());
+    f << "#!/bin/sh\n"
+         "log=\""<<log.string()<<"\"\n"
+         "cp=\"\"; cm=\"\"; op=\"\"\n"
+         "while [ $# -gt 0 ]; do\n"
+         "  case \"$1\" in\n"
+         "    -o) case \"$2\" in\n"
+         "          ControlPath=*) cp=\"${2#ControlPath=}\" ;;\n"
+         "          ControlMaster=*) cm=\"${2#ControlMaster=}\" ;;\n"
+         "        esac; shift 2 ;;\n"
+         "    -O) op=\"$2\"; shift 2 ;;\n"
+         "    *) break ;;\n"
+         "  esac\n"
+         "done\n"
+         "host=\"$1\"; shift\n"
+         "sock=$(echo \"$cp\" | sed \"s/%C/$host/\")\n"
+         "if [ \"$op\" = exit ]; then\n"
+         "  rm -f \"$sock\"; echo \"exit $host\" >> \"$log\"; exit 0\n"
+         "fi\n"
+         "if [ -z \"$cp\" ] || [ \"$cm\" != auto ]; then\n"
+         "  echo \"direct $host $*\" >> \"$log\"\n"
+         "elif [ \"$(cat \"$sock\" 2>/dev/null)\" = alive ]; then\n"
+         "  echo \"mux $host $*\" >> \"$log\"\n"
+         "else\n"
+         "  echo alive > \"$sock\"; echo \"master $host $*\" >> \"$log\"\n"
+         "fi\n";
+  }
+  boost::filesystem::permissions(exe, boost::filesystem::owner_all);
+
+  std::string path = dir.string();
+  if (auto p = getenv("PATH")) path += ":"+std::string(p);
+  setenv("PATH", path.c_str(), 1);
+  ExternalPrograms::globalInstance()["ssh"]=exe;
+
+  return exe;
+}
+
+
+std::vector<std::string> readLog(const boost::filesystem::path& log)
+{
+  std::vector<std::string> lines;
+  std::ifstream f(log.string());
+  std::string l;
+  while (std::getline(f, l)) lines.push_back(l);
+  return lines;
+}
+
+
+int count(const std::vector<std::string>& lines, const std::string& prefix)
+{
+  return std::count_if(
+        lines.begin(), lines.end(),
+        [&](const std::string& l) { return l.compare(0, prefix.size(), prefix)==0; } );
+}
+
+
+void run(const SSHCommand& sc)
+{
+  int ret = boost::process::system(
+        sc.command(), boost::process::args(sc.arguments()) );
+  insight::assertion(ret==0, "ssh stand-in returned %d", ret);
+}
+
+
+/**
+ * the control socket directory is looked up only once per process,
+ * each of the scenarios below therefore runs in its own test process
+ */
+void testSharedMaster()
+{
+  CaseDirectory tmp(false, boost::filesystem::temp_directory_path()/"ssh");
+  setenv("TMPDIR", tmp.string().c_str(), 1);
+  auto log = tmp/"ssh.log";
+  writeFakeSSH(tmp, log);
+
+  insight::assertion(
+      !SSHCommand::connectionSharingOptions().empty(),
+      "expected connection multiplexing in private control directory" );
+
+  for (int i=0; i<3; ++i)
+  {
+    run(SSHCommand("testhost", {"ls", std::to_string(i)}));
+  }
+  auto l = readLog(log);
+  insight::assertion(
+      l.size()==3 && count(l, "master testhost ls 0")==1 && count(l, "mux testhost")==2,
+      "expected a single master connection for several commands" );
+
+  // other hosts get their own master
+  run(SSHCommand("otherhost", {"ls"}));
+  run(SSHCommand("otherhost", {"ls"}));
+  l = readLog(log);
+  insight::assertion(
+      count(l, "master otherhost")==1 && count(l, "mux otherhost")==1,
+      "expected a separate master connection for other host" );
+
+  // unshared connections bypass the master
+  run(SSHCommand("testhost", {"-N"}, false));
+  l = readLog(log);
+  insight::assertion(
+      count(l, "direct testhost")==1 && count(l, "master testhost")==1,
+      "unshared connection should not use the master" );
+
+  // a master, which died and left its control socket behind, is replaced
+  auto sockets = tmp / boost::str(boost::format("insight-ssh-%d") % getuid());
+  {
+    std::ofstream f( (sockets/"testhost").string() );
+    f << "stale" << std::endl;
+  }
+  run(SSHCommand("testhost", {"ls", "after-crash"}));
+  run(SSHCommand("testhost", {"ls"}));
+  l = readLog(log);
+  insight::assertion(
+      count(l, "master testhost")==2 && count(l, "master testhost ls after-crash")==1,
+      "expected restart of dead master connection" );
+
+  // after closing, the next command starts a new master
+  SSHCommand::closeSharedConnection("testhost");
+  insight::assertion(
+      !boost::filesystem::exists(sockets/"testhost"),
+      "control socket was not removed" );
+  run(SSHCommand("testhost", {"ls"}));
+  l = readLog(log);
+  insight::assertion(
+      count(l, "exit testhost")==1 && count(l, "master testhost")==3
+        && count(l, "exit otherhost")==0,
+      "expected new master connection after close" );
+
+  SSHCommand::closeSharedConnection("otherhost");
+}
+
+
+void testBadControlDirectory()
+{
+  CaseDirectory tmp(false, boost::filesystem::temp_directory_path()/"ssh");
+  setenv("TMPDIR", tmp.string().c_str(), 1);
+  auto log = tmp/"ssh.log";
+  writeFakeSSH(tmp, log);
+
+  // pre-existing, but accessible by others
+  auto sockets = tmp / boost::str(boost::format("insight-ssh-%d") % getuid());
+  boost::filesystem::create_directories(sockets);
+  boost::filesystem::permissions(
+        sockets,
+        boost::filesystem::owner_all
+        | boost::filesystem::group_read | boost::filesystem::group_exe
+        | boost::filesystem::others_read | boost::filesystem::others_exe );
+
+  insight::assertion(
+      SSHCommand::connectionSharingOptions().empty(),
+      "control directory with insecure permissions should be rejected" );
+
+  run(SSHCommand("testhost", {"ls"}));
+  run(SSHCommand("testhost", {"ls"}));
+  auto l = readLog(log);
+  insight::assertion(
+      l.size()==2 && count(l, "direct testhost")==2,
+      "expected direct connections without multiplexing" );
+}
+
+#endif
+
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    unsetenv("INSIGHT_SSH_NO_MULTIPLEXING");
+
+#ifndef WIN32
+    if (argc>1)
+    {
+      std::string scenario(argv[1]);
+      if (scenario=="sharedmaster")
+        testSharedMaster();
+      else if (scenario=="badcontroldir")
+        testBadControlDirectory();
+      else
+        throw insight::Exception("unknown test scenario: %s", scenario.c_str());
+      return 0;
+    }
+#endif
+
+    auto has = [](const std::vector<std::string>& a, const std::string& s)
+    {
+      return std::find(a.begin(), a.end(), s)!=a.end();
+    };
+
+    SSHCommand shared("testhost", {"ls", "-l"});
+    auto a = shared.arguments();
+    for (const auto& e: a) std::cout<<" "<<e;
+    std::cout<<std::endl;
+
+#ifndef WIN32
+    // host name has to be placed directly before the command
+    insight::assertion(
+        a.size()>=3 && a[a.size()-3]=="testhost" && a[a.size()-2]=="ls" && a.back()=="-l",
+        "unexpected argument order" );
+
+    if (!SSHCommand::connectionSharingOptions().empty())
+    {
+      insight::assertion(
+          has(a, "ControlMaster=auto"),
+          "expected connection multiplexing options" );
+    }
+
+    SSHCommand unshared("testhost", {"-N"}, false);
+    auto b = unshared.arguments();
+    insight::assertion(
+        b.size()==2 && !has(b, "ControlMaster=auto"),
+        "expected no connection multiplexing options" );
+#endif
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr<<"Error occurred: "<<e.what()<<std::endl;
+    return -1;
+  }
+
+  return 0;
+}
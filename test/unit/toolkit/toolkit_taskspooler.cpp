@@ -0,0 +1,186 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <cstdlib>
+#include <cmath>
+
+#include "base/exception.h"
+#include "base/casedirectory.h"
+#include "base/taskspoolerinterface.h"
+
+#include "boost/filesystem/operations.hpp"
+
+using namespace insight;
+
+typedef TaskSpoolerInterface::Job Job;
+
+
+void testParse()
+{
+  Job j;
+
+  insight::assertion(
+      TaskSpoolerInterface::parseJobEvent(
+          "12 finished 3 1.50 20.25 27:/tmp/my case dir/output.txt isofRun  --case \"a b\"", j ),
+      "event line with spaces was not accepted" );
+  insight::assertion(j.id==12, "unexpected job id %d", j.id);
+  insight::assertion(j.state==TaskSpoolerInterface::Finished, "unexpected state");
+  insight::assertion(j.elevel==3, "unexpected error level %d", j.elevel);
+  insight::assertion(
+      fabs(j.waitTime-1.5)<1e-10 && fabs(j.runTime-20.25)<1e-10,
+      "unexpected times %g %g", j.waitTime, j.runTime );
+  insight::assertion(
+      j.output==boost::filesystem::path("/tmp/my case dir/output.txt"),
+      "unexpected output file %s", j.output.string().c_str() );
+  insight::assertion(
+      j.commandLine=="isofRun  --case \"a b\"",
+      "unexpected command line %s", j.commandLine.c_str() );
+
+  // no output file
+  insight::assertion(
+      TaskSpoolerInterface::parseJobEvent("7 queued -1 0.00 0.00 0: sleep 10", j),
+      "event line without output was not accepted" );
+  insight::assertion(j.id==7 && j.state==TaskSpoolerInterface::Queued, "unexpected job");
+  insight::assertion(j.elevel==-1, "unexpected error level %d", j.elevel);
+  insight::assertion(j.output.empty(), "expected no output file");
+  insight::assertion(j.commandLine=="sleep 10", "unexpected command line %s", j.commandLine.c_str());
+
+  insight::assertion(
+      TaskSpoolerInterface::parseJobEvent("8 skipped 0 0.00 0.00 0: ", j)
+        && j.state==TaskSpoolerInterface::Finished && j.commandLine.empty(),
+      "empty command line was not accepted" );
+
+  insight::assertion(
+      TaskSpoolerInterface::parseJobEvent("9 removed -1 0.00 0.00 0: x", j)
+        && j.state==TaskSpoolerInterface::Removed,
+      "removal event was not accepted" );
+
+  // malformed lines
+  for (const std::string& l: {
+         "",
+         "ID State Output E-Level Times Command",
+         "1 running -1 0.00 0.00 /tmp/out sleep 1", // no length prefix
+         "1 running -1 0.00 0.00 30:/tmp/out sleep 1", // length exceeds line
+         "1 running -1 0.00 0.00 4:/tmp/out sleep 1", // length ends within name
+         "x 1 running -1 0.00 0.00 0: sleep 1" })
+  {
+    insight::assertion(
+        !TaskSpoolerInterface::parseJobEvent(l, j),
+        "malformed event line was accepted: %s", l.c_str() );
+  }
+}
+
+
+#ifndef WIN32
+class Receiver
+{
+  mutable std::mutex mtx_;
+  std::vector<Job> jobs_;
+
+public:
+  TaskSpoolerInterface::JobEventCallback callback()
+  {
+    return [this](const Job& j)
+    {
+      std::lock_guard<std::mutex> l(mtx_);
+      jobs_.push_back(j);
+    };
+  }
+
+  std::vector<Job> jobs() const
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    return jobs_;
+  }
+
+  bool waitFor(size_t n) const
+  {
+    for (int i=0; i<100; ++i)
+    {
+      if (jobs().size()>=n) return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return false;
+  }
+};
+
+
+void testSubscription()
+{
+  CaseDirectory bin(false);
+
+  // stand-in for the spooler client: "tsp -M" prints some events
+  // and then keeps the subscription open
+  auto tsp = bin/"tsp";
+  {
+    std::ofstream f(tsp.string());
+    f << "#!/bin/sh\n"
+         "if [ \"$1\" = \"-M\" ]; then\n"
+         "  echo '1 queued -1 0.00 0.00 0: sleep 1'\n"
+         "  echo '1 running -1 0.10 0.00 0: sleep 1'\n"
+         "  echo '1 finished 0 0.10 1.00 18:/tmp/a dir/out.txt sleep 1'\n"
+         "  exec sleep 600\n"
+         "fi\n";
+  }
+  boost::filesystem::permissions(tsp, boost::filesystem::owner_all);
+
+  std::string path = bin.string();
+  if (auto p = getenv("PATH")) path += ":"+std::string(p);
+  setenv("PATH", path.c_str(), 1);
+
+  TaskSpoolerInterface tsi(bin/"socket");
+
+  Receiver r1;
+  tsi.subscribeJobEvents(r1.callback());
+  insight::assertion(tsi.isSubscribed(), "expected active subscription");
+  insight::assertion(r1.waitFor(3), "job events were not delivered");
+
+  auto j1=r1.jobs();
+  insight::assertion(j1.size()==3, "expected 3 events, got %d", int(j1.size()));
+  insight::assertion(
+      j1[0].state==TaskSpoolerInterface::Queued
+        && j1[1].state==TaskSpoolerInterface::Running
+        && j1[2].state==TaskSpoolerInterface::Finished,
+      "unexpected sequence of job states" );
+  insight::assertion(
+      j1[2].output==boost::filesystem::path("/tmp/a dir/out.txt"),
+      "unexpected output file %s", j1[2].output.string().c_str() );
+
+  tsi.unsubscribeJobEvents();
+  insight::assertion(!tsi.isSubscribed(), "expected no active subscription");
+
+  // a new subscription delivers to the new receiver only
+  Receiver r2;
+  tsi.subscribeJobEvents(r2.callback());
+  insight::assertion(r2.waitFor(3), "job events were not delivered after resubscription");
+  tsi.unsubscribeJobEvents();
+
+  insight::assertion(
+      r1.jobs().size()==3,
+      "events delivered after unsubscription" );
+  insight::assertion(
+      r2.jobs().size()==3,
+      "expected 3 events, got %d", int(r2.jobs().size()) );
+}
+#endif
+
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  try
+  {
+    testParse();
+#ifndef WIN32
+    testSubscription();
+#endif
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr<<"Error occurred: "<<e.what()<<std::endl;
+    return -1;
+  }
+
+  return 0;
+}